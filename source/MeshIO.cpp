@@ -15,6 +15,8 @@
 #include <GU/GU_Detail.h>
 
 
+const char *MeshIO::TRACER_GROUP = "tracers";
+
 
 VS3D * MeshIO::build_tracker(const GU_Detail *gdp, Options sim_options) {
 
@@ -34,16 +36,27 @@ VS3D * MeshIO::build_tracker(const GU_Detail *gdp, Options sim_options) {
 	GA_ROHandleI cons_pt(gdp, GA_ATTRIB_POINT, "constrained");
 	GA_ROHandleV3 vel_h(gdp, GA_ATTRIB_POINT, "v");
 
+	// tracer particles are carried along with the mesh points but are not mesh vertices
+	const GA_PointGroup *tracer_group = gdp->findPointGroup(TRACER_GROUP);
+	std::vector<Vec3d> tracers;
+	std::vector<GA_Size> vertex_index(gdp->getNumPoints(), -1);
+
 	for (GA_Iterator it(pt_range.begin()); !it.atEnd(); ++it) {
 
 		UT_Vector3F pos = pt_pos.get(it.getOffset());
+		if (tracer_group && tracer_group->containsOffset(it.getOffset())) {
+			tracers.push_back(Vec3d(pos[0], pos[1], pos[2]));
+			continue;
+		}
+
+		vertex_index[it.getIndex()] = vertices.size();
 		vertices.push_back(LosTopos::Vec3d(pos[0], pos[1], pos[2]));
 
 		if (cons_pt.isValid()) {
 			bool constrained = cons_pt.get(it.getOffset());
 
 			if (constrained) {
-				constrained_vertices.push_back(it.getIndex());
+				constrained_vertices.push_back(vertex_index[it.getIndex()]);
 				constrained_positions.push_back(Vec3d(pos[0], pos[1], pos[2]));
 				if (vel_h.isValid()) {
 					UT_Vector3F vel = vel_h.get(it.getOffset());
@@ -64,7 +77,7 @@ VS3D * MeshIO::build_tracker(const GU_Detail *gdp, Options sim_options) {
 		std::vector<GA_Offset> pt_offsets;
 
 		for (GA_Iterator it(prim_pt_range.begin()); !it.atEnd(); ++it) {
-			pt_offsets.push_back(it.getIndex());
+			pt_offsets.push_back(vertex_index[it.getIndex()]);
 		}
 
 		faces.push_back(LosTopos::Vec3st(pt_offsets[2], pt_offsets[1], pt_offsets[0]));
@@ -78,6 +91,7 @@ VS3D * MeshIO::build_tracker(const GU_Detail *gdp, Options sim_options) {
 	}
 
 	VS3D *m_vs = new VS3D(vertices, faces, face_labels, sim_options, constrained_vertices, constrained_positions, constrained_velocities);
+	m_vs->tracers() = tracers;
 	
 
 	// Check if gamma values exist. If there is one, it means this is not the first frame 
@@ -93,14 +107,17 @@ VS3D * MeshIO::build_tracker(const GU_Detail *gdp, Options sim_options) {
 
 		for (GA_Iterator it(pt_range.begin()); !it.atEnd(); ++it) {
 
+			GA_Size v = vertex_index[it.getIndex()];
+			if (v < 0) continue;
+
 			UT_Array<fpreal64> data; 
 			gamma_aif->get(gamma_attrib, it.getOffset(), data);
 
 			size_t n = m_vs->nregion();
-			for (int j = 0; j < m_vs->Gamma(*it).values.rows(); j++) {
-				for (int k = 0; k < m_vs->Gamma(*it).values.cols(); k++) {
+			for (int j = 0; j < m_vs->Gamma(v).values.rows(); j++) {
+				for (int k = 0; k < m_vs->Gamma(v).values.cols(); k++) {
 					fpreal64 val = data[(j*n)+k];
-					m_vs->Gamma(it.getIndex()).set(j, k, val);
+					m_vs->Gamma(v).set(j, k, val);
 
 				}
 			}
@@ -131,7 +148,14 @@ bool MeshIO::convert_to_houdini_geo(GU_Detail *gdp, VS3D *tracker) {
 	constrained_velocities = tracker->constrainedVelocities();
 	gdp->clearAndDestroy();
 
-	GA_Offset start_ptoff = gdp->appendPointBlock(tracker->mesh().nv());
+	// the mesh may still hold deleted vertices and triangles (they are only defragmented once enough have accumulated), so write out live elements only
+	std::vector<GA_Size> point_index(tracker->mesh().nv(), -1);
+	GA_Size num_points = 0;
+	for (size_t i = 0; i < tracker->mesh().nv(); ++i)
+		if (!tracker->mesh().vertex_is_deleted(i))
+			point_index[i] = num_points++;
+
+	GA_Offset start_ptoff = gdp->appendPointBlock(num_points);
 
 
 	// We have deleted every attribute alongside primitives and points. Now we have to create them back 
@@ -179,6 +203,8 @@ bool MeshIO::convert_to_houdini_geo(GU_Detail *gdp, VS3D *tracker) {
 	// for each triangle add a primitive
 	for (size_t pr = 0; pr < tracker->mesh().nt(); ++pr) {
 
+		if (tracker->mesh().triangle_is_deleted(pr)) continue;
+
 		GA_Offset start_vtxoff;
 		GA_Offset prim_off = gdp->appendPrimitivesAndVertices(GA_PRIMPOLY, 1, 3, start_vtxoff, true);
 
@@ -199,7 +225,7 @@ bool MeshIO::convert_to_houdini_geo(GU_Detail *gdp, VS3D *tracker) {
 		// Connect vertices
 		for (size_t i = 0; i < 3; ++i) {
 
-			gdp->getTopology().wireVertexPoint(start_vtxoff + i, start_ptoff + indices[2 - i]);
+			gdp->getTopology().wireVertexPoint(start_vtxoff + i, start_ptoff + point_index[indices[2 - i]]);
 			vertex_normals_h.set(start_vtxoff + i, UT_Vector3F(nt[0], nt[1], nt[2]));
 		}
 
@@ -226,7 +252,9 @@ bool MeshIO::convert_to_houdini_geo(GU_Detail *gdp, VS3D *tracker) {
 
 	for (size_t i = 0; i < tracker->mesh().nv(); ++i) {
 
-		GA_Offset ptoff = start_ptoff + i;
+		if (point_index[i] < 0) continue;
+
+		GA_Offset ptoff = start_ptoff + point_index[i];
 
 		LosTopos::Vec3d new_pos = vertices[i];
 		gdp->setPos3(ptoff, UT_Vector3F(new_pos[0], new_pos[1], new_pos[2]));
@@ -263,6 +291,26 @@ bool MeshIO::convert_to_houdini_geo(GU_Detail *gdp, VS3D *tracker) {
 
 
 
+	// Append the tracer particles as unconnected points of the tracer group
+
+	const std::vector<Vec3d> &tracers = tracker->tracers();
+	const std::vector<Vec3d> &tracer_velocities = tracker->tracerVelocities();
+	if (!tracers.empty()) {
+
+		GA_Offset tracer_ptoff = gdp->appendPointBlock(tracers.size());
+		GA_PointGroup *tracer_group = gdp->newPointGroup(TRACER_GROUP);
+
+		for (size_t i = 0; i < tracers.size(); ++i) {
+
+			GA_Offset ptoff = tracer_ptoff + i;
+			gdp->setPos3(ptoff, UT_Vector3F(tracers[i][0], tracers[i][1], tracers[i][2]));
+			if (i < tracer_velocities.size())
+				vel_h.set(ptoff, UT_Vector3F(tracer_velocities[i][0], tracer_velocities[i][1], tracer_velocities[i][2]));
+			tracer_group->addOffset(ptoff);
+
+		}
+	}
+
 	gamma_attrib->bumpDataId();
 	vel_h.bumpDataId();
 	mass_h.bumpDataId();
@@ -274,4 +322,18 @@ bool MeshIO::convert_to_houdini_geo(GU_Detail *gdp, VS3D *tracker) {
 }
 
 
+void MeshIO::add_tracers(const GU_Detail *gdp, VS3D *tracker) {
+
+	GA_ROHandleV3 pt_pos(gdp->getP());
+	std::vector<Vec3d> &tracers = tracker->tracers();
+
+	for (GA_Iterator it(gdp->getPointRange()); !it.atEnd(); ++it) {
+
+		UT_Vector3F pos = pt_pos.get(it.getOffset());
+		tracers.push_back(Vec3d(pos[0], pos[1], pos[2]));
+
+	}
+}
+
+
 MeshIO::~MeshIO() {}
\ No newline at end of file
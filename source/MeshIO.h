@@ -9,7 +9,13 @@ class MeshIO {
 public:
 	virtual ~MeshIO();
 
+	// name of the point group holding the tracer particles, which are not part of the mesh
+	static const char *TRACER_GROUP;
+
 	virtual VS3D* build_tracker(const GU_Detail *gdp, Options sim_options);
 	virtual bool convert_to_houdini_geo(GU_Detail *gdp, VS3D *tracker);
 
+	// add every point of gdp to the tracer particles of the tracker
+	virtual void add_tracers(const GU_Detail *gdp, VS3D *tracker);
+
 };
\ No newline at end of file
@@ -66,7 +66,7 @@ void newSopOperator(OP_OperatorTable *table) {
 		SOP_bubble::myConstructor,
 		SOP_bubble::myTemplateList,
 		1, // min number of inputs 
-		1, // max number of inputs
+		2, // max number of inputs
 		0)); 
 }
 
@@ -98,14 +98,33 @@ static PRM_Name param_names[] = {
 	PRM_Name("t1_trans"		, "T1 Transition"),
 	PRM_Name("t1_pull"		, "T1 Pull Apart Distance Fraction"),
 	PRM_Name("lt_sm_subd"	, "Smooth Subdivision"),
+	PRM_Name("hash_bp"		, "Hashed Broad Phase"),
+	PRM_Name("local_rb"		, "Localized Rollback"),
+	PRM_Name("defrag_thr"	, "Defragment Threshold"),
+	PRM_Name("queued_rm"	, "Queued Remeshing"),
+	PRM_Name("queued_snap"	, "Queued Snapping"),
+	PRM_Name("par_smooth"	, "Parallel Smoothing"),
+	PRM_Name("adapt_size"	, "Adaptive Sizing"),
+	PRM_Name("max_coarsen"	, "Max Coarsening"),
+	PRM_Name("quality_rm"	, "Quality-Triggered Remeshing"),
+	PRM_Name("fmm"			, "FMM Biot-Savart"),
+	PRM_Name("fmm_tune"		, "FMM Auto-Tuning"),
+	PRM_Name("fmm_tol"		, "FMM Tolerance"),
+	PRM_Name("t1_vel"		, "T1 Velocity Field Pull Apart"),
+	PRM_Name("fmm_compare"	, "Compare Evaluators"),
+	PRM_Name("fmm_mixed"	, "FMM Mixed Precision"),
+	PRM_Name("fmm_treecode"	, "FMM Treecode"),
+	PRM_Name("emit_tracers"	, "Emit Tracers Every Cook"),
 };
 
+static PRM_Default		fmmToleranceDefault(1e-4);
+
 static PRM_Name         switcherName("shakeswitcher");
 
 static PRM_Default      switcher[] = {
-	PRM_Default(11, "Simulation"),   
-	PRM_Default(2, "Remeshing"),
-	PRM_Default(11, "LT Surface"),
+	PRM_Default(18, "Simulation"),   
+	PRM_Default(5, "Remeshing"),
+	PRM_Default(18, "LT Surface"),
 };
 
 
@@ -124,8 +143,18 @@ PRM_Template SOP_bubble::myTemplateList[] = {
 	PRM_Template(PRM_FLT, 1 , &param_names[8], PRM100Defaults),				// strech
 	PRM_Template(PRM_FLT, 3 , &param_names[9], PRMzeroDefaults),			// g
 	PRM_Template(PRM_FLT, 1 , &param_names[10], PRMpointOneDefaults),		// radius
+	PRM_Template(PRM_TOGGLE, 1 , &param_names[40], PRMzeroDefaults),		// Emit Tracers Every Cook
+	PRM_Template(PRM_TOGGLE, 1 , &param_names[33], PRMzeroDefaults),		// FMM Biot-Savart
+	PRM_Template(PRM_TOGGLE, 1 , &param_names[34], PRMzeroDefaults),		// FMM Auto-Tuning
+	PRM_Template(PRM_FLT, 1 , &param_names[35], &fmmToleranceDefault),		// FMM Tolerance
+	PRM_Template(PRM_TOGGLE, 1 , &param_names[38], PRMzeroDefaults),		// FMM Mixed Precision
+	PRM_Template(PRM_TOGGLE, 1 , &param_names[39], PRMzeroDefaults),		// FMM Treecode
+	PRM_Template(PRM_TOGGLE, 1 , &param_names[37], PRMzeroDefaults),		// Compare Evaluators
 	PRM_Template(PRM_FLT, 1 , &param_names[11], PRMpointOneDefaults),		// remesh res
 	PRM_Template(PRM_INT, 1 , &param_names[12], PRMtwoDefaults),			// remesh iter
+	PRM_Template(PRM_TOGGLE, 1 , &param_names[30], PRMzeroDefaults),		// Adaptive Sizing
+	PRM_Template(PRM_FLT, 1 , &param_names[31], PRMthreeDefaults),			// Max Coarsening
+	PRM_Template(PRM_TOGGLE, 1 , &param_names[32], PRMzeroDefaults),		// Quality-Triggered Remeshing
 	PRM_Template(PRM_FLT, 1 , &param_names[13], PRMpointOneDefaults),		// Collision Epsilon Fraction
 	PRM_Template(PRM_FLT, 1 , &param_names[14], PRMpointOneDefaults),		// Merge Epsilon Fraction
 	PRM_Template(PRM_TOGGLE, 1 , &param_names[15], PRMzeroDefaults),		// Perform Smoothing
@@ -136,7 +165,14 @@ PRM_Template SOP_bubble::myTemplateList[] = {
 	PRM_Template(PRM_FLT, 1 , &param_names[20], PRMpointOneDefaults),		// Min Triangle Area
 	PRM_Template(PRM_TOGGLE, 1 , &param_names[21], PRMoneDefaults),			// T1 Transition
 	PRM_Template(PRM_FLT, 1 , &param_names[22], PRMpointOneDefaults),		// T1 Pull Apart Distance Fraction
+	PRM_Template(PRM_TOGGLE, 1 , &param_names[36], PRMzeroDefaults),		// T1 Velocity Field Pull Apart
 	PRM_Template(PRM_TOGGLE, 1 , &param_names[23], PRMzeroDefaults),		// Smooth Subdivision
+	PRM_Template(PRM_TOGGLE, 1 , &param_names[24], PRMzeroDefaults),		// Hashed Broad Phase
+	PRM_Template(PRM_TOGGLE, 1 , &param_names[25], PRMzeroDefaults),		// Localized Rollback
+	PRM_Template(PRM_FLT, 1 , &param_names[26], PRMzeroDefaults),			// Defragment Threshold
+	PRM_Template(PRM_TOGGLE, 1 , &param_names[27], PRMzeroDefaults),		// Queued Remeshing
+	PRM_Template(PRM_TOGGLE, 1 , &param_names[28], PRMzeroDefaults),		// Queued Snapping
+	PRM_Template(PRM_TOGGLE, 1 , &param_names[29], PRMzeroDefaults),		// Parallel Smoothing
 	PRM_Template()
 };
 
@@ -179,9 +215,19 @@ OP_ERROR SOP_bubble::cookMySop(OP_Context & context)
 	fpreal strech = STRECH(t); 
 	fpreal bend = BEND(t); 
 	UT_Vector3F grav = G(t); 
+	size_t emit_tracers = EMIT_TRACERS(t);
+	size_t fmm = FMM(t);
+	size_t fmm_tune = FMM_TUNE(t);
+	fpreal fmm_tol = FMM_TOL(t);
+	size_t fmm_mixed = FMM_MIXED(t);
+	size_t fmm_treecode = FMM_TREECODE(t);
+	size_t fmm_compare = FMM_COMPARE(t);
 	
 	fpreal rem_res = REMESH_RES(t); 
 	size_t rem_iter = REMESH_ITE(t);
+	size_t adapt_size = ADAPT_SIZE(t);
+	fpreal max_coarsen = MAX_COARSEN(t);
+	size_t quality_rm = QUALITY_RM(t);
 
 
 	fpreal coll_eps = COLL_EPS(t); 
@@ -194,7 +240,14 @@ OP_ERROR SOP_bubble::cookMySop(OP_Context & context)
 	fpreal min_tri_area = MIN_TRI_AREA(t);
 	size_t t1_trans = T1_TRANS(t);
 	fpreal t1_pull = T1_PULL(t);
+	size_t t1_vel = T1_VEL(t);
 	size_t lt_sm_sbd = LT_SM_SBD(t);
+	size_t hash_bp = HASH_BP(t);
+	size_t local_rb = LOCAL_RB(t);
+	fpreal defrag_thr = DEFRAG_THR(t);
+	size_t queued_rm = QUEUED_RM(t);
+	size_t queued_snap = QUEUED_SNAP(t);
+	size_t par_smooth = PAR_SMOOTH(t);
 	fpreal frame = context.getFloatFrame();
 
 	// Parse options
@@ -212,7 +265,11 @@ OP_ERROR SOP_bubble::cookMySop(OP_Context & context)
 	sim_options.addDoubleOption("damping-coef", dc);
 	sim_options.addDoubleOption("sigma", sigma);
 	sim_options.addVectorOption("gravity", Vector3s(grav[0], grav[1], grav[2]));
-	sim_options.addBooleanOption("fmmtl", false);
+	sim_options.addBooleanOption("fmmtl", fmm);
+	sim_options.addBooleanOption("fmmtl-autotune", fmm_tune);									// whether the FMM parameters are tuned per scene to the fastest ones meeting fmmtl-tolerance
+	sim_options.addDoubleOption("fmmtl-tolerance", fmm_tol);									// FMM relative error budget, measured against direct summation
+	sim_options.addBooleanOption("fmmtl-mixed-precision", fmm_mixed);							// whether the FMM expansions are single precision, with a double precision near field
+	sim_options.addBooleanOption("fmmtl-treecode", fmm_treecode);								// whether the far field is a Barnes-Hut treecode instead of the FMM, often faster for mid-size meshes
 	sim_options.addBooleanOption("looped", true);
 	sim_options.addDoubleOption("radius",rad);
 	sim_options.addDoubleOption("density", 1.32e3);
@@ -223,6 +280,9 @@ OP_ERROR SOP_bubble::cookMySop(OP_Context & context)
 
 	sim_options.addDoubleOption("remeshing-resolution", rem_res);
 	sim_options.addIntegerOption("remeshing-iterations", rem_iter);
+	sim_options.addBooleanOption("sizing-field", adapt_size);								// whether the remeshing resolution adapts to curvature, triple junctions and velocity
+	sim_options.addDoubleOption("sizing-field-max-scale", max_coarsen);						// coarsest allowed edge length (multiple of the remeshing resolution)
+	sim_options.addBooleanOption("remeshing-quality-triggered", quality_rm);					// whether remeshing iterations are skipped when the mesh needs no improvement
 
 
 	sim_options.addDoubleOption("lostopos-collision-epsilon-fraction", coll_eps);				// lostopos collision epsilon (fraction of mean edge length)
@@ -235,9 +295,16 @@ OP_ERROR SOP_bubble::cookMySop(OP_Context & context)
 	sim_options.addDoubleOption("lostopos-min-triangle-area-fraction", min_tri_area);			// minimum allowed triangle area (fraction of mean edge length squared)
 	sim_options.addBooleanOption("lostopos-t1-transition-enabled", t1_trans);					// whether t1 is enabled
 	sim_options.addDoubleOption("lostopos-t1-pull-apart-distance-fraction", t1_pull);			// t1 pull apart distance (fraction of mean edge legnth)
+	sim_options.addBooleanOption("lostopos-t1-velocity-field", t1_vel);						// whether t1 pull apart decisions use the divergence of the film velocity field instead of trial pulls under surface tension
 	sim_options.addBooleanOption("lostopos-smooth-subdivision", lt_sm_sbd);						// whether to use smooth subdivision during remeshing
 	sim_options.addBooleanOption("lostopos-allow-non-manifold", true);							// whether to allow non-manifold geometry in the mesh
 	sim_options.addBooleanOption("lostopos-allow-topology-changes", true);						// whether to allow topology changes
+	sim_options.addBooleanOption("lostopos-hashed-broad-phase", hash_bp);						// whether to use the sparse hashed broad phase instead of dense grids
+	sim_options.addBooleanOption("lostopos-localized-rollback", local_rb);						// whether failed collision handling scales back only the offending regions
+	sim_options.addDoubleOption("lostopos-defrag-threshold", defrag_thr);						// fraction of deleted mesh elements above which the mesh is defragmented instead of reusing their slots
+	sim_options.addBooleanOption("lostopos-queued-remeshing", queued_rm);						// whether splits and collapses are driven by locally updated priority queues
+	sim_options.addBooleanOption("lostopos-queued-snapping", queued_snap);						// whether snapping is driven by a locally updated proximity queue
+	sim_options.addBooleanOption("lostopos-parallel-smoothing", par_smooth);					// whether smoothing uses the parallel, collision-safe pass
 
 
 	// Create surface tracker
@@ -250,7 +317,43 @@ OP_ERROR SOP_bubble::cookMySop(OP_Context & context)
 		return error();
 	}
 
+	// Points of the optional second input join the tracer particles advected through the film velocity field.
+	// Later cooks get the tracers back through the tracer group of the input mesh, so the second input only
+	// seeds them on the first frame unless it is meant to emit new tracers on every cook
+	const GU_Detail *tracer_gdp = inputGeo(1, context);
+	if (tracer_gdp && (emit_tracers || !gdp->findPointGroup(MeshIO::TRACER_GROUP))) meshio.add_tracers(tracer_gdp, m_vs);
+
 	
+	// Report the accuracy, speed and memory of the velocity evaluators on the input state against the naive summation,
+	// for the current FMM parameters and a sweep of apertures, expansion orders, precisions and far field methods
+	if (fmm_compare) {
+		std::vector<VS3D::FMMParameters> candidates;
+		const double thetas[] = { 0.3, 0.5, 0.7 };
+		const int orders[] = { 3, 5, 8 };
+		for (double theta : thetas) {
+			for (int order : orders) {
+				for (int mixed = 0; mixed < 2; mixed++) {
+					for (int treecode = 0; treecode < 2; treecode++) {
+						VS3D::FMMParameters candidate;
+						candidate.theta = theta;
+						candidate.order = order;
+						candidate.mixed_precision = (mixed == 1);
+						candidate.treecode = (treecode == 1);
+						candidates.push_back(candidate);
+					}
+				}
+			}
+		}
+
+		std::vector<VS3D::EvaluatorReport> reports = m_vs->compareEvaluators(candidates);
+		std::cout << "Velocity evaluators at frame " << frame << ":" << std::endl;
+		VS3D::printEvaluatorReports(std::cout, reports);
+
+		UT_WorkBuffer buf;
+		buf.sprintf("Compared %d velocity evaluators; see the console for the report", int(reports.size()));
+		addMessage(SOP_MESSAGE, buf.buffer());
+	}
+
 	// Integrate positions
 	m_vs->step(dt);
 	
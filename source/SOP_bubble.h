@@ -62,7 +62,7 @@ namespace BUBBLE {
 		
 		virtual const char *inputLabel(unsigned idx) const override 
 		{
-			return "Input Mesh";
+			return idx == 0 ? "Input Mesh" : "Tracer Points";
 		}
 
 	private: // Parameter accessors
@@ -93,8 +93,18 @@ namespace BUBBLE {
 		fpreal	   STRECH(fpreal t)			{ return evalFloat("strech", 0, t); }
 		UT_Vector3 G(fpreal t)				{ return evalVector3("g", t); }
 		fpreal	   RAD(fpreal t)			{ return evalFloat("radius", 0, t); }
+		size_t	   EMIT_TRACERS(fpreal t)	{ return evalInt("emit_tracers", 0, t); }
+		size_t	   FMM(fpreal t)			{ return evalInt("fmm", 0, t); }
+		size_t	   FMM_TUNE(fpreal t)		{ return evalInt("fmm_tune", 0, t); }
+		fpreal	   FMM_TOL(fpreal t)		{ return evalFloat("fmm_tol", 0, t); }
+		size_t	   FMM_MIXED(fpreal t)		{ return evalInt("fmm_mixed", 0, t); }
+		size_t	   FMM_TREECODE(fpreal t)	{ return evalInt("fmm_treecode", 0, t); }
+		size_t	   FMM_COMPARE(fpreal t)	{ return evalInt("fmm_compare", 0, t); }
 		fpreal	   REMESH_RES(fpreal t)		{ return evalFloat("remesh_res", 0, t); }
 		size_t	   REMESH_ITE(fpreal t)		{ return evalInt("remesh_iter", 0, t); }
+		size_t	   ADAPT_SIZE(fpreal t)		{ return evalInt("adapt_size", 0, t); }
+		fpreal	   MAX_COARSEN(fpreal t)	{ return evalFloat("max_coarsen", 0, t); }
+		size_t	   QUALITY_RM(fpreal t)		{ return evalInt("quality_rm", 0, t); }
 		fpreal	   COLL_EPS(fpreal t)		{ return evalFloat("coll_eps", 0, t); }
 		fpreal	   MERGE_EPS(fpreal t)		{ return evalFloat("merge_eps", 0, t); }
 		size_t	   SMOOTH(fpreal t)			{ return evalInt("lt_smooth", 0, t); }
@@ -105,7 +115,14 @@ namespace BUBBLE {
 		fpreal	   MIN_TRI_AREA(fpreal t)	{ return evalFloat("min_tri_area", 0, t); }
 		size_t	   T1_TRANS(fpreal t)		{ return evalInt("t1_trans", 0, t); }
 		fpreal	   T1_PULL(fpreal t)		{ return evalFloat("t1_pull", 0, t); }
+		size_t	   T1_VEL(fpreal t)			{ return evalInt("t1_vel", 0, t); }
 		size_t	   LT_SM_SBD(fpreal t)		{ return evalInt("lt_sm_subd", 0, t); }
+		size_t	   HASH_BP(fpreal t)		{ return evalInt("hash_bp", 0, t); }
+		size_t	   LOCAL_RB(fpreal t)		{ return evalInt("local_rb", 0, t); }
+		fpreal	   DEFRAG_THR(fpreal t)		{ return evalFloat("defrag_thr", 0, t); }
+		size_t	   QUEUED_RM(fpreal t)		{ return evalInt("queued_rm", 0, t); }
+		size_t	   QUEUED_SNAP(fpreal t)	{ return evalInt("queued_snap", 0, t); }
+		size_t	   PAR_SMOOTH(fpreal t)		{ return evalInt("par_smooth", 0, t); }
 
 
 	};
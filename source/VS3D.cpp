@@ -18,6 +18,8 @@
 #include "SimpleGravityForce.h"
 #include "VertexAreaForce.h"
 
+#include <queue>
+
 VecXd BiotSavart(VS3D & vs, const VecXd & dx);
 
 bool VS3D::isVertexConstrained(size_t vert)
@@ -61,6 +63,14 @@ VS3D::VS3D(const std::vector<LosTopos::Vec3d> & vs,
 	m_sim_options.bending = opts.doubleValue("bending");
 	m_sim_options.rk4 = opts.boolValue("RK4-velocity-integration");
 	m_sim_options.frame = opts.doubleValue("frame");
+	m_sim_options.sizing_field = opts.boolValue("sizing-field");
+	m_sim_options.sizing_max_scale = opts.doubleValue("sizing-field-max-scale");
+	m_sim_options.quality_triggered_remeshing = opts.boolValue("remeshing-quality-triggered");
+	m_sim_options.fmm_autotune = opts.boolValue("fmmtl-autotune");
+	m_sim_options.fmm_tolerance = opts.doubleValue("fmmtl-tolerance");
+	m_fmm_parameters.mixed_precision = opts.boolValue("fmmtl-mixed-precision");
+	m_fmm_parameters.treecode = opts.boolValue("fmmtl-treecode");
+	m_fmm_cache = NULL;
 	// construct the surface tracker
 	double mean_edge_len = opts.doubleValue("remeshing-resolution");
 	m_sim_options.iter = opts.intValue("remeshing-iterations");
@@ -95,11 +105,17 @@ VS3D::VS3D(const std::vector<LosTopos::Vec3d> & vs,
 	params.m_allow_non_manifold = opts.boolValue("lostopos-allow-non-manifold");
 	params.m_allow_topology_changes = opts.boolValue("lostopos-allow-topology-changes");
 	params.m_collision_safety = true;
+	params.m_use_hashed_broad_phase = opts.boolValue("lostopos-hashed-broad-phase");
+	params.m_localized_rollback = opts.boolValue("lostopos-localized-rollback");
+	params.m_defrag_threshold = opts.doubleValue("lostopos-defrag-threshold");
+	params.m_queued_remeshing = opts.boolValue("lostopos-queued-remeshing");
+	params.m_queued_snapping = opts.boolValue("lostopos-queued-snapping");
+	params.m_parallel_smoothing = opts.boolValue("lostopos-parallel-smoothing");
 	params.m_remesh_boundaries = true;
 	params.m_t1_transition_enabled = opts.boolValue("lostopos-t1-transition-enabled");
 	params.m_pull_apart_distance = opts.doubleValue("lostopos-t1-pull-apart-distance-fraction") * mean_edge_len;
 
-	params.m_velocity_field_callback = NULL;
+	params.m_velocity_field_callback = (opts.boolValue("lostopos-t1-velocity-field") ? this : NULL);
 
 
 	if (opts.boolValue("lostopos-smooth-subdivision"))
@@ -215,6 +231,15 @@ VS3D::VS3D(const std::vector<LosTopos::Vec3d> & vs,
 	m_st->m_solid_vertices_callback = this;
 	m_st->m_mesheventcallback = this;
 
+	// adaptive remeshing: the global edge length bounds become the finest resolution, scaled up per vertex by the sizing field
+	m_sizing = NULL;
+	m_sizing_velocity_valid = false;
+	if (m_sim_options.sizing_field)
+	{
+		m_sizing = new LosTopos::NonDestructiveTriMesh::VertexData<double>(&(m_st->m_mesh));
+		m_st->m_sizing_field_callback = this;
+	}
+
 
 	// find out the number of regions
 	m_nregion = 0;
@@ -249,6 +274,7 @@ VS3D::~VS3D()
 		delete f;
 
 	if (m_constraint_stepper) delete m_constraint_stepper;
+	if (m_fmm_cache) delete m_fmm_cache;
 }
 
 namespace
@@ -278,15 +304,45 @@ double VS3D::step(double dt)
 
 
 	// mesh improvement
+	if (m_sizing)
+		update_sizing_field();
+
 	for (int i = 0; i < m_sim_options.iter; i++)
 	{
-		m_st->topology_changes();
-		m_st->improve_mesh();
+		if (!m_sim_options.quality_triggered_remeshing)
+		{
+			m_st->topology_changes();
+			m_st->improve_mesh();
+			continue;
+		}
+
+		// only remesh while the mesh has edges out of bounds, bad angles, T1 candidates or elements within merge distance;
+		//  on calm frames this skips the remeshing passes entirely.
+		LosTopos::RemeshingIndicators indicators;
+		m_st->compute_remeshing_indicators(indicators);
+		if (m_st->topology_changes_needed(indicators))
+		{
+			m_st->topology_changes();
+			m_st->improve_mesh();
+		}
+		else if (m_st->improvement_needed(indicators))
+		{
+			m_st->improve_mesh();
+		}
+		else
+		{
+			break;
+		}
 	}
 
-	// defrag the mesh in the end, to ensure the next step starts with a clean mesh
-	m_st->defrag_mesh_from_scratch(m_constrained_vertices);
-	for (size_t i = 0; i < m_constrained_vertices.size(); i++) assert(m_constrained_vertices[i] < mesh().nv());
+	// recycle the slots of the elements deleted by remeshing. the mesh is only defragmented (remapping the constrained vertices) once the deleted
+	//  fraction exceeds the threshold; otherwise vertex indices, including those of the constrained vertices, stay as they are.
+	if (m_st->defrag_mesh_incremental(m_constrained_vertices))
+	{
+		m_constrained_mapping.clear();
+		m_constrained_mapping.insert(m_constrained_vertices.begin(), m_constrained_vertices.end());
+	}
+	for (size_t i = 0; i < m_constrained_vertices.size(); i++) assert(m_constrained_vertices[i] < mesh().nv() && !mesh().vertex_is_deleted(m_constrained_vertices[i]));
 
 
 
@@ -358,6 +414,8 @@ double VS3D::step(double dt)
 
 		for (size_t i = 0; i < mesh().nt(); i++)
 		{
+			if (mesh().triangle_is_deleted(i))
+				continue;
 			LosTopos::Vec3st t = mesh().get_triangle(i);
 			LosTopos::Vec2i l = mesh().get_triangle_label(i);
 			incident_region_pairs[t[0]](l[0], l[1]) = incident_region_pairs[t[0]](l[1], l[0]) = true;
@@ -679,11 +737,22 @@ double VS3D::step(double dt)
 	}
 
 
+	// sample the tracer velocities in the field of the final vortex sheet strengths, before the mesh moves
+	if (!m_tracers.empty())
+		sampleVelocities(m_tracers, m_tracer_velocities);
+	else
+		m_tracer_velocities.clear();
+
 	// move the mesh
 	double actual_dt;
 	m_st->integrate(dt, actual_dt);
 	if (actual_dt != dt)
 		std::cout << "Warning: SurfTrack::integrate() failed to step the full length of the time step!" << std::endl;
+	m_sizing_velocity_valid = true;
+
+	// advect the tracers by the part of the time step the mesh actually took
+	for (size_t i = 0; i < m_tracers.size(); i++)
+		m_tracers[i] += m_tracer_velocities[i] * actual_dt;
 
 
 
@@ -704,6 +773,8 @@ void VS3D::update_dbg_quantities()
 
 			for (size_t j = 0; j < mesh().nt(); j++)
 			{
+				if (mesh().triangle_is_deleted(j))
+					continue;
 				LosTopos::Vec3st t = mesh().get_triangle(j);
 				LosTopos::Vec2i l = mesh().get_triangle_label(j);
 				Vec3d xp = (pos(t[0]) + pos(t[1]) + pos(t[2])) / 3;
@@ -853,6 +924,89 @@ void VS3D::update_dbg_quantities()
 }
 
 
+void VS3D::update_sizing_field()
+{
+	// the target edge length of each vertex lies between the mean edge length of the remeshing resolution (the finest
+	//  resolution, used at triple junctions) and sizing_max_scale times that.
+	const double mean_edge_len = (m_st->m_min_edge_length + m_st->m_max_edge_length) / 2;
+	const double max_scale = std::max(1.0, m_sim_options.sizing_max_scale);
+	const double max_len = mean_edge_len * max_scale;
+
+	// number of edges a circle with the local curvature should be resolved with (same as LosTopos' curvature-based splitting)
+	static const double CURVATURE_SEGMENTS = 16;
+	// maximum growth of the target edge length per unit distance along the surface
+	static const double GRADATION = 0.5;
+
+	std::vector<double> target(mesh().nv(), max_len);
+
+	// curvature, estimated from the bend across each edge
+	for (size_t i = 0; i < mesh().ne(); i++)
+	{
+		if (mesh().edge_is_deleted(i))
+			continue;
+
+		double len = m_st->get_edge_length(i);
+		double angle = m_st->get_largest_dihedral(i);
+		if (!(len > 0) || !(angle > 0))
+			continue;
+
+		double curvature_len = 2 * M_PI / CURVATURE_SEGMENTS / (angle / len);
+		for (int k = 0; k < 2; k++)
+			target[mesh().m_edges[i][k]] = std::min(target[mesh().m_edges[i][k]], curvature_len);
+	}
+
+	// velocity: the fastest vertices get the finest resolution
+	if (m_sizing_velocity_valid && m_st->m_velocities.size() == mesh().nv())
+	{
+		double max_speed = 0;
+		for (size_t i = 0; i < mesh().nv(); i++)
+			if (!mesh().vertex_is_deleted(i))
+				max_speed = std::max(max_speed, mag(m_st->m_velocities[i]));
+
+		if (max_speed > 0)
+			for (size_t i = 0; i < mesh().nv(); i++)
+				if (!mesh().vertex_is_deleted(i))
+					target[i] = std::min(target[i], max_len / (1 + (max_scale - 1) * mag(m_st->m_velocities[i]) / max_speed));
+	}
+
+	// triple junctions
+	const std::vector<size_t> & junctions = m_st->get_junction_vertices();
+	for (size_t i = 0; i < junctions.size(); i++)
+		target[junctions[i]] = mean_edge_len;
+
+	// limit the gradation (Dijkstra from the finest vertices outward). this is also what makes the target grow with the
+	//  distance from the triple junctions.
+	typedef std::pair<double, size_t> QueueEntry;
+	std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry> > queue;
+	for (size_t i = 0; i < mesh().nv(); i++)
+		if (!mesh().vertex_is_deleted(i))
+			queue.push(QueueEntry(target[i], i));
+
+	while (!queue.empty())
+	{
+		QueueEntry top = queue.top();
+		queue.pop();
+		size_t v = top.second;
+		if (top.first > target[v])
+			continue;
+
+		for (size_t i = 0; i < mesh().m_vertex_to_edge_map[v].size(); i++)
+		{
+			size_t e = mesh().m_vertex_to_edge_map[v][i];
+			size_t vother = (mesh().m_edges[e][0] == v ? mesh().m_edges[e][1] : mesh().m_edges[e][0]);
+			double graded = target[v] + GRADATION * m_st->get_edge_length(e);
+			if (graded < target[vother])
+			{
+				target[vother] = graded;
+				queue.push(QueueEntry(graded, vother));
+			}
+		}
+	}
+
+	for (size_t i = 0; i < mesh().nv(); i++)
+		(*m_sizing)[i] = (mesh().vertex_is_deleted(i) ? 0 : std::min(std::max(target[i] / mean_edge_len, 1.0), max_scale));
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 //  Callbacks
@@ -923,14 +1077,63 @@ bool VS3D::solid_edge_is_feature(const LosTopos::SurfTrack & st, size_t e)
 	return false;
 }
 
+double VS3D::edge_length_scale(const LosTopos::SurfTrack & st, size_t v)
+{
+	if ((*m_sizing)[v] > 0)
+		return (*m_sizing)[v];
+
+	// vertices created by remeshing since the last update take the mean of their neighbors' values
+	double sum = 0;
+	int count = 0;
+	for (size_t i = 0; i < st.m_mesh.m_vertex_to_edge_map[v].size(); i++)
+	{
+		const LosTopos::Vec2st & e = st.m_mesh.m_edges[st.m_mesh.m_vertex_to_edge_map[v][i]];
+		double scale = (*m_sizing)[e[0] == v ? e[1] : e[0]];
+		if (scale > 0)
+		{
+			sum += scale;
+			count++;
+		}
+	}
+
+	return (count > 0 ? sum / count : 1);
+}
+
 LosTopos::Vec3d VS3D::sampleVelocity(LosTopos::Vec3d & pos)
 {
-	return LosTopos::Vec3d(0, 0, 0);
+	std::vector<Vec3d> points(1, vc(pos));
+	std::vector<Vec3d> velocities;
+	sampleVelocities(points, velocities);
+	return vc(velocities[0]);
 }
 
 bool VS3D::sampleDirectionalDivergence(const LosTopos::Vec3d & pos, const LosTopos::Vec3d & dir, double & output)
 {
-	return false;
+	std::vector<double> divergences;
+	if (!sampleDirectionalDivergences(std::vector<LosTopos::Vec3d>(1, pos), std::vector<LosTopos::Vec3d>(1, dir), divergences))
+		return false;
+	output = divergences[0];
+	return true;
+}
+
+bool VS3D::sampleDirectionalDivergences(const std::vector<LosTopos::Vec3d> & positions, const std::vector<LosTopos::Vec3d> & directions, std::vector<double> & divergences)
+{
+	// the divergence along dir is dir^T grad(u) dir, from one evaluation of the velocity gradients at all the positions
+	std::vector<Vec3d> points(positions.size());
+	for (size_t i = 0; i < positions.size(); i++)
+		points[i] = vc(positions[i]);
+
+	std::vector<Vec3d> velocities;
+	std::vector<Mat3d> gradients;
+	sampleVelocities(points, velocities, &gradients);
+
+	divergences.resize(positions.size());
+	for (size_t i = 0; i < positions.size(); i++)
+	{
+		Vec3d d = vc(directions[i]);
+		divergences[i] = d.dot(gradients[i] * d);
+	}
+	return true;
 }
 
 struct CollapseTempData
@@ -22,7 +22,7 @@
 class Sim;
 class Scenes;
 
-class VS3D : public LosTopos::SurfTrack::SolidVerticesCallback, public LosTopos::T1Transition::VelocityFieldCallback, public LosTopos::SurfTrack::MeshEventCallback
+class VS3D : public LosTopos::SurfTrack::SolidVerticesCallback, public LosTopos::T1Transition::VelocityFieldCallback, public LosTopos::SurfTrack::MeshEventCallback, public LosTopos::SurfTrack::SizingFieldCallback
 {
     friend class Sim;
     friend class Scenes;
@@ -60,12 +60,61 @@ public:
 		int iter;
 		bool rk4;
 		double frame;
+		bool sizing_field;
+		double sizing_max_scale;
+		bool quality_triggered_remeshing;
+		bool fmm_autotune;
+		double fmm_tolerance;
 
-        SimOptions() : implicit(false), pbd(false), smoothing_coef(0), damping_coef(1), sigma(1), gravity(0), iter(0), rk4(0), frame(0)
+        SimOptions() : implicit(false), pbd(false), smoothing_coef(0), damping_coef(1), sigma(1), gravity(0), iter(0), rk4(0), frame(0), sizing_field(false), sizing_max_scale(1), quality_triggered_remeshing(false), fmm_autotune(false), fmm_tolerance(1e-4)
         { }
     };
     
     SimOptions & simOptions() { return m_sim_options; }
+
+    // parameters of the FMM Biot-Savart evaluation, chosen by the auto-tuning in BiotSavart_fmmtl() when fmm_autotune is on
+    class FMMParameters
+    {
+    public:
+        unsigned ncrit;     // maximum number of bodies in a tree leaf
+        double theta;       // multipole acceptance criterion aperture
+        int order;          // expansion order
+        size_t nsources;    // number of sources when the parameters were tuned (0 if they never were)
+        double delta;       // regularization parameter when the parameters were tuned
+        bool mixed_precision;   // whether the multipole and local expansions are single precision (the near field and the results stay double)
+        bool treecode;          // whether the far field is a Barnes-Hut treecode (multipoles evaluated at the targets) instead of the FMM
+
+        FMMParameters() : ncrit(128), theta(0.5), order(5), nsources(0), delta(0), mixed_precision(false), treecode(false)
+        { }
+    };
+    
+    // FMM trees and interaction lists kept from one Biot-Savart evaluation to the next, while the bodies move little (defined in VS3DExplicit.cpp)
+    class FMMCache
+    {
+    public:
+        virtual ~FMMCache() { }
+    };
+    
+    // accuracy, speed and memory of a Biot-Savart evaluator on the current state, measured against BiotSavart_naive()
+    class EvaluatorReport
+    {
+    public:
+        std::string name;
+        FMMParameters parameters;   // FMM parameters (FMM evaluators only)
+        double seconds;             // wall clock time, including the tree construction for the FMM
+        double relative_l2_error;   // L2 norm of the velocity error over all vertices, relative to that of the reference velocities
+        double relative_max_error;  // largest vertex velocity error, relative to the largest reference vertex velocity
+        double max_error;           // largest vertex velocity error
+        size_t memory;              // bytes held by the FMM trees, permuted bodies and expansions (FMM evaluators only)
+
+        EvaluatorReport() : seconds(0), relative_l2_error(0), relative_max_error(0), max_error(0), memory(0)
+        { }
+    };
+    
+    // run every available Biot-Savart evaluator on the current state: the naive summation (the reference), the FMM with the
+    //  current parameters and the FMM with each of the candidate parameters
+    std::vector<EvaluatorReport> compareEvaluators(const std::vector<FMMParameters> & fmm_candidates = std::vector<FMMParameters>());
+    static void printEvaluatorReports(std::ostream & os, const std::vector<EvaluatorReport> & reports);
     
 public:
     const LosTopos::SurfTrack * surfTrack() const { return m_st; }
@@ -79,6 +128,14 @@ public:
     
     void update_dbg_quantities();
 	Vec3d get_velocity(int v);
+
+    // Biot-Savart velocity (and optionally its gradient, grad(i, j) = du_i/dx_j) at arbitrary points, by the FMM if the "fmmtl" option is on and the problem is large enough
+    void sampleVelocities(const std::vector<Vec3d> & points, std::vector<Vec3d> & velocities, std::vector<Mat3d> * gradients = NULL);
+
+    // passive tracer particles, advected through the Biot-Savart field in each step; the velocities are those of the last step
+    const std::vector<Vec3d> & tracers() const { return m_tracers; }
+          std::vector<Vec3d> & tracers()       { return m_tracers; }
+    const std::vector<Vec3d> & tracerVelocities() const { return m_tracer_velocities; }
 	double get_curvature(int v);
 
     const std::vector<size_t> & constrainedVertices() const { return m_constrained_vertices; }
@@ -151,6 +208,7 @@ protected:
     // T1Transition::VelocityFieldCallback methods
     LosTopos::Vec3d sampleVelocity(LosTopos::Vec3d & pos);
     bool sampleDirectionalDivergence(const LosTopos::Vec3d & pos, const LosTopos::Vec3d & dir, double & output);
+    bool sampleDirectionalDivergences(const std::vector<LosTopos::Vec3d> & positions, const std::vector<LosTopos::Vec3d> & directions, std::vector<double> & divergences);
 
     // SurfTrack::MeshEventCallback
     void pre_collapse(const LosTopos::SurfTrack & st, size_t e, void ** data);
@@ -174,6 +232,12 @@ protected:
     void pre_smoothing(const LosTopos::SurfTrack & st, void ** data);
     void post_smoothing(const LosTopos::SurfTrack & st, void * data);
 
+    // SurfTrack::SizingFieldCallback
+    double edge_length_scale(const LosTopos::SurfTrack & st, size_t v);
+
+    // recompute the per-vertex edge length scale from curvature, distance to triple junctions and velocity
+    void update_sizing_field();
+
     std::ostream & log() { static std::stringstream ss; return ss; }
 
 protected:
@@ -186,6 +250,18 @@ protected:
     int m_nregion;
     LosTopos::NonDestructiveTriMesh::VertexData<GammaType> * m_Gamma;     // average circulation of a vertex \Gamma (one scalar value for each region pair incident to the vertex)
 
+    // adaptive remeshing
+    LosTopos::NonDestructiveTriMesh::VertexData<double> * m_sizing;       // edge length scale of a vertex (0 for vertices created since the last update_sizing_field()); NULL if the sizing field is off
+    bool m_sizing_velocity_valid;                                          // whether m_st->m_velocities holds the velocities of the last time step
+
+    // FMM Biot-Savart evaluation
+    FMMParameters m_fmm_parameters;
+    FMMCache * m_fmm_cache;     // NULL until the first FMM evaluation
+
+    // tracer particles
+    std::vector<Vec3d> m_tracers;
+    std::vector<Vec3d> m_tracer_velocities;
+
     std::vector<Vec3d> m_dbg_t1;
     std::vector<Vec3d> m_dbg_t2;
     std::vector<std::vector<double> > m_dbg_e1;
@@ -8,13 +8,17 @@
 
 #include "VS3D.h"
 #include "SimOptions.h"
+#include <chrono>
+#include <iomanip>
 
 #ifndef WIN32
 #include "fmmtl/fmmtl/KernelMatrix.hpp"
 #include "fmmtl/kernel/BiotSpherical.hpp"
 #include "fmmtl/kernel/RMSpherical.hpp"
+#include "fmmtl/kernel/RMGradientSpherical.hpp"
 #include "fmmtl/fmmtl/Direct.hpp"
 #include "fmmtl/fmmtl/util/Clock.hpp"
+#include <limits>
 #endif
 
 namespace
@@ -33,6 +37,36 @@ namespace
         return atan2(v1.dot(v), v1.dot(u));
     }
     
+    // the vortex sheet elements of the Biot-Savart integral with the vertices displaced by dx: the centroid of each triangle and its vortex sheet strength integrated over the triangle
+    void vortexSheetElements(VS3D & vs, const VecXd & dx, std::vector<Vec3d> & centroids, std::vector<Vec3d> & strengths)
+    {
+        centroids.clear();
+        strengths.clear();
+        
+        for (size_t j = 0; j < vs.mesh().nt(); j++)
+        {
+            if (vs.mesh().triangle_is_deleted(j))
+                continue;
+            LosTopos::Vec3st t = vs.mesh().get_triangle(j);
+            if (vs.surfTrack()->vertex_is_any_solid(t[0]) && vs.surfTrack()->vertex_is_any_solid(t[1]) && vs.surfTrack()->vertex_is_any_solid(t[2]))
+                continue;   // all-solid faces don't contribute vorticity.
+            
+            LosTopos::Vec2i l = vs.mesh().get_triangle_label(j);
+            Vec3d x0 = vs.pos(t[0]) + dx.segment<3>(t[0] * 3);
+            Vec3d x1 = vs.pos(t[1]) + dx.segment<3>(t[1] * 3);
+            Vec3d x2 = vs.pos(t[2]) + dx.segment<3>(t[2] * 3);
+            
+            Vec3d e01 = x1 - x0;
+            Vec3d e12 = x2 - x1;
+            Vec3d e20 = x0 - x2;
+            
+            centroids.push_back((x0 + x1 + x2) / 3);
+            strengths.push_back(-(e01 * vs.Gamma(t[2]).get(l) +
+                                  e12 * vs.Gamma(t[0]).get(l) +
+                                  e20 * vs.Gamma(t[1]).get(l)));
+        }
+    }
+    
 }
 
     VecXd BiotSavart_naive(VS3D & vs, const VecXd & dx)
@@ -45,6 +79,8 @@ namespace
             
             for (size_t j = 0; j < vs.mesh().nt(); j++)
             {
+                if (vs.mesh().triangle_is_deleted(j))
+                    continue;
                 LosTopos::Vec3st t = vs.mesh().get_triangle(j);
                 if (vs.surfTrack()->vertex_is_any_solid(t[0]) && vs.surfTrack()->vertex_is_any_solid(t[1]) && vs.surfTrack()->vertex_is_any_solid(t[2]))
                     continue;   // all-solid faces don't contribute vorticity.
@@ -96,77 +132,278 @@ namespace
         return vel;
     }
 #ifndef WIN32
-    VecXd BiotSavart_fmmtl(VS3D & vs, const VecXd & dx)
+namespace
+{
+//    typedef BiotSpherical fmm_kernel_type;
+    typedef RMSpherical fmm_kernel_type;
+    typedef RMSphericalMixed fmm_mixed_kernel_type;         // single precision expansions, same near field and results
+
+    typedef RMGradientSpherical fmm_gradient_kernel_type;   // velocity and velocity gradient
+    
+    // fmmtl options for the given parameters
+    FMMOptions fmmOptions(const VS3D::FMMParameters & params)
     {
-        // code adapted from FMMTL example test "error_biot.cpp"
-        
-        // Init the FMM Kernel and options
         FMMOptions opts = get_options(0, NULL);
-//        typedef BiotSpherical kernel_type;
-        typedef RMSpherical kernel_type;
+        opts.ncrit = params.ncrit;
+        opts.theta = params.theta;
+        opts.evaluator = (params.treecode ? FMMOptions::TREECODE : FMMOptions::FMM);
+        return opts;
+    }
+    
+    // FMM (or treecode) evaluation of the Biot-Savart integral with the given parameters; returns the wall clock time including the tree construction,
+    //  and the bytes held by the trees, permuted bodies and expansions of the evaluation in memory if given
+    template <typename Expansion>
+    double evaluateFMM(const VS3D::FMMParameters & params, double delta, const std::vector<typename Expansion::target_type> & targets, const std::vector<typename Expansion::source_type> & sources, const std::vector<typename Expansion::charge_type> & charges, std::vector<typename Expansion::result_type> & result, size_t * memory = NULL)
+    {
+        FMMOptions opts = fmmOptions(params);
         
-        // Init kernel
-        kernel_type K(vs.delta());
+        Expansion K(delta, params.order);
         
-        typedef kernel_type::point_type point_type;
-        typedef kernel_type::source_type source_type;
-        typedef kernel_type::target_type target_type;
-        typedef kernel_type::charge_type charge_type;
-        typedef kernel_type::result_type result_type;
+        Clock t;
+        fmmtl::kernel_matrix<Expansion> A = K(targets, sources);
+        A.set_options(opts);
+        result = A * charges;
+        double seconds = t.seconds();
+        if (memory)
+            *memory = A.plan_memory();
+        return seconds;
+    }
+    
+    // FMM evaluation of the Biot-Savart velocity, with single precision expansions if the parameters ask for mixed precision
+    double evaluateFMMVelocity(const VS3D::FMMParameters & params, double delta, const std::vector<fmm_kernel_type::target_type> & targets, const std::vector<fmm_kernel_type::source_type> & sources, const std::vector<fmm_kernel_type::charge_type> & charges, std::vector<fmm_kernel_type::result_type> & result, size_t * memory = NULL)
+    {
+        if (params.mixed_precision)
+            return evaluateFMM<fmm_mixed_kernel_type>(params, delta, targets, sources, charges, result, memory);
+        else
+            return evaluateFMM<fmm_kernel_type>(params, delta, targets, sources, charges, result, memory);
+    }
+    
+    // how far a body may stray from the center of the leaf box it was sorted into, relative to the box radius, before the cached FMM trees are rebuilt.
+    //  the multipole acceptance criterion of the kept interaction lists then holds for box radii grown by this factor.
+    static const double FMM_REFIT_SLACK = 0.25;
+    
+    // an FMM matrix whose trees and interaction lists are reused by later evaluations with the same parameters, as long as the numbers of targets and
+    //  sources stay the same and every body stays close to its leaf box. targets and sources are matched to the trees by their order.
+    template <typename Expansion>
+    class FMMMatrixCache : public VS3D::FMMCache
+    {
+    public:
+        FMMMatrixCache(const VS3D::FMMParameters & params, double delta, const std::vector<typename Expansion::target_type> & targets, const std::vector<typename Expansion::source_type> & sources) :
+            m_parameters(params),
+            m_delta(delta),
+            m_matrix(Expansion(delta, params.order), targets, sources)
+        {
+            m_matrix.set_options(fmmOptions(params));
+        }
         
-        // Init points and charges
-        std::vector<source_type> sources;
-        std::vector<target_type> targets;
-        std::vector<charge_type> charges;
+        bool matches(const VS3D::FMMParameters & params, double delta) const
+        {
+            return m_parameters.ncrit == params.ncrit && m_parameters.theta == params.theta && m_parameters.order == params.order && m_parameters.treecode == params.treecode && m_delta == delta;
+        }
+        
+        fmmtl::kernel_matrix<Expansion> & matrix() { return m_matrix; }
+        
+    protected:
+        VS3D::FMMParameters m_parameters;
+        double m_delta;
+        fmmtl::kernel_matrix<Expansion> m_matrix;
+    };
+    
+    // FMM evaluation reusing the trees and interaction lists in the cache when they still fit the targets and sources; the cache is replaced otherwise
+    template <typename Expansion>
+    void evaluateFMMCached(VS3D::FMMCache * & cache, const VS3D::FMMParameters & params, double delta, const std::vector<typename Expansion::target_type> & targets, const std::vector<typename Expansion::source_type> & sources, const std::vector<typename Expansion::charge_type> & charges, std::vector<typename Expansion::result_type> & result)
+    {
+        FMMMatrixCache<Expansion> * matrix_cache = dynamic_cast<FMMMatrixCache<Expansion> *>(cache);
+        if (matrix_cache && matrix_cache->matches(params, delta))
+        {
+            matrix_cache->matrix().reposition(targets, sources, FMM_REFIT_SLACK);
+        } else
+        {
+            delete cache;
+            cache = matrix_cache = new FMMMatrixCache<Expansion>(params, delta, targets, sources);
+        }
+        
+        result = matrix_cache->matrix() * charges;
+    }
+    
+    // cached FMM evaluation of the Biot-Savart velocity, with single precision expansions if the parameters ask for mixed precision
+    void evaluateFMMVelocityCached(VS3D::FMMCache * & cache, const VS3D::FMMParameters & params, double delta, const std::vector<fmm_kernel_type::target_type> & targets, const std::vector<fmm_kernel_type::source_type> & sources, const std::vector<fmm_kernel_type::charge_type> & charges, std::vector<fmm_kernel_type::result_type> & result)
+    {
+        if (params.mixed_precision)
+            evaluateFMMCached<fmm_mixed_kernel_type>(cache, params, delta, targets, sources, charges, result);
+        else
+            evaluateFMMCached<fmm_kernel_type>(cache, params, delta, targets, sources, charges, result);
+    }
+    
+    // choose the fastest FMM parameters whose relative error, measured against direct summation on a subset of the targets, is within tolerance
+    void tuneFMM(VS3D::FMMParameters & params, double delta, double tolerance, const std::vector<fmm_kernel_type::target_type> & targets, const std::vector<fmm_kernel_type::source_type> & sources, const std::vector<fmm_kernel_type::charge_type> & charges)
+    {
+        typedef fmm_kernel_type::target_type target_type;
+        typedef fmm_kernel_type::result_type result_type;
+        
+        static const size_t NUM_SAMPLES = 256;
+        static const double THETAS[] = { 0.3, 0.4, 0.5, 0.6, 0.7 };
+        static const unsigned NCRITS[] = { 32, 64, 256 };
+        static const int MIN_ORDER = 2;
+        static const int MAX_ORDER = 12;
+        
+        // reference velocities by direct summation at evenly strided targets
+        size_t stride = std::max(targets.size() / NUM_SAMPLES, (size_t)1);
+        std::vector<size_t> samples;
+        std::vector<target_type> sample_targets;
+        for (size_t i = 0; i < targets.size(); i += stride)
+        {
+            samples.push_back(i);
+            sample_targets.push_back(targets[i]);
+        }
+        
+        std::vector<result_type> reference(samples.size(), result_type(0));
+        RosenheadMoore direct_kernel(delta);
+        fmmtl::direct(direct_kernel, sources.begin(), sources.end(), charges.begin(), sample_targets.begin(), sample_targets.end(), reference.begin());
+        
+        double reference_norm_sq = 0;
+        for (size_t i = 0; i < samples.size(); i++)
+            reference_norm_sq += norm_2_sq(reference[i]);
+        
+        std::vector<result_type> result;
+        auto relative_error = [&] ()
+        {
+            double error_sq = 0;
+            for (size_t i = 0; i < samples.size(); i++)
+                error_sq += norm_2_sq(result[samples[i]] - reference[i]);
+            return reference_norm_sq > 0 ? std::sqrt(error_sq / reference_norm_sq) : std::sqrt(error_sq);
+        };
+        
+        VS3D::FMMParameters best = params;
+        double best_time = std::numeric_limits<double>::infinity();
+        double best_error = std::numeric_limits<double>::infinity();
+        VS3D::FMMParameters most_accurate = params;     // fallback if no candidate meets the tolerance
+        double most_accurate_error = std::numeric_limits<double>::infinity();
         
+        // larger apertures need at least the expansion order of smaller ones, so the order search resumes where the last aperture stopped
+        int order = MIN_ORDER;
+        for (size_t i = 0; i < sizeof (THETAS) / sizeof (THETAS[0]) && order <= MAX_ORDER; i++)
+        {
+            for ( ; order <= MAX_ORDER; order++)
+            {
+                VS3D::FMMParameters candidate = params;
+                candidate.ncrit = 128;
+                candidate.theta = THETAS[i];
+                candidate.order = order;
+                
+                double time = evaluateFMMVelocity(candidate, delta, targets, sources, charges, result);
+                double error = relative_error();
+                if (error < most_accurate_error)
+                {
+                    most_accurate = candidate;
+                    most_accurate_error = error;
+                }
+                
+                if (error <= tolerance)
+                {
+                    if (time < best_time)
+                    {
+                        best = candidate;
+                        best_time = time;
+                        best_error = error;
+                    }
+                    break;
+                }
+                
+                // higher orders are only slower than the best candidate so far
+                if (time > best_time)
+                    break;
+            }
+        }
+        
+        if (best_time < std::numeric_limits<double>::infinity())
+        {
+            // the leaf size mostly trades near field against far field work, with little effect on the error
+            VS3D::FMMParameters base = best;
+            for (size_t i = 0; i < sizeof (NCRITS) / sizeof (NCRITS[0]); i++)
+            {
+                VS3D::FMMParameters candidate = base;
+                candidate.ncrit = NCRITS[i];
+                
+                double time = evaluateFMMVelocity(candidate, delta, targets, sources, charges, result);
+                double error = relative_error();
+                if (error <= tolerance && time < best_time)
+                {
+                    best = candidate;
+                    best_time = time;
+                    best_error = error;
+                }
+            }
+        } else
+        {
+            std::cout << "FMM auto-tuning: no parameters meet the tolerance " << tolerance << "; using the most accurate ones" << std::endl;
+            best = most_accurate;
+            best_error = most_accurate_error;
+        }
+        
+        params.ncrit = best.ncrit;
+        params.theta = best.theta;
+        params.order = best.order;
+        params.nsources = sources.size();
+        params.delta = delta;
+        
+        std::cout << "FMM auto-tuning: ncrit = " << params.ncrit << " theta = " << params.theta << " order = " << params.order << " (relative error " << best_error << ")" << std::endl;
+    }
+    
+    // whether the cached FMM parameters were tuned for a different problem: the regularization changed or the number of sources drifted by more than a factor of two
+    bool fmmNeedsTuning(const VS3D::FMMParameters & params, double delta, size_t nsources)
+    {
+        return params.nsources == 0 || params.delta != delta || nsources > params.nsources * 2 || nsources * 2 < params.nsources;
+    }
+    
+    // the targets (mesh vertices), sources (triangle centroids) and charges (vortex sheet strengths) of the FMM Biot-Savart evaluation with the vertices displaced by dx
+    void fmmBiotSavartProblem(VS3D & vs, const VecXd & dx, std::vector<fmm_kernel_type::target_type> & targets, std::vector<fmm_kernel_type::source_type> & sources, std::vector<fmm_kernel_type::charge_type> & charges)
+    {
+        targets.clear();
         for (size_t i = 0; i < vs.mesh().nv(); i++)
         {
             Vec3d x = vs.pos(i);
             targets.push_back(Vec<3, double>(x[0], x[1], x[2]));
         }
         
-        for (size_t j = 0; j < vs.mesh().nt(); j++)
+        std::vector<Vec3d> centroids;
+        std::vector<Vec3d> strengths;
+        vortexSheetElements(vs, dx, centroids, strengths);
+        sources.clear();
+        charges.clear();
+        for (size_t j = 0; j < centroids.size(); j++)
         {
-            LosTopos::Vec3st t = vs.mesh().get_triangle(j);
-            if (vs.surfTrack()->vertex_is_any_solid(t[0]) && vs.surfTrack()->vertex_is_any_solid(t[1]) && vs.surfTrack()->vertex_is_any_solid(t[2]))
-                continue;   // all-solid faces don't contribute vorticity.
-            
-            LosTopos::Vec2i l = vs.mesh().get_triangle_label(j);
-            Vec3d x0 = vs.pos(t[0]) + dx.segment<3>(t[0] * 3);
-            Vec3d x1 = vs.pos(t[1]) + dx.segment<3>(t[1] * 3);
-            Vec3d x2 = vs.pos(t[2]) + dx.segment<3>(t[2] * 3);
-            
-            Vec3d xp = (x0 + x1 + x2) / 3;
-            
-            Vec3d e01 = x1 - x0;
-            Vec3d e12 = x2 - x1;
-            Vec3d e20 = x0 - x2;
-            
-            Vec3d gamma =  -(e01 * vs.Gamma(t[2]).get(l) +
-                             e12 * vs.Gamma(t[0]).get(l) +
-                             e20 * vs.Gamma(t[1]).get(l));
-            
-//            Vec3d dx = x - xp;
-////            double dxn = dx.norm();
-//            double dxn = sqrt(dx.squaredNorm() + vs.delta() * vs.delta());
-//            
-//            v += gamma.cross(dx) / (dxn * dxn * dxn);
-////            v += gamma.cross(dx) / (dxn * dxn * dxn) * (1 - exp(-dxn / m_delta));
-            
-            sources.push_back(Vec<3, double>(xp[0], xp[1], xp[2]));
-            charges.push_back(Vec<3, double>(gamma[0], gamma[1], gamma[2]));
+            sources.push_back(Vec<3, double>(centroids[j][0], centroids[j][1], centroids[j][2]));
+            charges.push_back(Vec<3, double>(strengths[j][0], strengths[j][1], strengths[j][2]));
         }
+    }
+}
+
+    VecXd BiotSavart_fmmtl(VS3D & vs, const VecXd & dx)
+    {
+        // code adapted from FMMTL example test "error_biot.cpp"
         
+        typedef fmm_kernel_type kernel_type;
         
+        typedef kernel_type::point_type point_type;
+        typedef kernel_type::source_type source_type;
+        typedef kernel_type::target_type target_type;
+        typedef kernel_type::charge_type charge_type;
+        typedef kernel_type::result_type result_type;
         
-        // Build the FMM
-        fmmtl::kernel_matrix<kernel_type> A = K(targets, sources);
-        A.set_options(opts);
+        // Init points and charges
+        std::vector<source_type> sources;
+        std::vector<target_type> targets;
+        std::vector<charge_type> charges;
+        fmmBiotSavartProblem(vs, dx, targets, sources, charges);
+        
+        // Pick the FMM parameters, re-tuning them if the scene has changed too much since they were chosen
+        if (vs.m_sim_options.fmm_autotune && !sources.empty() && fmmNeedsTuning(vs.m_fmm_parameters, vs.delta(), sources.size()))
+            tuneFMM(vs.m_fmm_parameters, vs.delta(), vs.m_sim_options.fmm_tolerance, targets, sources, charges);
         
-        // Execute the FMM
-        Clock t1;
-        std::vector<result_type> result = A * charges;
-        double time1 = t1.seconds();
+        // Execute the FMM, rebuilding the trees only if the mesh moved too far since they were built
+        std::vector<result_type> result;
+        evaluateFMMVelocityCached(vs.m_fmm_cache, vs.m_fmm_parameters, vs.delta(), targets, sources, charges, result);
         
         VecXd vel = VecXd::Zero(vs.mesh().nv() * 3);
         for (size_t i = 0; i < vs.mesh().nv(); i++)
@@ -191,6 +428,188 @@ namespace
             return BiotSavart_naive(vs, dx);
     }
 
+void VS3D::sampleVelocities(const std::vector<Vec3d> & points, std::vector<Vec3d> & velocities, std::vector<Mat3d> * gradients)
+{
+    // direct summation is faster than building the FMM trees for small problems
+    static const double FMM_MIN_INTERACTIONS = 4e6;
+    
+    velocities.assign(points.size(), Vec3d::Zero());
+    if (gradients)
+        gradients->assign(points.size(), Mat3d::Zero());
+    if (points.empty())
+        return;
+    
+    std::vector<Vec3d> centroids;
+    std::vector<Vec3d> strengths;
+    vortexSheetElements(*this, VecXd::Zero(mesh().nv() * 3), centroids, strengths);
+    
+    // open boundary extra face contributions
+    if (m_obefv.size() == m_obefe.size() && m_obefv.size() == m_obefc.size())
+    {
+        for (size_t j = 0; j < m_obefv.size(); j++)
+        {
+            centroids.push_back(m_obefc[j]);
+            strengths.push_back(m_obefe[j] * m_obefv[j]);
+        }
+    }
+    
+#ifndef WIN32
+    if (Options::boolValue("fmmtl") && (double)points.size() * centroids.size() >= FMM_MIN_INTERACTIONS)
+    {
+        std::vector<Vec<3, double> > targets(points.size());
+        std::vector<Vec<3, double> > sources(centroids.size());
+        std::vector<Vec<3, double> > charges(centroids.size());
+        for (size_t i = 0; i < points.size(); i++)
+            targets[i] = Vec<3, double>(points[i][0], points[i][1], points[i][2]);
+        for (size_t j = 0; j < centroids.size(); j++)
+        {
+            sources[j] = Vec<3, double>(centroids[j][0], centroids[j][1], centroids[j][2]);
+            charges[j] = Vec<3, double>(strengths[j][0], strengths[j][1], strengths[j][2]);
+        }
+        
+        if (gradients)
+        {
+            std::vector<fmm_gradient_kernel_type::result_type> result;
+            evaluateFMM<fmm_gradient_kernel_type>(m_fmm_parameters, delta(), targets, sources, charges, result);
+            for (size_t i = 0; i < points.size(); i++)
+            {
+                velocities[i] = Vec3d(result[i][0], result[i][1], result[i][2]) / (4 * M_PI);
+                for (int k = 0; k < 9; k++)
+                    (*gradients)[i](k / 3, k % 3) = result[i][3 + k] / (4 * M_PI);
+            }
+        } else
+        {
+            std::vector<fmm_kernel_type::result_type> result;
+            evaluateFMMVelocity(m_fmm_parameters, delta(), targets, sources, charges, result);
+            for (size_t i = 0; i < points.size(); i++)
+                velocities[i] = Vec3d(result[i][0], result[i][1], result[i][2]) / (4 * M_PI);
+        }
+        return;
+    }
+#endif
+    
+    // direct summation, with the same regularization as BiotSavart_naive()
+    double delta_sq = delta() * delta();
+    int npoints = (int)points.size();
+#pragma omp parallel for schedule(static)
+    for (int i = 0; i < npoints; i++)
+    {
+        Vec3d v(0, 0, 0);
+        Mat3d grad = Mat3d::Zero();
+        for (size_t j = 0; j < centroids.size(); j++)
+        {
+            Vec3d dx = points[i] - centroids[j];
+            double dxn2 = dx.squaredNorm() + delta_sq;
+            double f = 1 / (dxn2 * sqrt(dxn2));
+            Vec3d u = strengths[j].cross(dx) * f;
+            v += u;
+            
+            if (gradients)
+            {
+                // d/dx (gamma x dx) / |dx|^3 = [gamma]_x / |dx|^3 - 3 (gamma x dx) dx^T / |dx|^5
+                const Vec3d & g = strengths[j];
+                grad(0, 1) -= g[2] * f;  grad(0, 2) += g[1] * f;
+                grad(1, 0) += g[2] * f;  grad(1, 2) -= g[0] * f;
+                grad(2, 0) -= g[1] * f;  grad(2, 1) += g[0] * f;
+                grad -= (3 / dxn2) * u * dx.transpose();
+            }
+        }
+        
+        velocities[i] = v / (4 * M_PI);
+        if (gradients)
+            (*gradients)[i] = grad / (4 * M_PI);
+    }
+}
+
+std::vector<VS3D::EvaluatorReport> VS3D::compareEvaluators(const std::vector<FMMParameters> & fmm_candidates)
+{
+    typedef std::chrono::steady_clock clock_type;
+    
+    std::vector<EvaluatorReport> reports;
+    
+    // the naive summation is the reference
+    EvaluatorReport naive;
+    naive.name = "naive";
+    clock_type::time_point start = clock_type::now();
+    VecXd reference = BiotSavart_naive(*this, VecXd::Zero(mesh().nv() * 3));
+    naive.seconds = std::chrono::duration<double>(clock_type::now() - start).count();
+    reports.push_back(naive);
+    
+    double reference_norm = reference.norm();
+    double reference_max = 0;
+    for (size_t i = 0; i < mesh().nv(); i++)
+        reference_max = std::max(reference_max, reference.segment<3>(i * 3).norm());
+    
+    auto measure_error = [&] (EvaluatorReport & report, const VecXd & v)
+    {
+        report.max_error = 0;
+        for (size_t i = 0; i < mesh().nv(); i++)
+            report.max_error = std::max(report.max_error, (v.segment<3>(i * 3) - reference.segment<3>(i * 3)).norm());
+        report.relative_l2_error = (reference_norm > 0 ? (v - reference).norm() / reference_norm : (v - reference).norm());
+        report.relative_max_error = (reference_max > 0 ? report.max_error / reference_max : report.max_error);
+    };
+    
+#ifndef WIN32
+    // the FMM with the current parameters, then each candidate. the time includes the tree construction, as in a time step
+    std::vector<FMMParameters> candidates(1, m_fmm_parameters);
+    candidates.insert(candidates.end(), fmm_candidates.begin(), fmm_candidates.end());
+    
+    std::vector<fmm_kernel_type::target_type> targets;
+    std::vector<fmm_kernel_type::source_type> sources;
+    std::vector<fmm_kernel_type::charge_type> charges;
+    fmmBiotSavartProblem(*this, VecXd::Zero(mesh().nv() * 3), targets, sources, charges);
+    
+    for (size_t k = 0; k < candidates.size(); k++)
+    {
+        EvaluatorReport report;
+        report.name = (k == 0 ? "fmmtl" : "fmmtl candidate");
+        if (candidates[k].mixed_precision)
+            report.name += " mixed";
+        if (candidates[k].treecode)
+            report.name += " treecode";
+        report.parameters = candidates[k];
+        
+        std::vector<fmm_kernel_type::result_type> result;
+        report.seconds = evaluateFMMVelocity(candidates[k], delta(), targets, sources, charges, result, &report.memory);
+        
+        VecXd v = VecXd::Zero(mesh().nv() * 3);
+        for (size_t i = 0; i < mesh().nv(); i++)
+            v.segment<3>(i * 3) = Vec3d(result[i][0], result[i][1], result[i][2]) / (4 * M_PI);
+        measure_error(report, v);
+        
+        reports.push_back(report);
+    }
+#endif
+    
+    return reports;
+}
+
+void VS3D::printEvaluatorReports(std::ostream & os, const std::vector<EvaluatorReport> & reports)
+{
+    std::streamsize precision = os.precision();
+    os << std::left << std::setw(32) << "evaluator" << std::right
+       << std::setw(7) << "ncrit" << std::setw(7) << "theta" << std::setw(7) << "order"
+       << std::setw(12) << "time (s)" << std::setw(14) << "rel L2 err" << std::setw(14) << "rel max err" << std::setw(14) << "max err" << std::setw(14) << "memory (MB)" << std::endl;
+    
+    for (size_t i = 0; i < reports.size(); i++)
+    {
+        const EvaluatorReport & r = reports[i];
+        os << std::left << std::setw(32) << r.name << std::right;
+        if (r.name == "naive")
+            os << std::setw(7) << "-" << std::setw(7) << "-" << std::setw(7) << "-";
+        else
+            os << std::setw(7) << r.parameters.ncrit << std::setw(7) << r.parameters.theta << std::setw(7) << r.parameters.order;
+        os << std::setw(12) << std::setprecision(4) << r.seconds
+           << std::setw(14) << std::setprecision(3) << r.relative_l2_error << std::setw(14) << r.relative_max_error << std::setw(14) << r.max_error
+           << std::setw(14) << std::setprecision(4);
+        if (r.name == "naive")
+            os << "-" << std::endl;
+        else
+            os << r.memory / (1024.0 * 1024.0) << std::endl;
+    }
+    os.precision(precision);
+}
+
 //#define FANGS_VERSION
 //#define FANGS_PATCHED
 
@@ -54,6 +54,8 @@ namespace
             
             for (size_t j = 0; j < nt; j++)
             {
+                if (vs.mesh().triangle_is_deleted(j))
+                    continue;
                 LosTopos::Vec2i l = vs.mesh().get_triangle_label(j);
                 Vec2i rp = (l[0] < l[1] ? Vec2i(l[0], l[1]) : Vec2i(l[1], l[0]));
                 
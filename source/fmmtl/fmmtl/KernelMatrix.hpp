@@ -130,6 +130,32 @@ class kernel_matrix {
     return result;
   }
 
+  /** @brief Replace the targets and sources with moved ones, keeping the
+   * trees and interaction lists of the matrix-vector product plan if they
+   * still fit the moved bodies.
+   *
+   * The plan is kept if the numbers of targets and sources are unchanged and
+   * every body is within (1+slack) times the radius of its leaf box from the
+   * box center. Bodies are matched to the tree by position in the arrays.
+   *
+   * @returns true if the plan was kept, false if it will be rebuilt
+   */
+  template <class TA2, class SA2>
+  bool reposition(const TA2& targets, const SA2& sources, double slack = 0) {
+    targets_.assign(targets.begin(), targets.end());
+    sources_.assign(sources.begin(), sources.end());
+    if (plan != nullptr && plan->update(slack))
+      return true;
+    destroy_plan();
+    return false;
+  }
+
+  /** @brief Returns the bytes held by the trees, permuted bodies and
+   * expansions of the matrix-vector product plan, or 0 if there is none yet */
+  inline std::size_t plan_memory() const {
+    return plan == nullptr ? 0 : plan->memory();
+  }
+
   /** @brief Set options to be passed on to the matrix-vector product plan */
   inline void set_options(const FMMOptions& opts) {
     destroy_plan();
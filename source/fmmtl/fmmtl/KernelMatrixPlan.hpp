@@ -20,6 +20,15 @@ class PlanBase {
   virtual void execute(const std::vector<charge_type>& charges,
                        std::vector<result_type>& results) = 0;
 
+  /** Keep this plan for the moved bodies of its kernel matrix, if each is
+   * within (1+slack) times the radius of its leaf box.
+   * @returns false if the plan must be rebuilt instead */
+  virtual bool update(double slack) = 0;
+
+  /** The number of bytes held by the trees, permuted bodies and expansions
+   * of this plan */
+  virtual std::size_t memory() const = 0;
+
   /** Accessors */
 
   /** The potentially reordered targets for this plan */
@@ -54,6 +63,17 @@ struct Plan
     context.execute(charges, results, executor);
   }
 
+  virtual bool update(double slack) {
+    if (!context.update(slack))
+      return false;
+    executor->update(context);
+    return true;
+  }
+
+  virtual std::size_t memory() const {
+    return context.memory();
+  }
+
   virtual std::vector<target_type> targets() const {
     return std::vector<target_type>(context.target_begin(),
                                     context.target_end());
@@ -80,3 +80,10 @@ typedef int omp_int_t;
 inline omp_int_t omp_get_thread_num() { return 0;}
 inline omp_int_t omp_get_max_threads() { return 1;}
 #endif
+
+// FMMTL_TASK_CUTOFF
+// Boxes with fewer bodies than this are processed inline by the task-parallel
+// tree passes instead of being spawned as a separate OpenMP task
+#if !defined(FMMTL_TASK_CUTOFF)
+#  define FMMTL_TASK_CUTOFF 256
+#endif
@@ -91,6 +91,23 @@ class SingleTreeContext<NDTree<DIM> > {
                      opts.ncrit) {
   }
 
+  /** True if the tree still holds the bodies of @a mat after they moved:
+   * the sources are still the targets, their number is unchanged and each is
+   * within (1+@a slack) times the radius of its leaf box.
+   */
+  template <typename KernelMatrix>
+  bool encloses(const KernelMatrix& mat, double slack) const {
+    return mat.sources().size() == source_tree_.bodies() &&
+        mat.sources() == mat.targets() &&
+        source_tree_.encloses(
+            (mat.sources() | transformed(S2P(mat.expansion()))).begin(), slack);
+  }
+
+  /** The number of bytes held by the tree */
+  std::size_t memory() const {
+    return source_tree_.memory();
+  }
+
   // Tree accessors
   inline source_tree_type& source_tree() {
     return source_tree_;
@@ -174,6 +191,25 @@ class DualTreeContext<NDTree<SOURCEDIM>,
                      opts.ncrit) {
   }
 
+  /** True if the trees still hold the bodies of @a mat after they moved:
+   * the numbers of sources and targets are unchanged and each body is within
+   * (1+@a slack) times the radius of its leaf box.
+   */
+  template <typename KernelMatrix>
+  bool encloses(const KernelMatrix& mat, double slack) const {
+    return mat.sources().size() == source_tree_.bodies() &&
+        mat.targets().size() == target_tree_.bodies() &&
+        source_tree_.encloses(
+            (mat.sources() | transformed(S2P(mat.expansion()))).begin(), slack) &&
+        target_tree_.encloses(
+            (mat.targets() | transformed(T2P(mat.expansion()))).begin(), slack);
+  }
+
+  /** The number of bytes held by the trees */
+  std::size_t memory() const {
+    return source_tree_.memory() + target_tree_.memory();
+  }
+
   inline source_tree_type& source_tree() {
     return source_tree_;
   }
@@ -224,6 +260,16 @@ class DataContext
   typedef std::vector<local_type> local_container;
   local_container L_;
 
+  //! The bytes of an expansion, with the storage of std::vector expansions
+  template <typename E>
+  static std::size_t expansion_memory(const E&) {
+    return sizeof(E);
+  }
+  template <typename T, typename A>
+  static std::size_t expansion_memory(const std::vector<T,A>& E) {
+    return sizeof(E) + E.capacity() * sizeof(T);
+  }
+
  public:
   template <class Options>
   DataContext(const kernel_matrix_type& mat, Options& opts)
@@ -240,6 +286,40 @@ class DataContext
         L_(this->target_tree().boxes()) {
   }
 
+  /** Re-permute the moved sources and targets of the kernel matrix into the
+   * existing trees, if the trees still enclose them.
+   *
+   * @returns false if the bodies moved too far (or were added or removed)
+   *          for the trees, which are then left unchanged.
+   */
+  bool update(double slack) {
+    FMMTL_LOG("Refit");
+    if (!this->encloses(mat_, slack))
+      return false;
+    sources_.assign(this->source_permute_begin(mat_.sources().begin()),
+                    this->source_permute_end(  mat_.sources().begin()));
+    targets_.assign(this->target_permute_begin(mat_.targets().begin()),
+                    this->target_permute_end(  mat_.targets().begin()));
+    return true;
+  }
+
+  /** The number of bytes held by this context: the trees, the permuted
+   * bodies, charges and results, and the multipole and local expansions.
+   * Excludes the interaction lists of the evaluators.
+   */
+  std::size_t memory() const {
+    std::size_t bytes = TreeContext::memory() +
+        sources_.capacity() * sizeof(source_type) +
+        targets_.capacity() * sizeof(target_type) +
+        charges_.capacity() * sizeof(charge_type) +
+        results_.capacity() * sizeof(result_type);
+    for (const multipole_type& M : M_)
+      bytes += expansion_memory(M);
+    for (const local_type& L : L_)
+      bytes += expansion_memory(L);
+    return bytes;
+  }
+
   template <typename Executor>
   inline void execute(const std::vector<charge_type>& charges,
                       std::vector<result_type>& results,
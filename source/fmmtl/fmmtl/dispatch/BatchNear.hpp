@@ -14,6 +14,9 @@ class BatchNear {
   typedef typename Context::kernel_type kernel_type;
   //! Kernel value type
   typedef typename Context::kernel_value_type kernel_value_type;
+  //! Charge and result types
+  typedef typename Context::charge_type charge_type;
+  typedef typename Context::result_type result_type;
 
   //! Type of box
   typedef typename Context::source_box_type source_box_type;
@@ -27,7 +30,7 @@ class BatchNear {
   //typedef std::pair<source_box_type, target_box_type> box_pair;
   //std::vector<box_pair> p2p_list;
 
-  // For now, only use for GPU...
+  //! Compressed (CSR) near-field blocks, built on first use
   S2T_Compressed<kernel_type>* p2p_compressed;
 
  public:
@@ -53,25 +56,53 @@ class BatchNear {
     //p2p_list.push_back(std::make_pair(s,t));
   }
 
+  /** Discard the compressed near-field blocks, which hold copies of the
+   * sources and targets, so they are rebuilt from the interaction list on
+   * next use */
+  void clear_compressed() {
+    delete p2p_compressed;
+    p2p_compressed = nullptr;
+  }
+
   /** Compute all interations in the interaction list */
   void execute(Context& c) {
     FMMTL_LOG("S2T Batch");
-#if defined(FMMTL_WITH_CUDA)        // XXX: Dispatch this
     if (p2p_compressed == nullptr)
       p2p_compressed =
           S2T_Compressed<kernel_type>::make(c, target_box_list, source_boxes, box_pair_count);
     p2p_compressed->execute(c);
-#else
-    auto t_end = target_box_list.end();
-#pragma omp parallel for
-    for (auto ti = target_box_list.begin(); ti < t_end; ++ti) {
-      target_box_type& tb = *ti;
-      auto s_end = source_boxes[tb.index()].end();
-      for (auto si = source_boxes[tb.index()].begin(); si != s_end; ++si) {
-        S2T::eval(c, *si, tb, S2T::ONE_SIDED());
-      }
+  }
+
+  /** Spawn OpenMP tasks computing all interactions in the interaction list.
+   * Each task owns a run of target boxes holding at least FMMTL_TASK_CUTOFF
+   * bodies, so tasks never write to the same results. Call from inside a
+   * parallel region; the work is complete at the next barrier or taskwait.
+   * Host only: the results are accumulated in place.
+   */
+  void spawn(Context& c) {
+    FMMTL_LOG("S2T Batch");
+    if (target_box_list.empty())
+      return;
+    if (p2p_compressed == nullptr)
+      p2p_compressed =
+          S2T_Compressed<kernel_type>::make(c, target_box_list, source_boxes, box_pair_count);
+
+    // The compressed representation has one target range per listed box
+    const kernel_type* K = &c.kernel();
+    const charge_type* charges = &*c.charge_begin();
+    result_type* results = &*c.result_begin();
+    const S2T_Compressed<kernel_type>* p2p = p2p_compressed;
+
+    unsigned k = 0;
+    const unsigned num_boxes = target_box_list.size();
+    while (k < num_boxes) {
+      unsigned k_first = k;
+      unsigned bodies = 0;
+      for ( ; k < num_boxes && bodies < FMMTL_TASK_CUTOFF; ++k)
+        bodies += target_box_list[k].num_bodies();
+#pragma omp task firstprivate(k_first, k, K, charges, results, p2p)
+      p2p->execute_blocks(*K, charges, results, k_first, k);
     }
-#endif
   }
 
   /*
@@ -6,6 +6,7 @@
 
 #include <iterator>
 #include <type_traits>
+#include <cstddef>
 
 #include "fmmtl/util/Logger.hpp"
 #include "fmmtl/meta/kernel_traits.hpp"
@@ -53,11 +54,26 @@ symm_eval(const Kernel& K,
   r2 += K.transpose(k12) * c1;
 }
 
+/** Asymmetric block P2P evaluation with the Kernel's vectorized S2T */
+template <typename Kernel,
+          typename SourceIter, typename ChargeIter,
+          typename TargetIter, typename ResultIter>
+inline
+typename std::enable_if<KernelTraits<Kernel>::has_vector_S2T_asymm>::type
+block_eval(const Kernel& K,
+           SourceIter s_first, SourceIter s_last, ChargeIter c_first,
+           TargetIter t_first, TargetIter t_last, ResultIter r_first)
+{
+  K.S2T(s_first, s_last, c_first,
+        t_first, t_last, r_first);
+}
+
 /** Asymmetric block P2P evaluation */
 template <typename Kernel,
           typename SourceIter, typename ChargeIter,
           typename TargetIter, typename ResultIter>
-inline void
+inline
+typename std::enable_if<!KernelTraits<Kernel>::has_vector_S2T_asymm>::type
 block_eval(const Kernel& K,
            SourceIter s_first, SourceIter s_last, ChargeIter c_first,
            TargetIter t_first, TargetIter t_last, ResultIter r_first)
@@ -78,11 +94,30 @@ block_eval(const Kernel& K,
   }
 }
 
+/** Symmetric off-diagonal block P2P evaluation
+ * with the Kernel's vectorized S2T */
+template <typename Kernel,
+          typename SourceIter, typename ChargeIter,
+          typename TargetIter, typename ResultIter>
+inline
+typename std::enable_if<KernelTraits<Kernel>::has_vector_S2T_symm>::type
+block_eval(const Kernel& K,
+           SourceIter p1_first, SourceIter p1_last,
+           ChargeIter c1_first, ResultIter r1_first,
+           TargetIter p2_first, TargetIter p2_last,
+           ChargeIter c2_first, ResultIter r2_first)
+{
+  K.S2T(p2_first, p2_last, c2_first,
+        p1_first, p1_last, c1_first,
+        r1_first, r2_first);
+}
+
 /** Symmetric off-diagonal block P2P evaluation */
 template <typename Kernel,
           typename SourceIter, typename ChargeIter,
           typename TargetIter, typename ResultIter>
-inline void
+inline
+typename std::enable_if<!KernelTraits<Kernel>::has_vector_S2T_symm>::type
 block_eval(const Kernel& K,
            SourceIter p1_first, SourceIter p1_last,
            ChargeIter c1_first, ResultIter r1_first,
@@ -112,10 +147,45 @@ block_eval(const Kernel& K,
   }
 }
 
+/** Symmetric diagonal block P2P evaluation
+ * with the Kernel's vectorized S2T.
+ * Halves the block until it fits a single P2P block so the off-diagonal
+ * halves are evaluated once for both directions.
+ */
+template <typename Kernel,
+          typename SourceIter, typename ChargeIter, typename ResultIter>
+inline static
+typename std::enable_if<KernelTraits<Kernel>::has_vector_S2T_asymm &&
+                        KernelTraits<Kernel>::has_vector_S2T_symm>::type
+block_eval(const Kernel& K,
+           SourceIter p_first, SourceIter p_last,
+           ChargeIter c_first, ResultIter r_first)
+{
+  const std::size_t n = std::distance(p_first, p_last);
+  if (n <= P2P_BLOCK_SIZE) {
+    K.S2T(p_first, p_last, c_first,
+          p_first, p_last, r_first);
+    return;
+  }
+
+  const std::size_t half = n / 2;
+  SourceIter p_mid = p_first; std::advance(p_mid, half);
+  ChargeIter c_mid = c_first; std::advance(c_mid, half);
+  ResultIter r_mid = r_first; std::advance(r_mid, half);
+
+  block_eval(K, p_first, p_mid, c_first, r_first);
+  block_eval(K, p_mid, p_last, c_mid, r_mid);
+  K.S2T(p_mid, p_last, c_mid,
+        p_first, p_mid, c_first,
+        r_first, r_mid);
+}
+
 /** Symmetric diagonal block P2P evaluation */
 template <typename Kernel,
           typename SourceIter, typename ChargeIter, typename ResultIter>
-inline static void
+inline static
+typename std::enable_if<!(KernelTraits<Kernel>::has_vector_S2T_asymm &&
+                          KernelTraits<Kernel>::has_vector_S2T_symm)>::type
 block_eval(const Kernel& K,
            SourceIter p_first, SourceIter p_last,
            ChargeIter c_first, ResultIter r_first)
@@ -1,41 +1,139 @@
 #pragma once
 
-#include <iostream>
+#include <algorithm>
 
+#include "fmmtl/config.hpp"
+
+#include "fmmtl/dispatch/S2T.hpp"
 #include "fmmtl/dispatch/S2T/S2T_Compressed.hpp"
 
+namespace fmmtl {
+namespace detail {
+
+/** Sizes of the host copies of the compressed representation */
+struct S2T_Compressed_Data {
+  unsigned num_sources;
+  unsigned num_targets;
+  unsigned num_blocks;
+  S2T_Compressed_Data(unsigned s, unsigned t, unsigned b)
+      : num_sources(s),
+        num_targets(t),
+        num_blocks(b) {
+  }
+};
+
+template <typename Container>
+inline typename Container::value_type* host_copy(const Container& c) {
+  typedef typename Container::value_type c_value;
+  c_value* p = new c_value[c.size()];
+  std::copy(c.begin(), c.end(), p);
+  return p;
+}
+
+} // end namespace detail
+} // end namespace fmmtl
+
+
 template <typename Kernel>
-S2T_Compressed<Kernel>::S2T_Compressed() {
+S2T_Compressed<Kernel>::S2T_Compressed()
+    : data_(0),
+      target_ranges_(0),
+      source_range_ptrs_(0),
+      source_ranges_(0),
+      sources_(0),
+      targets_(0) {
 }
 
 template <typename Kernel>
 S2T_Compressed<Kernel>::S2T_Compressed(
-    std::vector<std::pair<unsigned,unsigned> >&,
-    std::vector<unsigned>&,
-    std::vector<std::pair<unsigned,unsigned> >&,
-    const std::vector<source_type>&,
-    const std::vector<target_type>&) {
+    std::vector<std::pair<unsigned,unsigned> >& target_ranges,
+    std::vector<unsigned>& source_range_ptrs,
+    std::vector<std::pair<unsigned,unsigned> >& source_ranges,
+    const std::vector<source_type>& sources,
+    const std::vector<target_type>& targets)
+    : data_(new fmmtl::detail::S2T_Compressed_Data(sources.size(),
+                                                   targets.size(),
+                                                   target_ranges.size())),
+      target_ranges_(fmmtl::detail::host_copy(target_ranges)),
+      source_range_ptrs_(fmmtl::detail::host_copy(source_range_ptrs)),
+      source_ranges_(fmmtl::detail::host_copy(source_ranges)),
+      sources_(fmmtl::detail::host_copy(sources)),
+      targets_(fmmtl::detail::host_copy(targets)) {
 }
 
 template <typename Kernel>
 S2T_Compressed<Kernel>::~S2T_Compressed() {
-  // TODO: delete
+  delete reinterpret_cast<fmmtl::detail::S2T_Compressed_Data*>(data_);
+  delete[] target_ranges_;
+  delete[] source_range_ptrs_;
+  delete[] source_ranges_;
+  delete[] sources_;
+  delete[] targets_;
+}
+
+template <typename Kernel>
+void S2T_Compressed<Kernel>::execute_blocks(
+    const Kernel& K,
+    const charge_type* charges,
+    result_type* results,
+    unsigned block_first, unsigned block_last) const {
+  for (unsigned k = block_first; k < block_last; ++k) {
+    const std::pair<unsigned,unsigned>& t_range = target_ranges_[k];
+
+    // For each source range interacting with this target range
+    for (unsigned p = source_range_ptrs_[k]; p < source_range_ptrs_[k+1]; ++p) {
+      const std::pair<unsigned,unsigned>& s_range = source_ranges_[p];
+      fmmtl::detail::block_eval(K,
+                                sources_ + s_range.first,
+                                sources_ + s_range.second,
+                                charges + s_range.first,
+                                targets_ + t_range.first,
+                                targets_ + t_range.second,
+                                results + t_range.first);
+    }
+  }
 }
 
 template <typename Kernel>
 void S2T_Compressed<Kernel>::execute(
-    const Kernel&,
-    const std::vector<charge_type>&,
-    std::vector<result_type>&) {
-  std::cerr << "ERROR: Calling unimplemented S2T_compressed CPU" << std::endl;
+    const Kernel& K,
+    const std::vector<charge_type>& charges,
+    std::vector<result_type>& results) {
+  fmmtl::detail::S2T_Compressed_Data* data =
+      reinterpret_cast<fmmtl::detail::S2T_Compressed_Data*>(data_);
+  if (data == 0 || data->num_blocks == 0)
+    return;
+
+  FMMTL_ASSERT(charges.size() == data->num_sources);
+  FMMTL_ASSERT(results.size() == data->num_targets);
+
+  // Target ranges are disjoint, so each can be processed independently.
+  // Their costs vary with the number of neighbours, so balance dynamically.
+  const int num_blocks = data->num_blocks;
+#pragma omp parallel for schedule(dynamic)
+  for (int k = 0; k < num_blocks; ++k)
+    execute_blocks(K, &charges[0], &results[0], k, k+1);
 }
 
 template <typename Kernel>
 void S2T_Compressed<Kernel>::execute(
-    const Kernel&,
-    const std::vector<source_type>&,
-    const std::vector<charge_type>&,
-    const std::vector<target_type>&,
-    std::vector<result_type>&) {
-  std::cerr << "ERROR: Calling unimplemented S2T_compressed CPU" << std::endl;
+    const Kernel& K,
+    const std::vector<source_type>& s,
+    const std::vector<charge_type>& c,
+    const std::vector<target_type>& t,
+    std::vector<result_type>& r) {
+  if (s.empty() || t.empty())
+    return;
+
+  // Dense evaluation in blocks of targets against all sources
+  const int num_blocks = (t.size() + P2P_BLOCK_SIZE - 1) / P2P_BLOCK_SIZE;
+#pragma omp parallel for schedule(dynamic)
+  for (int k = 0; k < num_blocks; ++k) {
+    unsigned t_first = k * P2P_BLOCK_SIZE;
+    unsigned t_last  = std::min<unsigned>(t_first + P2P_BLOCK_SIZE, t.size());
+    fmmtl::detail::block_eval(K,
+                              &s[0], &s[0] + s.size(), &c[0],
+                              &t[0] + t_first, &t[0] + t_last,
+                              &r[0] + t_first);
+  }
 }
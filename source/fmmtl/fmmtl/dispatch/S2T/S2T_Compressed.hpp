@@ -1,5 +1,5 @@
 #pragma once
-/** @brief Header file for the GPU_S2T class.
+/** @brief Header file for the S2T_Compressed class.
  *
  * Note: This header file may be compiled with nvcc and must use C++03.
  */
@@ -68,6 +68,17 @@ class S2T_Compressed {
                       const std::vector<target_type>& t,
                       std::vector<result_type>& r);
 
+  /** Evaluate the target ranges [block_first, block_last) only, serially.
+   * Host implementation only: used to split the evaluation into tasks.
+   *
+   * @param[in]     charges  The charges of all sources
+   * @param[in,out] results  The results of all targets to accumulate into
+   */
+  void execute_blocks(const Kernel& K,
+                      const charge_type* charges,
+                      result_type* results,
+                      unsigned block_first, unsigned block_last) const;
+
   /** Construct a S2T_Compressed object by taking
    * associated source ranges and target ranges and constructing a compressed
    * representation.
@@ -157,8 +168,8 @@ class S2T_Compressed {
   static
   S2T_Compressed<typename Context::kernel_type>*
   make(Context& c,
-       const std::vector<typename Context::target_box_type> t_boxes,
-       const std::vector<std::vector<typename Context::source_box_type> > s_boxes,
+       const std::vector<typename Context::target_box_type>& t_boxes,
+       const std::vector<std::vector<typename Context::source_box_type> >& s_boxes,
        int num_box_pairs) {
     typedef typename Context::target_box_type target_box_type;
     typedef typename Context::source_box_type source_box_type;
@@ -82,20 +82,39 @@ class EvalLists
   }
 
   void execute(Context& c) {
+    // Initialize all the multipoles and locals (not all may be needed)
+    auto s_end = c.source_tree().box_end();
+#pragma omp parallel for
+    for (auto bi = c.source_tree().box_begin(); bi < s_end; ++bi)
+      INITM::eval(c, *bi);
+    auto t_end = c.target_tree().box_end();
+#pragma omp parallel for
+    for (auto bi = c.target_tree().box_begin(); bi < t_end; ++bi)
+      INITL::eval(c, *bi);
+
+#if defined(FMMTL_WITH_CUDA)
     // Launch the p2p early (potentially asynchronously?)
     near_batch_.execute(c);
-
-    // Initialize all the multipoles and locals (not all may be needed)
-    for (auto&& sbox : boxes(c.source_tree()))
-      INITM::eval(c, sbox);
-    for (auto&& tbox : boxes(c.target_tree()))
-      INITL::eval(c, tbox);
-
-    // Perform the upward pass (not all may be needed)
-    // TODO: Use far_field batch to only initialize and compute used multipoles
-    if (ExpansionTraits<typename Context::expansion_type>::has_S2M) {
-      UpDispatch up(c);
-      UpwardPass::eval(c.source_tree(), up);
+#endif
+
+    // The upward pass only writes multipoles and the p2p only writes results,
+    // so run them as concurrent tasks. The upward pass is spawned first as it
+    // is on the critical path to the far field.
+#pragma omp parallel
+#pragma omp single
+    {
+      // Perform the upward pass (not all may be needed)
+      // TODO: Use far_field batch to only initialize and compute used multipoles
+      if (ExpansionTraits<typename Context::expansion_type>::has_S2M) {
+#pragma omp task shared(c)
+        {
+          UpDispatch up(c);
+          UpwardPass::eval_tasks(c.source_tree().root(), up);
+        }
+      }
+#if !defined(FMMTL_WITH_CUDA)
+      near_batch_.spawn(c);
+#endif
     }
 
     // Perform the source-target box interactions
@@ -108,6 +127,11 @@ class EvalLists
       DownwardPass::eval(c.target_tree(), down);
     }
   }
+
+  void update(Context&) {
+    // The interaction lists only refer to boxes and stay valid
+    near_batch_.clear_compressed();
+  }
 };
 
 
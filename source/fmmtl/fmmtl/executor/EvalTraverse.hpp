@@ -26,10 +26,12 @@ class EvalTraverse
   void execute(Context& c) {
     // Initialize all the multipoles and locals (not all may be needed)
     auto s_end = c.source_tree().box_end();
-    for (auto bi = c.source_tree().box_begin(); bi != s_end; ++bi)
+#pragma omp parallel for
+    for (auto bi = c.source_tree().box_begin(); bi < s_end; ++bi)
       INITM::eval(c, *bi);
     auto t_end = c.target_tree().box_end();
-    for (auto bi = c.target_tree().box_begin(); bi != t_end; ++bi)
+#pragma omp parallel for
+    for (auto bi = c.target_tree().box_begin(); bi < t_end; ++bi)
       INITL::eval(c, *bi);
 
     // Perform the upward pass (not all may be needed)
@@ -47,6 +49,8 @@ class EvalTraverse
     UpwardPass::eval(c.source_tree(), up_dispatch);
 
     // Perform the source-target box interactions
+    // The traversal stays serial: the M2L and S2T calls for different source
+    // boxes accumulate into the same target locals and results
     auto far_dispatch = [&c](const source_box& s, const target_box& t) {
       if (MAC::eval(c,s,t)) {
         M2L::eval(c,s,t);
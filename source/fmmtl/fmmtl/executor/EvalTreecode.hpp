@@ -0,0 +1,116 @@
+#pragma once
+
+#include "fmmtl/executor/Evaluator.hpp"
+
+#include "fmmtl/traversal/Upward.hpp"
+#include "fmmtl/traversal/DualTraversal.hpp"
+
+#include "fmmtl/dispatch/Dispatchers.hpp"
+#include "fmmtl/tree/TreeRange.hpp"
+#include "fmmtl/meta/kernel_traits.hpp"
+
+
+/** Treecode evaluator: the multipoles of the source tree are evaluated
+ * directly at the targets (M2T), without local expansions.
+ *
+ * Each target leaf box is traversed against the source tree on its own, so
+ * its far-field list only writes to the results of its own targets and the
+ * leaves are evaluated in parallel. The near field is batched as in EvalLists.
+ */
+template <class Context>
+class EvalTreecode
+    : public EvaluatorBase<Context>
+{
+  typedef typename Context::source_box_type source_box;
+  typedef typename Context::target_box_type target_box;
+
+  //! The leaf boxes of the target tree
+  std::vector<target_box> leaves_;
+  //! The source boxes evaluated by M2T at the targets of each leaf
+  std::vector<std::vector<source_box> > far_boxes_;
+
+  BatchNear<Context> near_batch_;
+
+  struct UpDispatch {
+    Context& c_;
+    UpDispatch(Context& c) : c_(c) {}
+
+    inline void operator()(const source_box& box) {
+      if (box.is_leaf()) {
+        // If leaf, make S2M calls
+        S2M::eval(c_, box);
+      } else {
+        // If not leaf, then for all the children M2M
+        for (auto&& cbox : children(box))
+          M2M::eval(c_, cbox, box);
+      }
+    }
+  };
+
+ public:
+
+  EvalTreecode(Context& c) {
+    auto t_end = c.target_tree().box_end();
+    for (auto bi = c.target_tree().box_begin(); bi != t_end; ++bi)
+      if ((*bi).is_leaf())
+        leaves_.push_back(*bi);
+    far_boxes_.resize(leaves_.size());
+
+    // Determine the box interactions of each target leaf
+    for (unsigned k = 0; k < leaves_.size(); ++k) {
+      std::vector<source_box>& far_list = far_boxes_[k];
+      auto far_batcher = [&c,&far_list](const source_box& s, const target_box& t) {
+        if (MAC::eval(c,s,t)) {
+          far_list.push_back(s);
+          return true;
+        }
+        return false;
+      };
+      auto near_batcher = [this](const source_box& s, const target_box& t) {
+        near_batch_.insert(s,t);
+      };
+      fmmtl::traverse_nearfar(c.source_tree().root(), leaves_[k],
+                              near_batcher, far_batcher);
+    }
+  }
+
+  void execute(Context& c) {
+    // Initialize all the multipoles
+    auto s_end = c.source_tree().box_end();
+#pragma omp parallel for
+    for (auto bi = c.source_tree().box_begin(); bi < s_end; ++bi)
+      INITM::eval(c, *bi);
+
+    // The upward pass only writes multipoles and the p2p only writes results,
+    // so run them as concurrent tasks
+#pragma omp parallel
+#pragma omp single
+    {
+#pragma omp task shared(c)
+      {
+        UpDispatch up(c);
+        UpwardPass::eval_tasks(c.source_tree().root(), up);
+      }
+      near_batch_.spawn(c);
+    }
+
+    // Evaluate the multipoles at the targets of each leaf. The leaves hold
+    // disjoint targets, and their costs vary with the length of their lists.
+    const int num_leaves = leaves_.size();
+#pragma omp parallel for schedule(dynamic)
+    for (int k = 0; k < num_leaves; ++k)
+      for (const source_box& s : far_boxes_[k])
+        M2T::eval(c, s, leaves_[k]);
+  }
+
+  void update(Context&) {
+    // The interaction lists only refer to boxes and stay valid
+    near_batch_.clear_compressed();
+  }
+};
+
+
+template <class Context, class Options>
+EvaluatorBase<Context>* make_eval_treecode(Context& c, Options&) {
+  return new EvalTreecode<Context>(c);
+}
@@ -7,6 +7,9 @@ template <typename Context>
 struct EvaluatorBase {
   virtual ~EvaluatorBase() {};
   virtual void execute(Context&) = 0;
+  /** Called after the bodies of the context moved within its trees.
+   * Evaluators holding copies of body data refresh them here. */
+  virtual void update(Context&) {};
 };
 
 
@@ -34,4 +37,9 @@ class EvaluatorCollection
     for (auto eval : evals_)
       eval->execute(context);
   }
+
+  void update(context_type& context) {
+    for (auto eval : evals_)
+      eval->update(context);
+  }
 };
@@ -2,7 +2,9 @@
 
 #include "fmmtl/executor/EvalLists.hpp"
 #include "fmmtl/executor/EvalTraverse.hpp"
+#include "fmmtl/executor/EvalTreecode.hpp"
 
+#include "fmmtl/FMMOptions.hpp"
 #include "fmmtl/meta/kernel_traits.hpp"
 
 template <typename Context, typename Options>
@@ -12,6 +14,9 @@ EvaluatorBase<Context>* make_evaluator(Context& c, Options& opts) {
   // Dynamically from the Options input
 
   // For now
+  if (opts.evaluator == FMMOptions::TREECODE &&
+      ExpansionTraits<typename Context::expansion_type>::has_M2T)
+    return make_eval_treecode(c, opts);
   if (ExpansionTraits<typename Context::expansion_type>::has_dynamic_MAC)
     return make_eval_traverse(c, opts);
   else
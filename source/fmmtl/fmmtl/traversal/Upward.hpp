@@ -1,31 +1,57 @@
 #pragma once
 
+#include "fmmtl/config.hpp"
 #include "fmmtl/dispatch/Dispatchers.hpp"
 
 
 /** @brief Process the boxes from bottom to top
  * concept Tree {
- *   unsigned levels();                       // Levels in the tree, root:0
- *   box_iterator box_begin(unsigned level);  // Iterator range to boxes of level
- *   box_iterator box_end(unsigned level);
+ *   box_type root();                         // The root box of the tree
+ * }
+ * concept Box {
+ *   bool is_leaf();                          // True if the box has no children
+ *   box_iterator child_begin();              // Iterator range to children
+ *   box_iterator child_end();
+ *   unsigned num_bodies();                   // Number of bodies in the box
  * }
  * concept Evaluator {
  *   void operator()(typename Tree::box_type& b);   // Process box b
  * }
+ *
+ * A box may only be processed once all of its children have been, so the
+ * subtrees are processed as OpenMP tasks and each box waits for its own
+ * children rather than for the whole level below it.
  */
 struct UpwardPass {
   template <typename Tree, class Evaluator>
-	inline static void eval(Tree& tree, Evaluator& eval) {
-		// For the lowest level up to the highest level
-		for (int l = tree.levels()-1; l >= 0; --l) {
-			// For all boxes at this level
-			auto b_end = tree.box_end(l);
-      for (auto bit = tree.box_begin(l); bit != b_end; ++bit) {
-        auto box = *bit;
-        eval(box);
-			}
-		}
-	}
+  inline static void eval(Tree& tree, Evaluator& eval) {
+#pragma omp parallel
+#pragma omp single
+    eval_tasks(tree.root(), eval);
+  }
+
+  /** Process box and its subtree, spawning a task for each large child.
+   * May be called from inside an existing parallel region to overlap the
+   * pass with other tasks. Returns once the whole subtree is processed.
+   */
+  template <typename Box, class Evaluator>
+  static void eval_tasks(const Box& box, Evaluator& eval) {
+    if (!box.is_leaf()) {
+      auto c_end = box.child_end();
+      for (auto cit = box.child_begin(); cit != c_end; ++cit) {
+        Box cbox = *cit;
+        if (cbox.num_bodies() < FMMTL_TASK_CUTOFF) {
+          eval_tasks(cbox, eval);
+        } else {
+#pragma omp task firstprivate(cbox) shared(eval)
+          eval_tasks(cbox, eval);
+        }
+      }
+#pragma omp taskwait
+    }
+    Box b = box;
+    eval(b);
+  }
 };
 
 /** Helper for computing the multipole for a box and all sub-boxes
@@ -316,6 +316,14 @@ class NDTree {
     return box_data_.size();
   }
 
+  /** The number of bytes held by the arrays of this tree */
+  std::size_t memory() const {
+    return mc_.capacity()           * sizeof(code_type) +
+           permute_.capacity()      * sizeof(size_type) +
+           box_data_.capacity()     * sizeof(BoxData) +
+           level_offset_.capacity() * sizeof(size_type);
+  }
+
   /** The number of boxes contained in level L of this tree */
   size_type boxes(size_type L) const {
     return level_offset_[L+1] - level_offset_[L];
@@ -406,6 +414,33 @@ class NDTree {
     return body_permute(it, body_begin());
   }
 
+  /** Returns true if every body, moved to points[body.number()], is within
+   * (1+@a slack) times the radius of its leaf box from the center of that box.
+   *
+   * A body within this distance of its leaf is within (1+@a slack/2) times the
+   * radius of every ancestor box, so the boxes, expansion centers and
+   * interaction lists of this tree remain usable for the moved bodies, with
+   * the box radii of the multipole acceptance criteria grown by (1+@a slack).
+   *
+   * @pre [points, points + size()) is a valid range
+   */
+  template <typename RandomAccessIter>
+  bool encloses(RandomAccessIter points, double slack = 0) const {
+    const double scale_sq = (1 + slack) * (1 + slack);
+    for (size_type k = 0; k < box_data_.size(); ++k) {
+      const BoxData& data = box_data_[k];
+      if (!data.is_leaf())
+        continue;
+      const double r_sq = scale_sq * box(k).radius_sq();
+      for (size_type i = data.body_begin_; i < data.body_end_; ++i) {
+        const point_type p = *(points + permute_[i]);
+        if (norm_2_sq(p - data.center_) > r_sq)
+          return false;
+      }
+    }
+    return true;
+  }
+
   /** Write an NDTree to an output stream */
   friend std::ostream& operator<<(std::ostream& s,
                                   const tree_type& t) {
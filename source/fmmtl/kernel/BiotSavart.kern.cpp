@@ -6,6 +6,8 @@
 
 #include "fmmtl/numeric/Vec.hpp"
 
+#include "kernel/Util/BiotSavartP2P.hpp"
+
 struct BiotSavart
     : public fmmtl::Kernel<BiotSavart> {
   typedef Vec<3,double> source_type;
@@ -24,14 +26,19 @@ struct BiotSavart
     }
   };
 
+  /** Radial factor, K(t,s) * c = cross(s-t, c) * radial(|s-t|^2) */
+  FMMTL_INLINE
+  double radial(double R2) const {
+    double keep = (R2 >= 1e-20);           //   Exclude self interaction,
+    R2 += 1 - keep;                        //   without a branch or 1/0
+    return keep / (R2 * std::sqrt(R2));    //   1 / R^3
+  }
+
   FMMTL_INLINE
   kernel_value_type operator()(const target_type& t,
                                const source_type& s) const {
     Vec<3,double> dist = s - t;            //   Vector from target to source
-    double R2 = norm_2_sq(dist);              //   R^2
-    double invR2 = 1.0 / R2;               //   1 / R^2
-    if (R2 < 1e-20) invR2 = 0;             //   Exclude self interaction
-    dist *= invR2 * std::sqrt(invR2);
+    dist *= radial(norm_2_sq(dist));
     return kernel_value_type(dist);
   }
 
@@ -39,6 +46,33 @@ struct BiotSavart
   kernel_value_type transpose(const kernel_value_type& kts) const {
     return kernel_value_type(-kts.v);
   }
+
+  /** Vectorized asymmetric S2T
+   * r_i += sum_j K(t_i,s_j) * c_j
+   */
+  template <typename SourceIter, typename ChargeIter,
+            typename TargetIter, typename ResultIter>
+  void S2T(SourceIter s_first, SourceIter s_last, ChargeIter c_first,
+           TargetIter t_first, TargetIter t_last, ResultIter r_first) const {
+    fmmtl::detail::biot_savart_S2T(*this,
+                                   s_first, s_last, c_first,
+                                   t_first, t_last, r_first);
+  }
+
+  /** Vectorized symmetric S2T
+   * rt_i += sum_j K(t_i,s_j) * cs_j
+   * rs_j += sum_i K(s_j,t_i) * ct_i
+   */
+  template <typename SourceIter, typename ChargeIter,
+            typename TargetIter, typename ResultIter>
+  void S2T(SourceIter s_first, SourceIter s_last, ChargeIter cs_first,
+           TargetIter t_first, TargetIter t_last, ChargeIter ct_first,
+           ResultIter rt_first, ResultIter rs_first) const {
+    fmmtl::detail::biot_savart_S2T(*this,
+                                   s_first, s_last, cs_first,
+                                   t_first, t_last, ct_first,
+                                   rt_first, rs_first);
+  }
 };
 FMMTL_KERNEL_EXTRAS(BiotSavart);
 
@@ -66,12 +100,18 @@ struct RosenheadMoore
   FMMTL_INLINE
   RosenheadMoore(double _a = 1) : aSq(_a * _a) {}
 
+  /** Radial factor, K(t,s) * c = cross(s-t, c) * radial(|s-t|^2) */
+  FMMTL_INLINE
+  double radial(double r2) const {
+    double R2 = aSq + r2;                  //   Regularized R^2
+    return 1.0 / (R2 * std::sqrt(R2));
+  }
+
   FMMTL_INLINE
   kernel_value_type operator()(const target_type& t,
                                const source_type& s) const {
     Vec<3,double> dist = s - t;            //   Vector from target to source
-    double R2 = aSq + norm_2_sq(dist);
-    dist /= R2 * std::sqrt(R2);
+    dist *= radial(norm_2_sq(dist));
     return kernel_value_type(dist);
   }
 
@@ -79,8 +119,88 @@ struct RosenheadMoore
   kernel_value_type transpose(const kernel_value_type& kts) const {
     return kernel_value_type(-kts.v);
   }
+
+  /** Vectorized asymmetric S2T
+   * r_i += sum_j K(t_i,s_j) * c_j
+   */
+  template <typename SourceIter, typename ChargeIter,
+            typename TargetIter, typename ResultIter>
+  void S2T(SourceIter s_first, SourceIter s_last, ChargeIter c_first,
+           TargetIter t_first, TargetIter t_last, ResultIter r_first) const {
+    fmmtl::detail::biot_savart_S2T(*this,
+                                   s_first, s_last, c_first,
+                                   t_first, t_last, r_first);
+  }
+
+  /** Vectorized symmetric S2T
+   * rt_i += sum_j K(t_i,s_j) * cs_j
+   * rs_j += sum_i K(s_j,t_i) * ct_i
+   */
+  template <typename SourceIter, typename ChargeIter,
+            typename TargetIter, typename ResultIter>
+  void S2T(SourceIter s_first, SourceIter s_last, ChargeIter cs_first,
+           TargetIter t_first, TargetIter t_last, ChargeIter ct_first,
+           ResultIter rt_first, ResultIter rs_first) const {
+    fmmtl::detail::biot_savart_S2T(*this,
+                                   s_first, s_last, cs_first,
+                                   t_first, t_last, ct_first,
+                                   rt_first, rs_first);
+  }
 };
 FMMTL_KERNEL_EXTRAS(RosenheadMoore);
 
 
+/** The RosenheadMoore velocity and its gradient with respect to the target
+ * result = [u, du_0/dt, du_1/dt, du_2/dt] where u is the RosenheadMoore result
+ */
+struct RosenheadMooreGradient
+    : public fmmtl::Kernel<RosenheadMooreGradient> {
+  typedef Vec<3,double>  source_type;
+  typedef Vec<3,double>  target_type;
+  typedef Vec<3,double>  charge_type;
+  typedef Vec<12,double> result_type;
+
+  struct kernel_value_type {
+    Vec<3,double> d;    //   Vector from target to source
+    double f;           //   1 / R^3
+    double g;           //   3 / R^2
+    FMMTL_INLINE
+    kernel_value_type(const Vec<3,double>& _d, double _f, double _g)
+        : d(_d), f(_f), g(_g) {}
+
+    FMMTL_INLINE
+    result_type operator*(const charge_type& c) const {
+      const Vec<3,double> u = cross(d, c) * f;
+      result_type r;
+      r[0] = u[0];
+      r[1] = u[1];
+      r[2] = u[2];
+      // du_i/dt_j = [c]_x(i,j) / R^3 + 3 u_i d_j / R^2
+      for (unsigned i = 0; i < 3; ++i)
+        for (unsigned j = 0; j < 3; ++j)
+          r[3+3*i+j] = g * u[i] * d[j];
+      r[3+1] -= c[2] * f;  r[3+2] += c[1] * f;
+      r[3+3] += c[2] * f;  r[3+5] -= c[0] * f;
+      r[3+6] -= c[1] * f;  r[3+7] += c[0] * f;
+      return r;
+    }
+  };
+
+  double aSq;
+
+  FMMTL_INLINE
+  RosenheadMooreGradient(double _a = 1) : aSq(_a * _a) {}
+
+  FMMTL_INLINE
+  kernel_value_type operator()(const target_type& t,
+                               const source_type& s) const {
+    Vec<3,double> dist = s - t;            //   Vector from target to source
+    double R2 = aSq + norm_2_sq(dist);     //   Regularized R^2
+    double invR2 = 1.0 / R2;
+    return kernel_value_type(dist, invR2 * std::sqrt(invR2), 3 * invR2);
+  }
+};
+FMMTL_KERNEL_EXTRAS(RosenheadMooreGradient);
+
+
 #endif
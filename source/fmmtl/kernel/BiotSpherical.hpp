@@ -120,41 +120,13 @@ class BiotSpherical
    */
   void L2T(const local_type& L, const point_type& center,
            const target_type& target, result_type& result) const {
-    using std::real;
-    using std::imag;
-
-    real_type rho, theta, phi;
-    SphOp::cart2sph(rho, theta, phi, target - center);
-      if (theta == 0) theta += 1e-100;
-//    complex_type Z[P*(P+1)/2], dZ[P*(P+1)/2];
-    complex_type *  Z = (complex_type *)alloca(sizeof (complex_type) * (P*(P+1)/2));
-    complex_type * dZ = (complex_type *)alloca(sizeof (complex_type) * (P*(P+1)/2));
-    SphOp::evalZ(rho, theta, phi, P, Z, dZ);
-
-    Vec<3,Vec<3,real_type> > sph;
-    int nm = 0;
-    for (int n = 0; n != P; ++n) {
-      sph[0] += (real(L[nm])*real( Z[nm]) - imag(L[nm])*imag( Z[nm]))/rho * n;
-      sph[1] += real(L[nm])*real(dZ[nm]) - imag(L[nm])*imag(dZ[nm]);
-
-      ++nm;
-      for (int m = 1; m <= n; ++m, ++nm) {
-        Vec<3,complex_type> LZ = L[nm] * Z[nm];
-        sph[0]    += 2 * real(LZ) / rho * n;
-        sph[1]    += 2 * (real(L[nm])*real(dZ[nm])-imag(L[nm])*imag(dZ[nm]));
-        sph[2]    += 2 *-imag(LZ) * m;
-      }
-    }
-
-    // TODO: Optimize
-    point_type c0 = SphOp::sph2cart(rho, theta, phi,
-                                    Vec<3,real_type>(sph[0][0], sph[1][0], sph[2][0]));
-    point_type c1 = SphOp::sph2cart(rho, theta, phi,
-                                    Vec<3,real_type>(sph[0][1], sph[1][1], sph[2][1]));
-    point_type c2 = SphOp::sph2cart(rho, theta, phi,
-                                    Vec<3,real_type>(sph[0][2], sph[1][2], sph[2][2]));
-    result[0] += c2[1] - c1[2];
-    result[1] += c0[2] - c2[0];
-    result[2] += c1[0] - c0[1];
+    // Gradient of each component of the vector potential
+    Vec<3,real_type> grad[3];
+    SphOp::L2T_gradient(P, L, target - center, grad);
+
+    // The result is its curl
+    result[0] += grad[1][2] - grad[2][1];
+    result[1] += grad[2][0] - grad[0][2];
+    result[2] += grad[0][1] - grad[1][0];
   }
 };
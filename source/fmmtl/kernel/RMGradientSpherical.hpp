@@ -0,0 +1,13 @@
+#pragma once
+/** @file RMGradientSpherical.hpp
+ * @brief Implements the RosenheadMooreGradient kernel with spherical expansions.
+ *
+ * The expansions and their operators are those of RMSpherical. The L2T and
+ * M2T evaluate the curl of the vector potential and, from its Hessian, the
+ * gradient of the curl.
+ */
+
+#include "kernel/RMSpherical.hpp"
+
+//! Double precision expansions of the velocity and its gradient
+typedef RMSphericalExpansion<RosenheadMooreGradient,double> RMGradientSpherical;
@@ -4,6 +4,15 @@
  *
  * K(t,s) = 1 / |s-t|        // Laplace potential
  * K(t,s) = (s-t) / |s-t|^3  // Laplace force
+ *
+ * The expansions and their operators are computed in expansion_real:
+ * RMSpherical uses double throughout, while RMSphericalMixed keeps the
+ * multipole and local expansions in single precision. The near field is the
+ * double precision kernel in both, and L2T accumulates into double results.
+ *
+ * The same expansions serve the RosenheadMooreGradient kernel: its L2T and
+ * M2T also evaluate the gradient of the velocity from the Hessian of the
+ * vector potential (see RMGradientSpherical.hpp).
  */
 
 #include <cmath>
@@ -19,14 +28,23 @@
 #include "kernel/Util/SphericalMultipole3D.hpp"
 
 
-class RMSpherical
-    : public fmmtl::Expansion<RosenheadMoore, RMSpherical> {
+template <typename Kernel, typename expansion_real>
+class RMSphericalExpansion
+    : public fmmtl::Expansion<Kernel,
+                              RMSphericalExpansion<Kernel,expansion_real> > {
  public:
-  typedef double real_type;
+  typedef typename Kernel::source_type source_type;
+  typedef typename Kernel::target_type target_type;
+  typedef typename Kernel::charge_type charge_type;
+  typedef typename Kernel::result_type result_type;
+
+  typedef expansion_real real_type;
   typedef std::complex<real_type> complex_type;
 
-  //! Point type
-  typedef Vec<3,real_type> point_type;
+  //! Point type of the trees
+  typedef Vec<3,double> point_type;
+  //! Point type of the expansion operators
+  typedef Vec<3,real_type> expansion_point_type;
 
   //! Multipole expansion type
   typedef std::vector<Vec<3,complex_type> > multipole_type;
@@ -34,15 +52,16 @@ class RMSpherical
   typedef std::vector<Vec<3,complex_type> > local_type;
 
   //! Transform operators
-  typedef SphericalMultipole3D<point_type,multipole_type,local_type> SphOp;
+  typedef SphericalMultipole3D<expansion_point_type,
+                               multipole_type,local_type> SphOp;
 
   //! Expansion order
   int P;
 
   //! Constructor
-  RMSpherical(double a, int _P = 5)
-      : P(_P),
-        Expansion<RosenheadMoore, RMSpherical>(RosenheadMoore(a))
+  RMSphericalExpansion(double a, int _P = 5)
+      : fmmtl::Expansion<Kernel, RMSphericalExpansion>(Kernel(a)),
+        P(_P)
   {
   }
 
@@ -65,7 +84,8 @@ class RMSpherical
    */
   void S2M(const source_type& source, const charge_type& charge,
            const point_type& center, multipole_type& M) const {
-    return SphOp::S2M(P, center-source, charge, M);
+    return SphOp::S2M(P, expansion_point_type(center - source),
+                      Vec<3,real_type>(charge), M);
   }
 
   /** Kernel M2M operator
@@ -79,7 +99,7 @@ class RMSpherical
   void M2M(const multipole_type& Msource,
            multipole_type& Mtarget,
            const point_type& translation) const {
-    return SphOp::M2M(P, Msource, Mtarget, translation);
+    return SphOp::M2M(P, Msource, Mtarget, expansion_point_type(translation));
   }
 
   /** Kernel M2L operation
@@ -94,7 +114,7 @@ class RMSpherical
   void M2L(const multipole_type& Msource,
            local_type& Ltarget,
            const point_type& translation) const {
-    return SphOp::M2L(P, Msource, Ltarget, translation);
+    return SphOp::M2L(P, Msource, Ltarget, expansion_point_type(translation));
   }
 
   /** Kernel L2L operator
@@ -108,7 +128,7 @@ class RMSpherical
   void L2L(const local_type& Lsource,
            local_type& Ltarget,
            const point_type& translation) const {
-    return SphOp::L2L(P, Lsource, Ltarget, translation);
+    return SphOp::L2L(P, Lsource, Ltarget, expansion_point_type(translation));
   }
 
   /** Kernel L2T operation
@@ -122,42 +142,79 @@ class RMSpherical
    */
   void L2T(const local_type& L, const point_type& center,
            const target_type& target, result_type& result) const {
-    using std::real;
-    using std::imag;
-
-    real_type rho, theta, phi;
-    SphOp::cart2sph(rho, theta, phi, target - center);
-      if (theta == 0) theta += 1e-100;
-//    complex_type Z[P*(P+1)/2], dZ[P*(P+1)/2];
-    complex_type *  Z = (complex_type *)alloca(sizeof (complex_type) * (P*(P+1)/2));
-    complex_type * dZ = (complex_type *)alloca(sizeof (complex_type) * (P*(P+1)/2));
-    SphOp::evalZ(rho, theta, phi, P, Z, dZ);
-
-    Vec<3,Vec<3,real_type> > sph;
-    int nm = 0;
-    for (int n = 0; n != P; ++n) {
-      sph[0] += (real(L[nm])*real( Z[nm]) - imag(L[nm])*imag( Z[nm]))/rho * n;
-      sph[1] += real(L[nm])*real(dZ[nm]) - imag(L[nm])*imag(dZ[nm]);
-
-      ++nm;
-      for (int m = 1; m <= n; ++m, ++nm) {
-        Vec<3,complex_type> LZ = L[nm] * Z[nm];
-        sph[0]    += 2 * real(LZ) / rho * n;
-        sph[1]    += 2 * (real(L[nm])*real(dZ[nm])-imag(L[nm])*imag(dZ[nm]));
-        sph[2]    += 2 *-imag(LZ) * m;
-          
-      }
-    }
-
-    // TODO: Optimize
-    point_type c0 = SphOp::sph2cart(rho, theta, phi,
-                                    Vec<3,real_type>(sph[0][0], sph[1][0], sph[2][0]));
-    point_type c1 = SphOp::sph2cart(rho, theta, phi,
-                                    Vec<3,real_type>(sph[0][1], sph[1][1], sph[2][1]));
-    point_type c2 = SphOp::sph2cart(rho, theta, phi,
-                                    Vec<3,real_type>(sph[0][2], sph[1][2], sph[2][2]));
-    result[0] += c2[1] - c1[2];
-    result[1] += c0[2] - c2[0];
-    result[2] += c1[0] - c0[1];
+    L2T_field(L, expansion_point_type(target - center), result);
+  }
+
+  /** Kernel M2T operation, the far field of a treecode
+   * r += Op(M, t) where M is the multipole and r is the result
+   *
+   * @param[in] M The multpole expansion
+   * @param[in] center The center of the box with the multipole expansion
+   * @param[in] target The target to evaluate the multipole expansion at
+   * @param[in,out] result The target's corresponding result to accumulate
+   * @pre M includes the influence of all sources within its box
+   */
+  void M2T(const multipole_type& M, const point_type& center,
+           const target_type& target, result_type& result) const {
+    M2T_field(M, expansion_point_type(target - center), result);
+  }
+
+ private:
+  typedef Vec<3,real_type> gradient_type;
+
+  /** The velocity of the RosenheadMoore kernel, the curl of the vector
+   * potential whose gradient is L2T_gradient (M2T_gradient)
+   */
+  void L2T_field(const local_type& L, const expansion_point_type& x,
+                 Vec<3,double>& result) const {
+    gradient_type grad[3];
+    SphOp::L2T_gradient(P, L, x, grad);
+    add_curl(grad, result, 0, 1);
+  }
+  void M2T_field(const multipole_type& M, const expansion_point_type& x,
+                 Vec<3,double>& result) const {
+    gradient_type grad[3];
+    SphOp::M2T_gradient(P, M, x, grad);
+    add_curl(grad, result, 0, 1);
+  }
+
+  /** The velocity and its gradient of the RosenheadMooreGradient kernel,
+   * the curl of each column of the Hessian of the vector potential
+   */
+  void L2T_field(const local_type& L, const expansion_point_type& x,
+                 Vec<12,double>& result) const {
+    gradient_type grad[3], hess[9];
+    SphOp::L2T_gradient(P, L, x, grad);
+    SphOp::L2T_hessian(P, L, x, hess);
+    add_gradient_curl(grad, hess, result);
+  }
+  void M2T_field(const multipole_type& M, const expansion_point_type& x,
+                 Vec<12,double>& result) const {
+    gradient_type grad[3], hess[9];
+    SphOp::M2T_hessian(P, M, x, grad, hess);
+    add_gradient_curl(grad, hess, result);
+  }
+
+  /** result[i0 + stride*i] += (curl A)_i, where grad[d][c] = d/dx_d A_c */
+  template <typename R>
+  static void add_curl(const gradient_type* grad, R& result,
+                       unsigned i0, unsigned stride) {
+    result[i0 + 0*stride] += grad[1][2] - grad[2][1];
+    result[i0 + 1*stride] += grad[2][0] - grad[0][2];
+    result[i0 + 2*stride] += grad[0][1] - grad[1][0];
+  }
+
+  /** result = [u, du_i/dx_l] with u = curl A */
+  static void add_gradient_curl(const gradient_type* grad,
+                                const gradient_type* hess,
+                                Vec<12,double>& result) {
+    add_curl(grad, result, 0, 1);
+    for (unsigned l = 0; l < 3; ++l)
+      add_curl(hess + 3*l, result, 3+l, 3);
   }
 };
+
+//! Double precision expansions
+typedef RMSphericalExpansion<RosenheadMoore,double> RMSpherical;
+//! Single precision expansions with a double precision near field
+typedef RMSphericalExpansion<RosenheadMoore,float>  RMSphericalMixed;
@@ -0,0 +1,142 @@
+#pragma once
+/** @file BiotSavartP2P.hpp
+ * @brief Vectorized S2T for kernels of the Biot-Savart form
+ *
+ * K(t,s) * c = cross(s-t, c) * K.radial(|s-t|^2)
+ *
+ * Sources and their charges are copied in tiles to structure-of-arrays
+ * storage, so the loop over the sources of a tile has unit-stride loads and
+ * is evaluated SIMD-width pairs at a time. Kernels provide the radial
+ * factor as an inline member and forward their optional S2T methods here.
+ */
+
+#include <cmath>
+
+#if !defined(FMMTL_P2P_TILE_SIZE)
+#  define FMMTL_P2P_TILE_SIZE 128
+#endif
+
+namespace fmmtl {
+namespace detail {
+
+/** A tile of sources, charges and source results in structure-of-arrays */
+struct BiotSavartTile {
+  static const unsigned capacity = FMMTL_P2P_TILE_SIZE;
+
+  alignas(64) double x[capacity];
+  alignas(64) double y[capacity];
+  alignas(64) double z[capacity];
+  alignas(64) double cx[capacity];
+  alignas(64) double cy[capacity];
+  alignas(64) double cz[capacity];
+  alignas(64) double rx[capacity];
+  alignas(64) double ry[capacity];
+  alignas(64) double rz[capacity];
+
+  /** Load up to capacity sources and charges, advancing s and c.
+   * @returns The number of sources loaded
+   */
+  template <typename SourceIter, typename ChargeIter>
+  unsigned load(SourceIter& s, SourceIter s_last, ChargeIter& c) {
+    unsigned n = 0;
+    for ( ; n < capacity && s != s_last; ++n, ++s, ++c) {
+      x[n]  = (*s)[0];  y[n]  = (*s)[1];  z[n]  = (*s)[2];
+      cx[n] = (*c)[0];  cy[n] = (*c)[1];  cz[n] = (*c)[2];
+    }
+    return n;
+  }
+};
+
+/** Asymmetric S2T
+ * r_i += sum_j K(t_i,s_j) * c_j
+ */
+template <typename Kernel,
+          typename SourceIter, typename ChargeIter,
+          typename TargetIter, typename ResultIter>
+inline void
+biot_savart_S2T(const Kernel& K,
+                SourceIter s_first, SourceIter s_last, ChargeIter c_first,
+                TargetIter t_first, TargetIter t_last, ResultIter r_first) {
+  BiotSavartTile tile;
+
+  while (s_first != s_last) {
+    const unsigned n = tile.load(s_first, s_last, c_first);
+
+    ResultIter ri = r_first;
+    for (TargetIter ti = t_first; ti != t_last; ++ti, ++ri) {
+      const double tx = (*ti)[0], ty = (*ti)[1], tz = (*ti)[2];
+      double rx = 0, ry = 0, rz = 0;
+
+#pragma omp simd reduction(+:rx,ry,rz)
+      for (unsigned j = 0; j < n; ++j) {
+        const double dx = tile.x[j] - tx;
+        const double dy = tile.y[j] - ty;
+        const double dz = tile.z[j] - tz;
+        const double f  = K.radial(dx*dx + dy*dy + dz*dz);
+        rx += (dy*tile.cz[j] - dz*tile.cy[j]) * f;
+        ry += (dz*tile.cx[j] - dx*tile.cz[j]) * f;
+        rz += (dx*tile.cy[j] - dy*tile.cx[j]) * f;
+      }
+
+      (*ri)[0] += rx;
+      (*ri)[1] += ry;
+      (*ri)[2] += rz;
+    }
+  }
+}
+
+/** Symmetric S2T, using K(s,t) * c = -cross(s-t, c) * K.radial(|s-t|^2)
+ * rt_i += sum_j K(t_i,s_j) * cs_j
+ * rs_j += sum_i K(s_j,t_i) * ct_i
+ */
+template <typename Kernel,
+          typename SourceIter, typename ChargeIter,
+          typename TargetIter, typename ResultIter>
+inline void
+biot_savart_S2T(const Kernel& K,
+                SourceIter s_first, SourceIter s_last, ChargeIter cs_first,
+                TargetIter t_first, TargetIter t_last, ChargeIter ct_first,
+                ResultIter rt_first, ResultIter rs_first) {
+  BiotSavartTile tile;
+
+  while (s_first != s_last) {
+    const unsigned n = tile.load(s_first, s_last, cs_first);
+    for (unsigned j = 0; j < n; ++j)
+      tile.rx[j] = tile.ry[j] = tile.rz[j] = 0;
+
+    ChargeIter ci = ct_first;
+    ResultIter ri = rt_first;
+    for (TargetIter ti = t_first; ti != t_last; ++ti, ++ci, ++ri) {
+      const double tx = (*ti)[0], ty = (*ti)[1], tz = (*ti)[2];
+      const double cx = (*ci)[0], cy = (*ci)[1], cz = (*ci)[2];
+      double rx = 0, ry = 0, rz = 0;
+
+#pragma omp simd reduction(+:rx,ry,rz)
+      for (unsigned j = 0; j < n; ++j) {
+        const double dx = tile.x[j] - tx;
+        const double dy = tile.y[j] - ty;
+        const double dz = tile.z[j] - tz;
+        const double f  = K.radial(dx*dx + dy*dy + dz*dz);
+        rx += (dy*tile.cz[j] - dz*tile.cy[j]) * f;
+        ry += (dz*tile.cx[j] - dx*tile.cz[j]) * f;
+        rz += (dx*tile.cy[j] - dy*tile.cx[j]) * f;
+        tile.rx[j] -= (dy*cz - dz*cy) * f;
+        tile.ry[j] -= (dz*cx - dx*cz) * f;
+        tile.rz[j] -= (dx*cy - dy*cx) * f;
+      }
+
+      (*ri)[0] += rx;
+      (*ri)[1] += ry;
+      (*ri)[2] += rz;
+    }
+
+    for (unsigned j = 0; j < n; ++j, ++rs_first) {
+      (*rs_first)[0] += tile.rx[j];
+      (*rs_first)[1] += tile.ry[j];
+      (*rs_first)[2] += tile.rz[j];
+    }
+  }
+}
+
+} // end namespace detail
+} // end namespace fmmtl
@@ -1,7 +1,10 @@
 #pragma once
 
 #include <cmath>
+#include <vector>
+#include <algorithm>
 
+#include "fmmtl/numeric/Vec.hpp"
 #include "fmmtl/numeric/Complex.hpp"
 
 /** TODO: Documentation
@@ -27,68 +30,49 @@ struct SphericalMultipole3D {
   inline static
   void S2M(int P, const point_type& translation, const charge_type& charge,
            multipole_type& M) {
-    real_type rho, theta, phi;
-    cart2sph(rho, theta, phi, translation);
-//    complex_type Z[P*(P+1)/2];   // Avoid initialization?
-    complex_type * Z = (complex_type *)alloca(sizeof (complex_type) * (P*(P+1)/2));
-    evalZ(rho, theta, phi, P, Z);
+    complex_type* Z = scratch<complex_type,0>(P*P);
+    evalZ(translation, P, Z);
     int nm = 0;   // n*(n+1)/2+m
     for (int n = 0; n < P; ++n) {
+      const complex_type* Zn = Z + n*(n+1);
       for (int m = 0; m <= n; ++m, ++nm) {
-        M[nm] += neg1pow(m) * conj(Z[nm]) * charge;
+        M[nm] += neg1pow(m) * conj(Zn[m]) * charge;
       }
     }
   }
 
   /** Kernel M2M operator
    * M_t += Op(M_s) where M_t is the target and M_s is the source
+   *
+   * M_n^m += sum_{j,k} Z_j^{-k} M_{n-j}^{m-k}
    */
   inline static
   void M2M(int P,
            const multipole_type& Msource,
            multipole_type& Mtarget,
            const point_type& translation) {
-    real_type rho, theta, phi;
-    cart2sph(rho, theta, phi, translation);
-//    complex_type Z[P*(P+1)/2];
-    complex_type * Z = (complex_type *)alloca(sizeof (complex_type) * (P*(P+1)/2));
-    evalZ(rho, theta, phi, P, Z);
+    complex_type* Z = scratch<complex_type,0>(P*P);
+    evalZ(translation, P, Z);
+    multipole_coeff_type* M = scratch<multipole_coeff_type,1>(P*P);
+    extend(P, Msource, M);
+
     int nm = 0;   // n*(n+1)/2+m
     for (int n = 0; n != P; ++n) {
       for (int m = 0; m <= n; ++m, ++nm) {
-        auto& M = Mtarget[nm];
+        multipole_coeff_type Mnm = Mtarget[nm];
 
         for (int j = 0; j <= n; ++j) {
-          // Compute the offset for Y_j
-          const auto Zj = Z + j*(j+1)/2;
-          // Compute the offset for M_{n-j}
-          const auto Mnj = Msource.begin() + (n-j)*(n-j+1)/2;
-
-          // All k with -j <= k <= 0 and 0 <= m-k <= n-j
-          // Thus, k >= -j and k >= -n+j+m
-          int k = std::max(-j, -n+j+m);
-          // Thus, k <= 0 and k <= m
-          for ( ; k <= 0; ++k) {
-            // k is negative and m-k is positive
-            M += Zj[-k] * Mnj[m-k];
-          }
-
-          // All k with 0 < k <= j and 0 <= m-k <= n-j
-          // Thus, k <= j and k <= m
-          int end = std::min(j, m);
-          for ( ; k <= end; ++k) {
-            // k is positive and m-k is positive
-            M += neg1pow(k) * conj(Zj[k]) * Mnj[m-k];
-          }
-
-          // All k with 0 <= k < j and -(n-j) <= m-k <= 0
-          // Thus, k <= j and k <= n+m-j
-          end = std::min(j, n+m-j);
-          for ( ; k <= end; ++k) {
-            // k is positive and m-k is negative
-            M += conj(neg1pow(m) * Zj[k] * Mnj[k-m]);
-          }
+          // Z_j and M_{n-j}, centered on order zero
+          const complex_type*         Zj  = Z + j*(j+1);
+          const multipole_coeff_type* Mnj = M + (n-j)*(n-j+1);
+
+          // All k with |k| <= j and |m-k| <= n-j
+          const int k_end = std::min(j, m+n-j);
+          for (int k = std::max(-j, m-n+j); k <= k_end; ++k)
+            mul_add(Mnm, Zj[-k], Mnj[m-k]);
         }
+
+        Mtarget[nm] = Mnm;
       }
     }
   }
@@ -96,6 +80,8 @@ struct SphericalMultipole3D {
   /** Kernel M2L operation
    * L += Op(M)
    *
+   * L_n^m += sum_{j,k} W_{j+n}^{k-m} M_j^k
+   *
    * @param[in] Msource The multpole expansion source
    * @param[in,out] Ltarget The local expansion target
    * @param[in] translation The vector from source to target
@@ -107,46 +93,27 @@ struct SphericalMultipole3D {
            const multipole_type& Msource,
            local_type& Ltarget,
            const point_type& translation) {
-    real_type rho, theta, phi;
-    cart2sph(rho, theta, phi, translation);
-//    complex_type W[P*(2*P+1)];
-    complex_type * W = (complex_type *)alloca(sizeof (complex_type) * (P*(2*P+1)));
-    evalW(rho, theta, phi, 2*P, W);
+    complex_type* W = scratch<complex_type,0>((2*P-1)*(2*P-1));
+    evalW(translation, 2*P-1, W);
+    multipole_coeff_type* M = scratch<multipole_coeff_type,1>(P*P);
+    extend(P, Msource, M);
+
     int nm = 0;    // n*(n+1)/2 + m
     for (int n = 0; n != P; ++n) {
       for (int m = 0; m <= n; ++m, ++nm) {
-        auto& L = Ltarget[nm];
+        local_coeff_type Lnm = Ltarget[nm];
 
         for (int j = 0; j != P; ++j) {
-          // Compute the offset for M_j
-          const auto Mj = Msource.begin() + j*(j+1)/2;
-          // Compute the offset for W_{j+n}
-          const auto Wjn = W + (j+n)*(j+n+1)/2;
-
-          // All k with -j <= k <= 0 and -(j+n) <= k-m <= 0
-          // Thus, k >= -j and k >= m-n-j
-          int k = -j;
-          // Thus, k <= 0 and k <= m
-          for ( ; k <= 0; ++k) {
-            // k is negative and k-m is negative
-            L += conj(neg1pow(m) * Wjn[m-k] * Mj[-k]);
-          }
+          // M_j and W_{j+n}, centered on order zero
+          const multipole_coeff_type* Mj  = M + j*(j+1);
+          const complex_type*         Wjn = W + (j+n)*(j+n+1) - m;
 
-          // All k with 0 <= k <= j and -(j+n) <= k-m <= 0
-          // Thus, k <= j and k <= m
-          int end = std::min(j, m);
-          for ( ; k <= end; ++k) {
-            // k is positive and k-m is negative
-            L += neg1pow(k-m) * conj(Wjn[m-k]) * Mj[k];
-          }
-
-          // All k with 0 <= k <= j and 0 <= k-m <= j+n
-          // Thus, k <= j and k <= m+n+j
-          for ( ; k <= j; ++k) {
-            // k is positive and k-m is positive
-            L += Wjn[k-m] * Mj[k];
-          }
+          // All k with |k| <= j, which always satisfy |k-m| <= j+n
+          for (int k = -j; k <= j; ++k)
+            mul_add(Lnm, Wjn[k], Mj[k]);
         }
+
+        Ltarget[nm] = Lnm;
       }
     }
   }
@@ -154,6 +121,8 @@ struct SphericalMultipole3D {
   /** Kernel L2L operator
    * L_t += Op(L_s) where L_t is the target and L_s is the source
    *
+   * L_n^m += sum_{j,k} Z_{j-n}^{k-m} L_j^k
+   *
    * @param[in] source The local source at the parent level
    * @param[in,out] target The local target to accumulate into
    * @param[in] translation The vector from source to target
@@ -164,49 +133,196 @@ struct SphericalMultipole3D {
            const local_type& Lsource,
            local_type& Ltarget,
            const point_type& translation) {
-    real_type rho, theta, phi;
-    cart2sph(rho, theta, phi, translation);
-//    complex_type Z[P*(P+1)/2];
-    complex_type * Z = (complex_type *)alloca(sizeof (complex_type) * (P*(P+1)/2));
-    evalZ(rho, theta, phi, P, Z);
+    complex_type* Z = scratch<complex_type,0>(P*P);
+    evalZ(translation, P, Z);
+    local_coeff_type* L = scratch<local_coeff_type,1>(P*P);
+    extend(P, Lsource, L);
+
     int nm = 0;    // n*(n+1)/2 + m
     for (int n = 0; n != P; ++n) {
       for (int m = 0; m <= n; ++m, ++nm) {
-        auto& L = Ltarget[nm];
+        local_coeff_type Lnm = Ltarget[nm];
 
         for (int j = n; j != P; ++j) {
-          // Compute the offset for L_j
-          const auto Lj = Lsource.begin() + j*(j+1)/2;
-          // Compute the offset for Z_{j-n}
-          const auto Zjn = Z + (j-n)*(j-n+1)/2;
-
-          // All k with -j <= k <= 0 and -(j-n) <= k-m <= 0
-          // Thus, k >= -j and k >= n+m-j
-          int k = n+m-j;
-          // Thus, k <= 0 and k <= m
-          for ( ; k <= 0; ++k) {
-            // k is negative and k-m is negative
-            L += conj(neg1pow(m) * Zjn[m-k] * Lj[-k]);
-          }
+          // L_j and Z_{j-n}, centered on order zero
+          const local_coeff_type* Lj  = L + j*(j+1);
+          const complex_type*     Zjn = Z + (j-n)*(j-n+1) - m;
+
+          // All k with |k| <= j and |k-m| <= j-n
+          const int k_end = std::min(j, m+j-n);
+          for (int k = std::max(-j, m-j+n); k <= k_end; ++k)
+            mul_add(Lnm, Zjn[k], Lj[k]);
+        }
 
-          // All k with 0 <= k <= j and -(j-n) <= k-m <= 0
-          // Thus, k <= j and k <= m
-          int end = std::min(j, m);
-          for ( ; k <= end; ++k) {
-            // k is positive and k-m is negative
-            L += neg1pow(k-m) * conj(Zjn[m-k]) * Lj[k];
-          }
+        Ltarget[nm] = Lnm;
+      }
+    }
+  }
 
-          // All k with 0 <= k <= j and 0 <= k-m <= j-n
-          // Thus, k <= j and k <= m-n+j
-          end = std::min(j, m-n+j);
-          for ( ; k <= end; ++k) {
-            // k is positive and k-m is positive
-            L += Zjn[k-m] * Lj[k];
-          }
+  /** Cartesian gradient of the field of a local expansion
+   * grad[d] = d/dx_d sum_{n,m} Re(L_n^m Z_n^m(x)) over all -n <= m <= n
+   *
+   * Uses the ladder identities of the regular solid harmonics
+   *   d/dz       Z_n^m = Z_{n-1}^m
+   *   d/dx +- i d/dy Z_n^m = i Z_{n-1}^{m+-1}
+   * so no spherical coordinates or theta-derivatives are needed and the
+   * result is regular on the z-axis.
+   *
+   * @param[in] L The local expansion
+   * @param[in] x The vector from the expansion center to the target
+   * @param[out] grad The gradient, one entry per Cartesian direction
+   */
+  template <typename gradient_type>
+  inline static
+  void L2T_gradient(int P, const local_type& L, const point_type& x,
+                    gradient_type* grad) {
+    complex_type* Z = scratch<complex_type,0>(P*P);
+    evalZ(x, P-1, Z);
+
+    gradient_type gx = gradient_type(), gy = gradient_type(), gz = gradient_type();
+    int nm = 1;    // n*(n+1)/2 + m
+    for (int n = 1; n != P; ++n) {
+      const complex_type* Zn = Z + (n-1)*n;   // Z_{n-1}, centered on order zero
+
+      // Orders m > 0 also account for the conjugate term of order -m
+      int m = 0;
+      for ( ; m <= n-2; ++m, ++nm) {
+        const real_type w = (m == 0 ? 1 : 2);
+        imag_mul_add(gx, -w/2, L[nm], Zn[m+1] + Zn[m-1]);
+        real_mul_add(gy,  w/2, L[nm], Zn[m+1] - Zn[m-1]);
+        real_mul_add(gz,  w,   L[nm], Zn[m]);
+      }
+
+      // m == n-1, where Z_{n-1}^{m+1} == 0
+      const real_type w = (m == 0 ? 1 : 2);
+      real_mul_add(gz, w, L[nm], Zn[m]);
+      if (n > 1) {
+        imag_mul_add(gx, -w/2, L[nm], Zn[m-1]);
+        real_mul_add(gy, -w/2, L[nm], Zn[m-1]);
+      }
+      ++m, ++nm;
+
+      // m == n, where only Z_{n-1}^{m-1} != 0
+      imag_mul_add(gx, -1, L[nm], Zn[m-1]);
+      real_mul_add(gy, -1, L[nm], Zn[m-1]);
+      ++nm;
+    }
+
+    grad[0] = gx;
+    grad[1] = gy;
+    grad[2] = gz;
+  }
+
+
+  /** Cartesian Hessian of the field of a local expansion
+   * hess[3*a+b] = d^2/dx_a dx_b sum_{n,m} Re(L_n^m Z_n^m(x))
+   *
+   * Applies the ladder identities of L2T_gradient twice, e.g.
+   *   d^2/dz^2   Z_n^m = Z_{n-2}^m
+   *   d^2/dx dy  Z_n^m = i/4 (Z_{n-2}^{m+2} - Z_{n-2}^{m-2})
+   *
+   * @param[in] L The local expansion
+   * @param[in] x The vector from the expansion center to the target
+   * @param[out] hess The symmetric Hessian, row-major with 9 entries
+   */
+  template <typename gradient_type>
+  inline static
+  void L2T_hessian(int P, const local_type& L, const point_type& x,
+                   gradient_type* hess) {
+    gradient_type hxx = gradient_type(), hyy = gradient_type(), hzz = gradient_type();
+    gradient_type hxy = gradient_type(), hxz = gradient_type(), hyz = gradient_type();
+
+    if (P > 2) {
+      complex_type* Z = scratch<complex_type,0>(P*P);
+      evalZ(x, P-2, Z);
+
+      int nm = 3;    // n*(n+1)/2 + m
+      for (int n = 2; n != P; ++n) {
+        const int k = n-2;
+        const complex_type* Zn = Z + k*(k+1);   // Z_{n-2}, centered on order zero
+
+        // Orders m > 0 also account for the conjugate term of order -m
+        for (int m = 0; m <= n; ++m, ++nm) {
+          const real_type w = (m == 0 ? 1 : 2);
+          const complex_type Zm2 = row_at(Zn, k, m-2);
+          const complex_type Zm1 = row_at(Zn, k, m-1);
+          const complex_type Z0  = row_at(Zn, k, m);
+          const complex_type Zp1 = row_at(Zn, k, m+1);
+          const complex_type Zp2 = row_at(Zn, k, m+2);
+
+          real_mul_add(hxx, -w/4, L[nm], Zp2 + real_type(2)*Z0 + Zm2);
+          real_mul_add(hyy,  w/4, L[nm], Zp2 - real_type(2)*Z0 + Zm2);
+          real_mul_add(hzz,  w,   L[nm], Z0);
+          imag_mul_add(hxy, -w/4, L[nm], Zp2 - Zm2);
+          imag_mul_add(hxz, -w/2, L[nm], Zp1 + Zm1);
+          real_mul_add(hyz,  w/2, L[nm], Zp1 - Zm1);
         }
       }
     }
+
+    hess[0] = hxx;  hess[1] = hxy;  hess[2] = hxz;
+    hess[3] = hxy;  hess[4] = hyy;  hess[5] = hyz;
+    hess[6] = hxz;  hess[7] = hyz;  hess[8] = hzz;
+  }
+
+
+  /** Cartesian gradient of the field of a multipole expansion, evaluated
+   * directly at a target outside its box
+   *
+   * Only the first degree of the M2L operator about the target is needed,
+   *   L_1^m = sum_{j,k} W_{j+1}^{k-m} M_j^k,
+   * whose gradient at the target is that of L2T_gradient at x = 0.
+   *
+   * @param[in] M The multipole expansion
+   * @param[in] x The vector from the expansion center to the target
+   * @param[out] grad The gradient, one entry per Cartesian direction
+   * @pre x obeys the multipole-acceptance criteria
+   */
+  template <typename gradient_type>
+  inline static
+  void M2T_gradient(int P, const multipole_type& Msource, const point_type& x,
+                    gradient_type* grad) {
+    local_coeff_type L[3] = {};
+    M2T_local<1>(P, Msource, x, L);
+    local_gradient(L, grad);
+  }
+
+  /** Cartesian gradient and Hessian of the field of a multipole expansion,
+   * evaluated directly at a target outside its box
+   *
+   * As M2T_gradient, from the first two degrees of the M2L operator about the
+   * target. The Hessian at the target is that of L2T_hessian at x = 0.
+   *
+   * @param[in] M The multipole expansion
+   * @param[in] x The vector from the expansion center to the target
+   * @param[out] grad The gradient, one entry per Cartesian direction
+   * @param[out] hess The symmetric Hessian, row-major with 9 entries
+   * @pre x obeys the multipole-acceptance criteria
+   */
+  template <typename gradient_type>
+  inline static
+  void M2T_hessian(int P, const multipole_type& Msource, const point_type& x,
+                   gradient_type* grad, gradient_type* hess) {
+    local_coeff_type L[6] = {};
+    M2T_local<2>(P, Msource, x, L);
+    local_gradient(L, grad);
+
+    // L2T_hessian at x = 0, where only Z_0^0 == 1 is nonzero
+    gradient_type hxx = gradient_type(), hyy = gradient_type(), hzz = gradient_type();
+    gradient_type hxy = gradient_type(), hxz = gradient_type(), hyz = gradient_type();
+    const complex_type one(1);
+    real_mul_add(hxx, -0.5, L[3], one);
+    real_mul_add(hxx, -0.5, L[5], one);
+    real_mul_add(hyy, -0.5, L[3], one);
+    real_mul_add(hyy,  0.5, L[5], one);
+    real_mul_add(hzz,  1,   L[3], one);
+    imag_mul_add(hxy,  0.5, L[5], one);
+    imag_mul_add(hxz, -1,   L[4], one);
+    real_mul_add(hyz, -1,   L[4], one);
+
+    hess[0] = hxx;  hess[1] = hxy;  hess[2] = hxz;
+    hess[3] = hxy;  hess[4] = hyy;  hess[5] = hyz;
+    hess[6] = hxz;  hess[7] = hyz;  hess[8] = hzz;
   }
 
 
@@ -406,4 +522,245 @@ struct SphericalMultipole3D {
     }                                               // End loop over m in Wnm
   }
 
+
+  /** Computes the functions Z_n^m (see evalZ above) from the Cartesian
+   * coordinates of x,
+   * Z[n*(n+1)+m] = Z_n^m(x)
+   * for all 0 <= n < P and all -n <= m <= n.
+   *
+   * Uses the recurrences of the regular solid harmonics
+   *   Z_m^m = i (x + iy) / (2m) Z_{m-1}^{m-1}
+   *   Z_n^m = ((2n-1) z Z_{n-1}^m - r^2 Z_{n-2}^m) / ((n+m)(n-m))
+   * which need no trigonometric functions and are regular at the poles.
+   *
+   * @param[in] x      The point to evaluate at.
+   * @param[in] P      The number of degrees to compute, P > 0.
+   * @param[out] Z     Storage for P*P elements.
+   */
+  inline static
+  void evalZ(const point_type& x, int P, complex_type* Z) {
+    const real_type z  = x[2];
+    const real_type r2 = x[0]*x[0] + x[1]*x[1] + x[2]*x[2];
+
+    real_type re = 1, im = 0;                       // Z_m^m
+    for (int m = 0; m < P; ++m) {                   // For all 0 <= m < P
+      if (m > 0) {
+        const real_type s = real_type(1) / (2*m);   //  Z_m^m recurrence,
+        const real_type t = -(re*x[1] + im*x[0]);   //  multiply by i(x+iy)
+        im = (re*x[0] - im*x[1]) * s;
+        re = t * s;
+      }
+
+      complex_type* Zm = Z + m;                     //  Column of order m
+      real_type re2 = 0, im2 = 0;                   //  Z_{n-2}^m
+      real_type re1 = re, im1 = im;                 //  Z_{n-1}^m
+      Zm[m*(m+1)] = complex_type(re, im);
+      for (int n = m+1; n < P; ++n) {               //  Z_n^m recurrence
+        const real_type a = (2*n-1) * z;
+        const real_type s = real_type(1) / ((n+m)*(n-m));
+        const real_type ren = (a*re1 - r2*re2) * s;
+        const real_type imn = (a*im1 - r2*im2) * s;
+        re2 = re1; im2 = im1;
+        re1 = ren; im1 = imn;
+        Zm[n*(n+1)] = complex_type(ren, imn);
+      }
+    }
+
+    reflect(P, Z);
+  }
+
+  /** Computes the functions W_n^m (see evalW above) from the Cartesian
+   * coordinates of x,
+   * W[n*(n+1)+m] = W_n^m(x)
+   * for all 0 <= n < P and all -n <= m <= n.
+   *
+   * Uses the recurrences of the irregular solid harmonics
+   *   W_m^m = (2m-1) i (x + iy) / r^2 W_{m-1}^{m-1}
+   *   W_n^m = -((2n-1) z W_{n-1}^m + (n+m-1)(n-m-1) W_{n-2}^m) / r^2
+   *
+   * @param[in] x      The point to evaluate at, x != 0.
+   * @param[in] P      The number of degrees to compute, P > 0.
+   * @param[out] W     Storage for P*P elements.
+   */
+  inline static
+  void evalW(const point_type& x, int P, complex_type* W) {
+    using std::sqrt;
+    const real_type z    = x[2];
+    const real_type r2   = x[0]*x[0] + x[1]*x[1] + x[2]*x[2];
+    const real_type inv2 = 1 / r2;
+
+    real_type re = sqrt(inv2), im = 0;              // W_m^m
+    for (int m = 0; m < P; ++m) {                   // For all 0 <= m < P
+      if (m > 0) {
+        const real_type s = (2*m-1) * inv2;         //  W_m^m recurrence,
+        const real_type t = -(re*x[1] + im*x[0]);   //  multiply by i(x+iy)
+        im = (re*x[0] - im*x[1]) * s;
+        re = t * s;
+      }
+
+      complex_type* Wm = W + m;                     //  Column of order m
+      real_type re2 = 0, im2 = 0;                   //  W_{n-2}^m
+      real_type re1 = re, im1 = im;                 //  W_{n-1}^m
+      Wm[m*(m+1)] = complex_type(re, im);
+      for (int n = m+1; n < P; ++n) {               //  W_n^m recurrence
+        const real_type a = -(2*n-1) * z * inv2;
+        const real_type b = -(n+m-1) * (n-m-1) * inv2;
+        const real_type ren = a*re1 + b*re2;
+        const real_type imn = a*im1 + b*im2;
+        re2 = re1; im2 = im1;
+        re1 = ren; im1 = imn;
+        Wm[n*(n+1)] = complex_type(ren, imn);
+      }
+    }
+
+    reflect(P, W);
+  }
+
+ private:
+  //! Coefficient types of the expansions
+  typedef typename multipole_type::value_type multipole_coeff_type;
+  typedef typename local_type::value_type     local_coeff_type;
+
+  /** Per-thread scratch storage of at least n elements, reused across calls.
+   * Slot distinguishes buffers of the same type that are live together.
+   */
+  template <typename T, int Slot>
+  inline static T* scratch(std::size_t n) {
+    static thread_local std::vector<T> buffer;
+    if (buffer.size() < n)
+      buffer.resize(n);
+    return buffer.data();
+  }
+
+  /** Fill the negative orders of Y[n*(n+1)+m] from the symmetry
+   *   Y_n^{-m} = (-1)^m conj(Y_n^m)
+   */
+  template <typename T>
+  inline static void reflect(int P, T* Y) {
+    for (int n = 1; n < P; ++n) {
+      T* Yn = Y + n*(n+1);
+      for (int m = 1; m <= n; ++m)
+        Yn[-m] = neg1pow_conj(m, Yn[m]);
+    }
+  }
+
+  /** Copy the expansion E, stored for 0 <= m <= n at n*(n+1)/2+m, to
+   * F[n*(n+1)+m] for all -n <= m <= n
+   */
+  template <typename Expansion, typename T>
+  inline static void extend(int P, const Expansion& E, T* F) {
+    int nm = 0;
+    for (int n = 0; n < P; ++n) {
+      T* Fn = F + n*(n+1);
+      for (int m = 0; m <= n; ++m, ++nm)
+        Fn[m] = E[nm];
+    }
+    reflect(P, F);
+  }
+
+  /** The degrees 1 <= n <= D of the M2L operator about a target,
+   *   L[n*(n+1)/2+m] += sum_{j,k} W_{j+n}^{k-m} M_j^k
+   * The negative orders of M are reflected on the fly, as this is called once
+   * per target rather than once per box.
+   */
+  template <int D>
+  inline static void M2T_local(int P, const multipole_type& Msource,
+                               const point_type& x, local_coeff_type* L) {
+    complex_type* W = scratch<complex_type,0>((P+D)*(P+D));
+    evalW(x, P+D, W);
+
+    int jk = 0;    // j*(j+1)/2 + k
+    for (int j = 0; j != P; ++j) {
+      for (int k = 0; k <= j; ++k, ++jk) {
+        // M_j^{-k} == (-1)^k conj(M_j^k)
+        const multipole_coeff_type Mneg = neg1pow_conj(k, Msource[jk]);
+        int nm = 1;    // n*(n+1)/2 + m
+        for (int n = 1; n <= D; ++n) {
+          // W_{j+n}, centered on order zero
+          const complex_type* Wjn = W + (j+n)*(j+n+1);
+          for (int m = 0; m <= n; ++m, ++nm) {
+            mul_add(L[nm], Wjn[k-m], Msource[jk]);
+            if (k > 0)
+              mul_add(L[nm], Wjn[-k-m], Mneg);
+          }
+        }
+      }
+    }
+  }
+
+  /** L2T_gradient at x = 0 from the first degree of L, where only
+   * Z_0^0 == 1 is nonzero
+   */
+  template <typename gradient_type>
+  inline static void local_gradient(const local_coeff_type* L,
+                                    gradient_type* grad) {
+    gradient_type gx = gradient_type(), gy = gradient_type(), gz = gradient_type();
+    const complex_type one(1);
+    real_mul_add(gz,  1, L[1], one);
+    imag_mul_add(gx, -1, L[2], one);
+    real_mul_add(gy, -1, L[2], one);
+
+    grad[0] = gx;
+    grad[1] = gy;
+    grad[2] = gz;
+  }
+
+  //! Y_n^k from a row centered on order zero, or zero if |k| > n
+  inline static complex_type row_at(const complex_type* Yn, int n, int k) {
+    return (k < -n || k > n) ? complex_type() : Yn[k];
+  }
+
+  //! (-1)^m conj(a)
+  inline static complex_type neg1pow_conj(int m, const complex_type& a) {
+    return complex_type(neg1pow(m) * a.real(), -neg1pow(m) * a.imag());
+  }
+  template <std::size_t N>
+  inline static Vec<N,complex_type> neg1pow_conj(int m,
+                                                 const Vec<N,complex_type>& a) {
+    Vec<N,complex_type> r;
+    for (std::size_t i = 0; i < N; ++i)
+      r[i] = neg1pow_conj(m, a[i]);
+    return r;
+  }
+
+  /** c += a * b
+   * Written out in real arithmetic: std::complex multiplication guards
+   * against inf/nan results and is not inlined without -ffast-math.
+   */
+  inline static void mul_add(complex_type& c,
+                             const complex_type& a, const complex_type& b) {
+    c = complex_type(c.real() + a.real()*b.real() - a.imag()*b.imag(),
+                     c.imag() + a.real()*b.imag() + a.imag()*b.real());
+  }
+  template <std::size_t N>
+  inline static void mul_add(Vec<N,complex_type>& c,
+                             const complex_type& a,
+                             const Vec<N,complex_type>& b) {
+    for (std::size_t i = 0; i < N; ++i)
+      mul_add(c[i], a, b[i]);
+  }
+
+  //! g += w * Re(a * b) and g += w * Im(a * b)
+  inline static void real_mul_add(real_type& g, real_type w,
+                                  const complex_type& a, const complex_type& b) {
+    g += w * (a.real()*b.real() - a.imag()*b.imag());
+  }
+  inline static void imag_mul_add(real_type& g, real_type w,
+                                  const complex_type& a, const complex_type& b) {
+    g += w * (a.real()*b.imag() + a.imag()*b.real());
+  }
+  template <std::size_t N>
+  inline static void real_mul_add(Vec<N,real_type>& g, real_type w,
+                                  const Vec<N,complex_type>& a,
+                                  const complex_type& b) {
+    for (std::size_t i = 0; i < N; ++i)
+      real_mul_add(g[i], w, a[i], b);
+  }
+  template <std::size_t N>
+  inline static void imag_mul_add(Vec<N,real_type>& g, real_type w,
+                                  const Vec<N,complex_type>& a,
+                                  const complex_type& b) {
+    for (std::size_t i = 0; i < N; ++i)
+      imag_mul_add(g[i], w, a[i], b);
+  }
 };
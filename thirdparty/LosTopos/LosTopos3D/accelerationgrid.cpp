@@ -14,6 +14,7 @@
 
 #include <accelerationgrid.h>
 
+#include <algorithm>
 #include <array3.h>
 #include <limits>
 #include <util.h>
@@ -50,8 +51,6 @@ m_cells(0,0,0),
 m_elementidxs(0),
 m_elementxmins(0),
 m_elementxmaxs(0),
-m_elementquery(0),
-m_lastquery(0),
 m_gridxmin(0,0,0),
 m_gridxmax(0,0,0),
 m_cellsize(0,0,0),
@@ -74,8 +73,6 @@ m_cells(0,0,0),
 m_elementidxs(0),
 m_elementxmins(0),
 m_elementxmaxs(0),
-m_elementquery(0),
-m_lastquery(0),
 m_gridxmin(0,0,0),
 m_gridxmax(0,0,0),
 m_cellsize(0,0,0),
@@ -110,8 +107,6 @@ AccelerationGrid& AccelerationGrid::operator=( const AccelerationGrid& other)
     m_elementidxs = other.m_elementidxs;
     m_elementxmins = other.m_elementxmins;
     m_elementxmaxs = other.m_elementxmaxs;
-    m_elementquery = other.m_elementquery;
-    m_lastquery = other.m_lastquery;
     m_gridxmin = other.m_gridxmin;
     m_gridxmax = other.m_gridxmax;
     m_cellsize = other.m_cellsize;
@@ -163,7 +158,7 @@ void AccelerationGrid::set( const Vec3st& dims, const Vec3d& xmin, const Vec3d&
 ///
 // --------------------------------------------------------
 
-void AccelerationGrid::boundstoindices(const Vec3d& xmin, const Vec3d& xmax, Vec3i& xmini, Vec3i& xmaxi)
+void AccelerationGrid::boundstoindices(const Vec3d& xmin, const Vec3d& xmax, Vec3i& xmini, Vec3i& xmaxi) const
 {
     
     xmini[0] = (int) std::floor((xmin[0] - m_gridxmin[0]) * m_invcellsize[0]);
@@ -211,13 +206,11 @@ void AccelerationGrid::add_element(size_t idx, const Vec3d& xmin, const Vec3d& x
         m_elementidxs[idx].reserve(10); //reserve some space in the vector
         m_elementxmins.resize(idx+1);
         m_elementxmaxs.resize(idx+1);
-        m_elementquery.resize(idx+1);
         m_elementcount = idx+1;
     }
     
     m_elementxmins[idx] = xmin;
     m_elementxmaxs[idx] = xmax;
-    m_elementquery[idx] = 0;
         
     Vec3i xmini, xmaxi;
     boundstoindices(xmin, xmax, xmini, xmaxi);
@@ -321,7 +314,6 @@ void AccelerationGrid::update_element(size_t idx, const Vec3d& xmin, const Vec3d
    //set the new bounds and query data.
    m_elementxmins[idx] = xmin;
    m_elementxmaxs[idx] = xmax;
-   m_elementquery[idx] = 0;
 
    //try to do something smarter if the element has only moved slightly
    if(!is_new && boxes_overlap(xmini_old, xmaxi_old, xmini_new, xmaxi_new)) {
@@ -464,8 +456,6 @@ void AccelerationGrid::clear()
 
     m_elementxmins.clear();
     m_elementxmaxs.clear();
-    m_elementquery.clear();
-    m_lastquery = 0;
 
     m_elementcount = 0;
     
@@ -475,33 +465,23 @@ void AccelerationGrid::clear()
 ///
 /// Return the set of elements which have AABBs overlapping the query AABB.
 ///
+/// An element overlapping several query cells is reported only from the first cell shared by its own cell range and the
+/// query's cell range, so no per-element "already seen" flags are written and the grid can be queried from many threads.
+///
 // --------------------------------------------------------
 
-void AccelerationGrid::find_overlapping_elements( const Vec3d& xmin, const Vec3d& xmax, std::vector<size_t>& results ) 
+void AccelerationGrid::find_overlapping_elements( const Vec3d& xmin, const Vec3d& xmax, std::vector<size_t>& results ) const
 {
-    if(m_lastquery == std::numeric_limits<unsigned int>::max())
-    {
-        std::vector<unsigned int>::iterator iter = m_elementquery.begin();
-        for( ; iter != m_elementquery.end(); ++iter )
-        {
-            *iter = 0;
-        }
-        m_lastquery = 0;
-    }
-    
-    ++m_lastquery;
-    
     Vec3i xmini, xmaxi;
     boundstoindices(xmin, xmax, xmini, xmaxi);
     
     for(int k = xmini[2]; k <= xmaxi[2]; ++k)
     {
-      for(int j = xmini[1]; j <= xmaxi[1]; ++j)
-      {
-         for(int i = xmini[0]; i <= xmaxi[0]; ++i)
-         {
-
-                std::vector<size_t>* cell = m_cells(i, j, k);
+        for(int j = xmini[1]; j <= xmaxi[1]; ++j)
+        {
+            for(int i = xmini[0]; i <= xmaxi[0]; ++i)
+            {
+                const std::vector<size_t>* cell = m_cells(i, j, k);
                 
                 if(cell)
                 {
@@ -509,24 +489,23 @@ void AccelerationGrid::find_overlapping_elements( const Vec3d& xmin, const Vec3d
                     {
                         size_t oidx = *citer;
                         
-                        // Check if the object has already been found during this query
+                        const Vec3d& oxmin = m_elementxmins[oidx];
+                        const Vec3d& oxmax = m_elementxmaxs[oidx];
                         
-                        if(m_elementquery[oidx] < m_lastquery)
+                        if( (xmin[0] <= oxmax[0] && xmin[1] <= oxmax[1] && xmin[2] <= oxmax[2]) &&
+                           (xmax[0] >= oxmin[0] && xmax[1] >= oxmin[1] && xmax[2] >= oxmin[2]) )
                         {
+                            // Only report the object from the first cell it shares with the query
                             
-                            // Object has not been found.  Set m_elementquery so that it will not be tested again during this query.
+                            Vec3i oxmini, oxmaxi;
+                            boundstoindices(oxmin, oxmax, oxmini, oxmaxi);
                             
-                            m_elementquery[oidx] = m_lastquery;
-                            
-                            const Vec3d& oxmin = m_elementxmins[oidx];
-                            const Vec3d& oxmax = m_elementxmaxs[oidx];
-                            
-                            if( (xmin[0] <= oxmax[0] && xmin[1] <= oxmax[1] && xmin[2] <= oxmax[2]) &&
-                               (xmax[0] >= oxmin[0] && xmax[1] >= oxmin[1] && xmax[2] >= oxmin[2]) )
+                            if( i == std::max(xmini[0], oxmini[0]) && 
+                                j == std::max(xmini[1], oxmini[1]) && 
+                                k == std::max(xmini[2], oxmini[2]) )
                             {
                                 results.push_back(oidx);
                             }
-                            
                         }
                     }
                 }
@@ -47,7 +47,7 @@ public:
     
     /// Generate a set of voxel indices from a pair of AABB extents
     ///
-    void boundstoindices( const Vec3d& xmin, const Vec3d& xmax, Vec3i& xmini, Vec3i& xmaxi);
+    void boundstoindices( const Vec3d& xmin, const Vec3d& xmax, Vec3i& xmini, Vec3i& xmaxi) const;
     
     /// Add an object with the specified index and AABB to the grid
     ///
@@ -65,9 +65,10 @@ public:
     ///
     void clear();
     
-    /// Return the set of elements which have AABBs overlapping the query AABB.
+    /// Return the set of elements which have AABBs overlapping the query AABB.  Each element is reported once, without any 
+    /// per-query state, so concurrent queries are safe as long as nobody modifies the grid.
     ///
-    void find_overlapping_elements( const Vec3d& xmin, const Vec3d& xmax, std::vector<size_t>& results );
+    void find_overlapping_elements( const Vec3d& xmin, const Vec3d& xmax, std::vector<size_t>& results ) const;
     
     
     /// Each cell contains an array of indices specifying the elements whose AABBs overlap the cell
@@ -82,14 +83,6 @@ public:
     ///
     std::vector<Vec3d> m_elementxmins, m_elementxmaxs;
     
-    /// For each element, the timestamp of the last query that examined the element
-    ///
-    std::vector<unsigned int> m_elementquery;
-    
-    /// Timestamp of the last query
-    ///
-    unsigned int m_lastquery;
-    
     /// Lower/upper corners of the entire grid
     ///
     Vec3d m_gridxmin, m_gridxmax;
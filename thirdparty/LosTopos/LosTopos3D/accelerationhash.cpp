@@ -0,0 +1,366 @@
+// ---------------------------------------------------------
+//
+//  accelerationhash.cpp
+//
+//  A sparse, hashed-grid collision test culling structure.
+//
+// ---------------------------------------------------------
+
+// ---------------------------------------------------------
+// Includes
+// ---------------------------------------------------------
+
+#include <accelerationhash.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+// ---------------------------------------------------------
+// Local constants, typedefs, macros
+// ---------------------------------------------------------
+
+namespace LosTopos {
+
+namespace {
+
+enum { ELEMENT_ABSENT = 0, ELEMENT_HASHED = 1, ELEMENT_OVERSIZED = 2 };
+
+/// Keep cell indices well within int range, however far from the origin the geometry drifts
+const double MAX_CELL_COORD = 1 << 30;
+
+inline int to_cell( double x, double invcellsize )
+{
+    double c = std::floor( x * invcellsize );
+    if ( c < -MAX_CELL_COORD ) { c = -MAX_CELL_COORD; }
+    if ( c > MAX_CELL_COORD ) { c = MAX_CELL_COORD; }
+    return (int) c;
+}
+
+/// Number of cells in an index range; inside-out ranges (e.g. AABBs of deleted elements) cover no cells
+inline double cell_count( const Vec3i& xmini, const Vec3i& xmaxi )
+{
+    if ( xmaxi[0] < xmini[0] || xmaxi[1] < xmini[1] || xmaxi[2] < xmini[2] ) { return 0.0; }
+    return (double)( xmaxi[0] - xmini[0] + 1 ) * (double)( xmaxi[1] - xmini[1] + 1 ) * (double)( xmaxi[2] - xmini[2] + 1 );
+}
+
+}
+
+// ---------------------------------------------------------
+// Member function definitions
+// ---------------------------------------------------------
+
+// --------------------------------------------------------
+///
+/// Default constructor
+///
+// --------------------------------------------------------
+
+AccelerationHash::AccelerationHash() :
+m_cells(),
+m_oversized(),
+m_elementcellmins(0),
+m_elementcellmaxs(0),
+m_elementstate(0),
+m_elementxmins(0),
+m_elementxmaxs(0),
+m_cellsize(1.0),
+m_invcellsize(1.0),
+m_elementcount(0)
+{}
+
+// --------------------------------------------------------
+///
+/// Define the cell size.  Removes all elements.
+///
+// --------------------------------------------------------
+
+void AccelerationHash::set( double cellsize )
+{
+    clear();
+
+    assert( cellsize > 0 );
+    m_cellsize = cellsize;
+    m_invcellsize = 1.0 / cellsize;
+}
+
+// --------------------------------------------------------
+///
+/// Generate a set of cell indices from a pair of AABB extents.  Unlike AccelerationGrid, there is no domain to clamp to.
+///
+// --------------------------------------------------------
+
+void AccelerationHash::boundstoindices( const Vec3d& xmin, const Vec3d& xmax, Vec3i& xmini, Vec3i& xmaxi ) const
+{
+    for ( unsigned int i = 0; i < 3; ++i )
+    {
+        xmini[i] = to_cell( xmin[i], m_invcellsize );
+        xmaxi[i] = to_cell( xmax[i], m_invcellsize );
+    }
+}
+
+// --------------------------------------------------------
+///
+/// Insert idx into the given range of cells
+///
+// --------------------------------------------------------
+
+void AccelerationHash::insert_into_cells( size_t idx, const Vec3i& xmini, const Vec3i& xmaxi )
+{
+    for ( int k = xmini[2]; k <= xmaxi[2]; ++k )
+    {
+        for ( int j = xmini[1]; j <= xmaxi[1]; ++j )
+        {
+            for ( int i = xmini[0]; i <= xmaxi[0]; ++i )
+            {
+                std::vector<size_t>& cell = m_cells[ cell_key( i, j, k ) ];
+                if ( cell.capacity() == 0 ) { cell.reserve( 8 ); }
+                cell.push_back( idx );
+            }
+        }
+    }
+}
+
+// --------------------------------------------------------
+///
+/// Remove idx from the given range of cells, dropping cells which become empty so memory tracks the element count
+///
+// --------------------------------------------------------
+
+void AccelerationHash::erase_from_cells( size_t idx, const Vec3i& xmini, const Vec3i& xmaxi )
+{
+    for ( int k = xmini[2]; k <= xmaxi[2]; ++k )
+    {
+        for ( int j = xmini[1]; j <= xmaxi[1]; ++j )
+        {
+            for ( int i = xmini[0]; i <= xmaxi[0]; ++i )
+            {
+                std::unordered_map<CellKey, std::vector<size_t> >::iterator cell = m_cells.find( cell_key( i, j, k ) );
+                assert( cell != m_cells.end() );
+                if ( cell == m_cells.end() ) { continue; }
+
+                std::vector<size_t>& elements = cell->second;
+                std::vector<size_t>::iterator it = std::find( elements.begin(), elements.end(), idx );
+                assert( it != elements.end() );
+                if ( it != elements.end() )
+                {
+                    *it = elements.back();
+                    elements.pop_back();
+                }
+
+                if ( elements.empty() )
+                {
+                    m_cells.erase( cell );
+                }
+            }
+        }
+    }
+}
+
+// --------------------------------------------------------
+///
+/// Add an object with the specified index and AABB to the hash
+///
+// --------------------------------------------------------
+
+void AccelerationHash::add_element( size_t idx, const Vec3d& xmin, const Vec3d& xmax )
+{
+    if ( m_elementcount <= idx )
+    {
+        m_elementcellmins.resize( idx+1 );
+        m_elementcellmaxs.resize( idx+1 );
+        m_elementstate.resize( idx+1, (unsigned char) ELEMENT_ABSENT );
+        m_elementxmins.resize( idx+1 );
+        m_elementxmaxs.resize( idx+1 );
+        m_elementcount = idx+1;
+    }
+
+    if ( m_elementstate[idx] != ELEMENT_ABSENT )
+    {
+        remove_element( idx );
+    }
+
+    m_elementxmins[idx] = xmin;
+    m_elementxmaxs[idx] = xmax;
+
+    Vec3i xmini, xmaxi;
+    boundstoindices( xmin, xmax, xmini, xmaxi );
+    m_elementcellmins[idx] = xmini;
+    m_elementcellmaxs[idx] = xmaxi;
+
+    if ( cell_count( xmini, xmaxi ) > (double) MAX_CELLS_PER_ELEMENT )
+    {
+        m_oversized.push_back( idx );
+        m_elementstate[idx] = ELEMENT_OVERSIZED;
+    }
+    else
+    {
+        insert_into_cells( idx, xmini, xmaxi );
+        m_elementstate[idx] = ELEMENT_HASHED;
+    }
+}
+
+// --------------------------------------------------------
+///
+/// Remove an object with the specified index from the hash
+///
+// --------------------------------------------------------
+
+void AccelerationHash::remove_element( size_t idx )
+{
+    if ( idx >= m_elementcount ) { return; }
+
+    if ( m_elementstate[idx] == ELEMENT_HASHED )
+    {
+        erase_from_cells( idx, m_elementcellmins[idx], m_elementcellmaxs[idx] );
+    }
+    else if ( m_elementstate[idx] == ELEMENT_OVERSIZED )
+    {
+        std::vector<size_t>::iterator it = std::find( m_oversized.begin(), m_oversized.end(), idx );
+        assert( it != m_oversized.end() );
+        if ( it != m_oversized.end() )
+        {
+            *it = m_oversized.back();
+            m_oversized.pop_back();
+        }
+    }
+
+    m_elementstate[idx] = ELEMENT_ABSENT;
+}
+
+// --------------------------------------------------------
+///
+/// Reset the specified object's AABB.  If the covered range of cells is unchanged only the stored AABB is touched.
+///
+// --------------------------------------------------------
+
+void AccelerationHash::update_element( size_t idx, const Vec3d& xmin, const Vec3d& xmax )
+{
+    if ( idx < m_elementcount && m_elementstate[idx] == ELEMENT_HASHED )
+    {
+        Vec3i xmini, xmaxi;
+        boundstoindices( xmin, xmax, xmini, xmaxi );
+
+        if ( xmini == m_elementcellmins[idx] && xmaxi == m_elementcellmaxs[idx] )
+        {
+            m_elementxmins[idx] = xmin;
+            m_elementxmaxs[idx] = xmax;
+            return;
+        }
+    }
+
+    add_element( idx, xmin, xmax );
+}
+
+// --------------------------------------------------------
+///
+/// Remove all elements from the hash
+///
+// --------------------------------------------------------
+
+void AccelerationHash::clear()
+{
+    m_cells.clear();
+    m_oversized.clear();
+    m_elementcellmins.clear();
+    m_elementcellmaxs.clear();
+    m_elementstate.clear();
+    m_elementxmins.clear();
+    m_elementxmaxs.clear();
+    m_elementcount = 0;
+}
+
+// --------------------------------------------------------
+///
+/// Append the elements of cell (i,j,k) whose AABBs overlap the query AABB.  An element is only reported from the first
+/// cell its own cell range shares with the query's, which removes duplicates without any per-query state.
+///
+// --------------------------------------------------------
+
+void AccelerationHash::gather_from_cell( const std::vector<size_t>& cell, int i, int j, int k, const Vec3i& xmini,
+                                         const Vec3d& xmin, const Vec3d& xmax, std::vector<size_t>& results ) const
+{
+    for ( std::vector<size_t>::const_iterator citer = cell.begin(); citer != cell.end(); ++citer )
+    {
+        size_t oidx = *citer;
+
+        const Vec3i& oxmini = m_elementcellmins[oidx];
+
+        if ( i != std::max( xmini[0], oxmini[0] ) || j != std::max( xmini[1], oxmini[1] ) || k != std::max( xmini[2], oxmini[2] ) )
+        {
+            continue;
+        }
+
+        const Vec3d& oxmin = m_elementxmins[oidx];
+        const Vec3d& oxmax = m_elementxmaxs[oidx];
+
+        if ( (xmin[0] <= oxmax[0] && xmin[1] <= oxmax[1] && xmin[2] <= oxmax[2]) &&
+             (xmax[0] >= oxmin[0] && xmax[1] >= oxmin[1] && xmax[2] >= oxmin[2]) )
+        {
+            results.push_back( oidx );
+        }
+    }
+}
+
+// --------------------------------------------------------
+///
+/// Return the set of elements which have AABBs overlapping the query AABB.
+///
+// --------------------------------------------------------
+
+void AccelerationHash::find_overlapping_elements( const Vec3d& xmin, const Vec3d& xmax, std::vector<size_t>& results ) const
+{
+    Vec3i xmini, xmaxi;
+    boundstoindices( xmin, xmax, xmini, xmaxi );
+
+    if ( cell_count( xmini, xmaxi ) > (double) m_cells.size() )
+    {
+        // Large queries test every stored element instead of walking the (possibly mostly empty) query range
+        for ( size_t oidx = 0; oidx < m_elementcount; ++oidx )
+        {
+            if ( m_elementstate[oidx] != ELEMENT_HASHED ) { continue; }
+
+            const Vec3d& oxmin = m_elementxmins[oidx];
+            const Vec3d& oxmax = m_elementxmaxs[oidx];
+
+            if ( (xmin[0] <= oxmax[0] && xmin[1] <= oxmax[1] && xmin[2] <= oxmax[2]) &&
+                 (xmax[0] >= oxmin[0] && xmax[1] >= oxmin[1] && xmax[2] >= oxmin[2]) )
+            {
+                results.push_back( oidx );
+            }
+        }
+    }
+    else
+    {
+        for ( int k = xmini[2]; k <= xmaxi[2]; ++k )
+        {
+            for ( int j = xmini[1]; j <= xmaxi[1]; ++j )
+            {
+                for ( int i = xmini[0]; i <= xmaxi[0]; ++i )
+                {
+                    std::unordered_map<CellKey, std::vector<size_t> >::const_iterator cell = m_cells.find( cell_key( i, j, k ) );
+                    if ( cell != m_cells.end() )
+                    {
+                        gather_from_cell( cell->second, i, j, k, xmini, xmin, xmax, results );
+                    }
+                }
+            }
+        }
+    }
+
+    for ( size_t n = 0; n < m_oversized.size(); ++n )
+    {
+        size_t oidx = m_oversized[n];
+
+        const Vec3d& oxmin = m_elementxmins[oidx];
+        const Vec3d& oxmax = m_elementxmaxs[oidx];
+
+        if ( (xmin[0] <= oxmax[0] && xmin[1] <= oxmax[1] && xmin[2] <= oxmax[2]) &&
+             (xmax[0] >= oxmin[0] && xmax[1] >= oxmin[1] && xmax[2] >= oxmin[2]) )
+        {
+            results.push_back( oidx );
+        }
+    }
+}
+
+}
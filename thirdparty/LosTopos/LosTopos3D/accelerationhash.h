@@ -0,0 +1,144 @@
+// ---------------------------------------------------------
+//
+//  accelerationhash.h
+//
+//  A sparse, hashed-grid collision test culling structure.  Only cells which actually contain elements are stored,
+//  so memory scales with the number of elements rather than with the volume of the domain.
+//
+// ---------------------------------------------------------
+
+#ifndef LOSTOPOS_ACCELERATIONHASH_H
+#define LOSTOPOS_ACCELERATIONHASH_H
+
+// ---------------------------------------------------------
+// Nested includes
+// ---------------------------------------------------------
+
+#include <unordered_map>
+#include <vec.h>
+#include <vector>
+
+// ---------------------------------------------------------
+//  Class definitions
+// ---------------------------------------------------------
+
+// --------------------------------------------------------
+///
+/// Hashed uniform grid collision culling structure
+///
+// --------------------------------------------------------
+namespace LosTopos {
+
+class AccelerationHash
+{
+
+public:
+
+    AccelerationHash();
+
+    /// Define the cell size.  Removes all elements.
+    ///
+    void set( double cellsize );
+
+    /// Generate a set of (unbounded) cell indices from a pair of AABB extents
+    ///
+    void boundstoindices( const Vec3d& xmin, const Vec3d& xmax, Vec3i& xmini, Vec3i& xmaxi ) const;
+
+    /// Add an object with the specified index and AABB to the hash
+    ///
+    void add_element( size_t idx, const Vec3d& xmin, const Vec3d& xmax );
+
+    /// Remove an object with the specified index from the hash
+    ///
+    void remove_element( size_t idx );
+
+    /// Reset the specified object's AABB
+    ///
+    void update_element( size_t idx, const Vec3d& xmin, const Vec3d& xmax );
+
+    /// Remove all elements from the hash
+    ///
+    void clear();
+
+    /// Return the set of elements which have AABBs overlapping the query AABB.  Each element is reported once, without any 
+    /// per-query state, so concurrent queries are safe as long as nobody modifies the hash.
+    ///
+    void find_overlapping_elements( const Vec3d& xmin, const Vec3d& xmax, std::vector<size_t>& results ) const;
+
+    /// Number of non-empty cells currently stored
+    ///
+    size_t num_occupied_cells() const { return m_cells.size(); }
+
+    /// Elements covering more than this many cells are kept in a separate list instead of being hashed into every cell
+    ///
+    static const size_t MAX_CELLS_PER_ELEMENT = 512;
+
+    /// Hash key of a cell
+    ///
+    typedef unsigned long long CellKey;
+
+    /// Pack a cell index triple into a hash key
+    ///
+    static CellKey cell_key( int i, int j, int k );
+
+    /// Occupied cells, each containing the indices of the elements whose AABBs overlap the cell
+    ///
+    std::unordered_map<CellKey, std::vector<size_t> > m_cells;
+
+    /// Elements too large to be hashed cell by cell; tested against every query
+    ///
+    std::vector<size_t> m_oversized;
+
+    /// For each element, the range of cells it was inserted into
+    ///
+    std::vector<Vec3i> m_elementcellmins, m_elementcellmaxs;
+
+    /// For each element, whether it is currently stored (0 = absent, 1 = hashed, 2 = oversized)
+    ///
+    std::vector<unsigned char> m_elementstate;
+
+    /// Element AABBs
+    ///
+    std::vector<Vec3d> m_elementxmins, m_elementxmaxs;
+
+    /// Cell dimension and its inverse
+    ///
+    double m_cellsize, m_invcellsize;
+
+    /// Number of element slots (one past the largest index ever added)
+    ///
+    size_t m_elementcount;
+
+private:
+
+    /// Insert idx into the given range of cells
+    ///
+    void insert_into_cells( size_t idx, const Vec3i& xmini, const Vec3i& xmaxi );
+
+    /// Remove idx from the given range of cells, dropping cells which become empty
+    ///
+    void erase_from_cells( size_t idx, const Vec3i& xmini, const Vec3i& xmaxi );
+
+    /// Append the elements of cell (i,j,k) whose AABBs overlap the query AABB and for which this is the first cell shared
+    /// with the query cell range [xmini, xmaxi]
+    ///
+    void gather_from_cell( const std::vector<size_t>& cell, int i, int j, int k, const Vec3i& xmini, 
+                           const Vec3d& xmin, const Vec3d& xmax, std::vector<size_t>& results ) const;
+
+};
+
+// --------------------------------------------------------
+///
+/// Pack a cell index triple into a hash key, 21 bits per axis
+///
+// --------------------------------------------------------
+
+inline AccelerationHash::CellKey AccelerationHash::cell_key( int i, int j, int k )
+{
+    const CellKey mask = ( (CellKey)1 << 21 ) - 1;
+    return ( ( (CellKey)(unsigned int)i & mask ) << 42 ) | ( ( (CellKey)(unsigned int)j & mask ) << 21 ) | ( (CellKey)(unsigned int)k & mask );
+}
+
+}
+
+#endif
@@ -5,8 +5,8 @@
 //  Christopher Batty, Fang Da 2014
 //
 //  Interface for abstract broad phase collision detector class.  The main function of a broad phase is to avoid performing 
-//  collision detection between all primitives. Abstract so we can try different strategies, however only BroadPhaseGrid is 
-//  currently implemented.
+//  collision detection between all primitives. Abstract so we can try different strategies: BroadPhaseGrid uses dense 
+//  regular grids, BroadPhaseHash uses sparse hashed grids.
 //
 // ---------------------------------------------------------
 
@@ -105,23 +105,26 @@ public:
     
     /// Get the stored axis-aligned bounding box of a vertex
     ///
-    virtual void get_vertex_aabb( size_t index, bool is_solid, Vec3d& aabb_low, Vec3d& aabb_high ) = 0;
+    virtual void get_vertex_aabb( size_t index, bool is_solid, Vec3d& aabb_low, Vec3d& aabb_high ) const = 0;
     
     /// Get the stored axis-aligned bounding box of an edge
     ///    
-    virtual void get_edge_aabb( size_t index, bool is_solid, Vec3d& aabb_low, Vec3d& aabb_high ) = 0;
+    virtual void get_edge_aabb( size_t index, bool is_solid, Vec3d& aabb_low, Vec3d& aabb_high ) const = 0;
     
     /// Get the stored axis-aligned bounding box of a triangle
     ///        
-    virtual void get_triangle_aabb( size_t index, bool is_solid, Vec3d& aabb_low, Vec3d& aabb_high ) = 0;
+    virtual void get_triangle_aabb( size_t index, bool is_solid, Vec3d& aabb_low, Vec3d& aabb_high ) const = 0;
     
-    /// Get the set of vertices whose bounding volumes overlap the specified bounding volume
+    /// Get the set of vertices whose bounding volumes overlap the specified bounding volume.
+    ///
+    /// The get_potential_*_collisions queries keep no per-query state, so they may be called concurrently from several
+    /// threads as long as no thread adds, updates or removes elements at the same time.
     ///
     virtual void get_potential_vertex_collisions( const Vec3d& aabb_low, 
                                                  const Vec3d& aabb_high,
                                                  bool return_solid,
                                                  bool return_dynamic,
-                                                 std::vector<size_t>& overlapping_vertices ) = 0;
+                                                 std::vector<size_t>& overlapping_vertices ) const = 0;
     
     /// Get the set of edges whose bounding volumes overlap the specified bounding volume
     ///
@@ -129,7 +132,7 @@ public:
                                                const Vec3d& aabb_high, 
                                                bool return_solid,
                                                bool return_dynamic,
-                                               std::vector<size_t>& overlapping_edges ) = 0;
+                                               std::vector<size_t>& overlapping_edges ) const = 0;
     
     /// Get the set of triangles whose bounding volumes overlap the specified bounding volume
     ///
@@ -137,7 +140,7 @@ public:
                                                    const Vec3d& aabb_high,
                                                    bool return_solid,
                                                    bool return_dynamic,
-                                                   std::vector<size_t>& overlapping_triangles ) = 0;
+                                                   std::vector<size_t>& overlapping_triangles ) const = 0;
     
 };
 
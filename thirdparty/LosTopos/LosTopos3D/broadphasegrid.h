@@ -117,15 +117,15 @@ public:
     
     /// Get the stored axis-aligned bounding box of a vertex
     ///
-    virtual void get_vertex_aabb( size_t index, bool is_solid, Vec3d& aabb_low, Vec3d& aabb_high );
+    virtual void get_vertex_aabb( size_t index, bool is_solid, Vec3d& aabb_low, Vec3d& aabb_high ) const;
     
     /// Get the stored axis-aligned bounding box of an edge
     ///
-    virtual void get_edge_aabb( size_t index, bool is_solid, Vec3d& aabb_low, Vec3d& aabb_high );
+    virtual void get_edge_aabb( size_t index, bool is_solid, Vec3d& aabb_low, Vec3d& aabb_high ) const;
     
     /// Get the stored axis-aligned bounding box of a triangle
     ///
-    virtual void get_triangle_aabb( size_t index, bool is_solid, Vec3d& aabb_low, Vec3d& aabb_high );
+    virtual void get_triangle_aabb( size_t index, bool is_solid, Vec3d& aabb_low, Vec3d& aabb_high ) const;
     
     /// Get the set of vertices whose bounding volumes overlap the specified bounding volume
     ///
@@ -133,7 +133,7 @@ public:
                                                 const Vec3d& aabb_high,
                                                 bool return_solid,
                                                 bool return_dynamic,
-                                                std::vector<size_t>& overlapping_vertices );
+                                                std::vector<size_t>& overlapping_vertices ) const;
     
     /// Get the set of edges whose bounding volumes overlap the specified bounding volume
     ///
@@ -141,7 +141,7 @@ public:
                                               const Vec3d& aabb_high, 
                                               bool return_solid,
                                               bool return_dynamic,
-                                              std::vector<size_t>& overlapping_edges );
+                                              std::vector<size_t>& overlapping_edges ) const;
     
     /// Get the set of triangles whose bounding volumes overlap the specified bounding volume
     ///
@@ -149,7 +149,7 @@ public:
                                                   const Vec3d& aabb_high,
                                                   bool return_solid,
                                                   bool return_dynamic,
-                                                  std::vector<size_t>& overlapping_triangles );
+                                                  std::vector<size_t>& overlapping_triangles ) const;
     
     /// Rebuild one of the grids
     ///
@@ -334,7 +334,7 @@ inline void BroadPhaseGrid::get_potential_vertex_collisions( const Vec3d& aabb_l
                                                             const Vec3d& aabb_high,
                                                             bool return_solid,
                                                             bool return_dynamic,
-                                                            std::vector<size_t>& overlapping_vertices )
+                                                            std::vector<size_t>& overlapping_vertices ) const
 {
     if ( return_solid )
     {
@@ -357,7 +357,7 @@ inline void BroadPhaseGrid::get_potential_edge_collisions( const Vec3d& aabb_low
                                                           const Vec3d& aabb_high,
                                                           bool return_solid,
                                                           bool return_dynamic,
-                                                          std::vector<size_t>& overlapping_edges )
+                                                          std::vector<size_t>& overlapping_edges ) const
 {
    
 
@@ -382,7 +382,7 @@ inline void BroadPhaseGrid::get_potential_triangle_collisions( const Vec3d& aabb
                                                               const Vec3d& aabb_high,
                                                               bool return_solid,
                                                               bool return_dynamic,
-                                                              std::vector<size_t>& overlapping_triangles )
+                                                              std::vector<size_t>& overlapping_triangles ) const
 {
     if ( return_solid )
     {
@@ -402,7 +402,7 @@ inline void BroadPhaseGrid::get_potential_triangle_collisions( const Vec3d& aabb
 ///
 // ---------------------------------------------------------
 
-inline void BroadPhaseGrid::get_vertex_aabb( size_t index, bool is_solid, Vec3d& aabb_low, Vec3d& aabb_high )
+inline void BroadPhaseGrid::get_vertex_aabb( size_t index, bool is_solid, Vec3d& aabb_low, Vec3d& aabb_high ) const
 {
     if ( is_solid )
     {
@@ -422,7 +422,7 @@ inline void BroadPhaseGrid::get_vertex_aabb( size_t index, bool is_solid, Vec3d&
 ///
 // ---------------------------------------------------------
 
-inline void BroadPhaseGrid::get_edge_aabb( size_t index, bool is_solid, Vec3d& aabb_low, Vec3d& aabb_high )
+inline void BroadPhaseGrid::get_edge_aabb( size_t index, bool is_solid, Vec3d& aabb_low, Vec3d& aabb_high ) const
 {
     if ( is_solid )
     {
@@ -442,7 +442,7 @@ inline void BroadPhaseGrid::get_edge_aabb( size_t index, bool is_solid, Vec3d& a
 ///
 // ---------------------------------------------------------
 
-inline void BroadPhaseGrid::get_triangle_aabb( size_t index, bool is_solid, Vec3d& aabb_low, Vec3d& aabb_high )
+inline void BroadPhaseGrid::get_triangle_aabb( size_t index, bool is_solid, Vec3d& aabb_low, Vec3d& aabb_high ) const
 {
     if ( is_solid )
     {
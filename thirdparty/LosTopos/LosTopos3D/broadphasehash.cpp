@@ -0,0 +1,114 @@
+// ---------------------------------------------------------
+//
+//  broadphasehash.cpp
+//
+//  Broad phase collision detection culling using sparse hashed grids.
+//
+// ---------------------------------------------------------
+
+// ---------------------------------------------------------
+// Includes
+// ---------------------------------------------------------
+
+#include <broadphasehash.h>
+#include <dynamicsurface.h>
+
+// ---------------------------------------------------------
+// Member function definitions
+// ---------------------------------------------------------
+
+namespace LosTopos {
+
+// --------------------------------------------------------
+///
+/// Rebuild the hashes according to the given triangle mesh.  Cells are sized by the average edge length, so the number
+/// of cells touched per element stays bounded no matter how far apart the pieces of the surface are.
+///
+// --------------------------------------------------------
+
+void BroadPhaseHash::update_broad_phase( const DynamicSurface& surface, bool continuous )
+{
+    double cell_size = surface.get_average_edge_length();
+
+    // Degenerate meshes (no edges, or collapsed edges) still need a usable cell size
+    if ( !( cell_size > 10.0 * surface.m_aabb_padding ) )
+    {
+        cell_size = 10.0 * surface.m_aabb_padding;
+    }
+
+    m_solid_vertex_hash.set( cell_size );
+    m_dynamic_vertex_hash.set( cell_size );
+    m_solid_edge_hash.set( cell_size );
+    m_dynamic_edge_hash.set( cell_size );
+    m_solid_triangle_hash.set( cell_size );
+    m_dynamic_triangle_hash.set( cell_size );
+
+    // Insert in reverse order so each hash only has to grow its per-element arrays once, and skip the inside-out
+    // AABBs of deleted elements, as BroadPhaseGrid does.
+
+    //
+    // vertices
+    //
+    for ( size_t i = surface.get_num_vertices(); i-- > 0; )
+    {
+        Vec3d xmin, xmax;
+
+        if ( continuous )
+        {
+            surface.vertex_continuous_bounds( i, xmin, xmax );
+        }
+        else
+        {
+            surface.vertex_static_bounds( i, xmin, xmax );
+        }
+
+        if ( xmin[0] > xmax[0] ) { continue; }
+
+        add_vertex( i, xmin, xmax, surface.vertex_is_all_solid( i ) );
+    }
+
+    //
+    // edges
+    //
+    for ( size_t i = surface.m_mesh.m_edges.size(); i-- > 0; )
+    {
+        Vec3d xmin, xmax;
+
+        if ( continuous )
+        {
+            surface.edge_continuous_bounds( i, xmin, xmax );
+        }
+        else
+        {
+            surface.edge_static_bounds( i, xmin, xmax );
+        }
+
+        if ( xmin[0] > xmax[0] ) { continue; }
+
+        add_edge( i, xmin, xmax, surface.edge_is_all_solid( i ) );
+    }
+
+    //
+    // triangles
+    //
+    for ( size_t i = surface.m_mesh.num_triangles(); i-- > 0; )
+    {
+        Vec3d xmin, xmax;
+
+        if ( continuous )
+        {
+            surface.triangle_continuous_bounds( i, xmin, xmax );
+        }
+        else
+        {
+            surface.triangle_static_bounds( i, xmin, xmax );
+        }
+
+        if ( xmin[0] > xmax[0] ) { continue; }
+
+        add_triangle( i, xmin, xmax, surface.triangle_is_all_solid( i ) );
+    }
+
+}
+
+}
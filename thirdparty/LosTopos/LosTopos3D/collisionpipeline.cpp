@@ -407,7 +407,10 @@ void CollisionPipeline::add_point_update_candidates( size_t v,
 
 // ---------------------------------------------------------
 ///
-/// Apply impulses to all proximal elements in the list of potentially proximal elements
+/// Apply impulses to all proximal elements in the list of potentially proximal elements.  Candidates are taken in 
+/// blocks, and the proximity queries for each block are evaluated together with the batched routines before the 
+/// impulses are applied in the original order.  Impulses only change velocities, so positions (and therefore 
+/// proximities) are unaffected by processing a block at a time.
 ///
 // ---------------------------------------------------------
 
@@ -415,172 +418,232 @@ void CollisionPipeline::process_proximity_candidates( double dt,
                                                      CollisionCandidateSet& candidates )
 {
     
-    static const double k = 10.0;
+    ProximityBatch edge_edge_batch, point_triangle_batch;
+    
+    // the valid candidates of the current block, in the order they were popped, with their slots in the batches
+    std::vector<Vec3st> block_candidates;
+    std::vector<size_t> block_slots;
+    block_candidates.reserve( PROXIMITY_BATCH_SIZE );
+    block_slots.reserve( PROXIMITY_BATCH_SIZE );
     
     while ( false == candidates.empty() )
     {
-
-       Vec3st candidate = candidates.back();
-       candidates.pop_back();
         
-        if ( candidate[2] == 1 )
+        block_candidates.clear();
+        block_slots.clear();
+        edge_edge_batch.clear();
+        point_triangle_batch.clear();
+        
+        while ( false == candidates.empty() && block_candidates.size() < PROXIMITY_BATCH_SIZE )
         {
-            // edge-edge
-            
-            Vec2st e0 = m_surface.m_mesh.m_edges[candidate[0]];
-            Vec2st e1 = m_surface.m_mesh.m_edges[candidate[1]];
+            Vec3st candidate = candidates.back();
+            candidates.pop_back();
             
-            if (e0[0] == e0[1]) { continue; }
-            if (e1[0] == e1[1]) { continue; }
-            
-            if ( e0[0] != e1[0] && e0[0] != e1[1] && e0[1] != e1[0] && e0[1] != e1[1] )
+            if ( candidate[2] == 1 )
             {
-                double distance, s0, s2;
-                Vec3d normal;
+                // edge-edge
                 
-                check_edge_edge_proximity(m_surface.get_position( e0[0] ), 
-                                          m_surface.get_position( e0[1] ), 
-                                          m_surface.get_position( e1[0] ), 
-                                          m_surface.get_position( e1[1] ),
-                                          distance, s0, s2, normal );
+                const Vec2st& e0 = m_surface.m_mesh.m_edges[candidate[0]];
+                const Vec2st& e1 = m_surface.m_mesh.m_edges[candidate[1]];
                 
-                if (distance < m_surface.m_proximity_epsilon && distance > 0)
-                {
-                    assert(mag(normal) > 0);
-                    
-                    double relvel = dot( normal,
-                                        s0 * m_surface.m_velocities[e0[0]] +
-                                        (1.0 - s0) * m_surface.m_velocities[e0[1]] -
-                                        s2 * m_surface.m_velocities[e1[0]] -
-                                        (1.0 - s2) * m_surface.m_velocities[e1[1]] );
-                    
-                    Vec3d diff = s0 * m_surface.get_position(e0[0]) + 
-                    (1.0 - s0) * m_surface.get_position(e0[1]) - 
-                    s2 * m_surface.get_position(e1[0]) - 
-                    (1.0 - s2) * m_surface.get_position(e1[1]);
-                    
-                    if ( dot( normal, diff ) < 0.0 )
-                    {
-                        continue;
-                    }
-                    
-                    double d = m_surface.m_proximity_epsilon - distance;
-                    
-                    if (relvel > 0.1 * d / dt )
-                    {
-                        continue;
-                    }
-                    
-                    double impulse1 = max( 0.0, 0.1 * d / dt - relvel );
-                    
-                    double impulse2 = dt * k * d;
-                    
-                    double impulse = min( impulse1, impulse2 );
-                    
-                    Collision proximity( true, 
-                                        Vec4st( e0[0], e0[1], e1[0], e1[1] ),
-                                        normal,
-                                        Vec4d( s0, 1.0-s0, s2, 1.0-s2 ),
-                                        dt * relvel );
-                    
-                    apply_edge_edge_impulse( proximity, impulse, dt );
-                    
-                }
+                if (e0[0] == e0[1]) { continue; }
+                if (e1[0] == e1[1]) { continue; }
+                
+                if ( e0[0] == e1[0] || e0[0] == e1[1] || e0[1] == e1[0] || e0[1] == e1[1] ) { continue; }
+                
+                block_slots.push_back( edge_edge_batch.push_back( m_surface.get_position( e0[0] ), 
+                                                                  m_surface.get_position( e0[1] ), 
+                                                                  m_surface.get_position( e1[0] ), 
+                                                                  m_surface.get_position( e1[1] ) ) );
+            }
+            else
+            {
+                // point-triangle
+                
+                const Vec3st& tri = m_surface.m_mesh.get_triangle(candidate[0]);
+                size_t v = candidate[1];
+                
+                if ( tri[0] == v || tri[1] == v || tri[2] == v ) { continue; }
+                
+                block_slots.push_back( point_triangle_batch.push_back( m_surface.get_position(v), 
+                                                                       m_surface.get_position(tri[0]),
+                                                                       m_surface.get_position(tri[1]),
+                                                                       m_surface.get_position(tri[2]) ) );
             }
             
+            block_candidates.push_back( candidate );
         }
-        else
+        
+        check_edge_edge_proximity( edge_edge_batch );
+        check_point_triangle_proximity( point_triangle_batch );
+        
+        for ( size_t i = 0; i < block_candidates.size(); ++i )
         {
-            // point-triangle
+            const Vec3st& candidate = block_candidates[i];
+            size_t slot = block_slots[i];
             
-            size_t t = candidate[0];
-            const Vec3st& tri = m_surface.m_mesh.get_triangle(t);
-            size_t v = candidate[1];
-            
-            if ( tri[0] != v && tri[1] != v && tri[2] != v )
+            if ( candidate[2] == 1 )
             {
-                double distance, s1, s2, s3;
-                Vec3d normal;
-                
-                check_point_triangle_proximity( m_surface.get_position(v), 
-                                               m_surface.get_position(tri[0]),
-                                               m_surface.get_position(tri[1]),
-                                               m_surface.get_position(tri[2]),
-                                               distance, s1, s2, s3, normal );
-                
-                if (distance == 0)
-                {
-                    double s1, s2, s3;
-                    LosTopos::Vec3d normal;
-                    double rel_disp;
-                    
-                    LosTopos::Vec3d a = m_surface.get_position(tri[0]);
-                    LosTopos::Vec3d b = m_surface.get_position(tri[1]);
-                    LosTopos::Vec3d c = m_surface.get_position(tri[2]);
-                    LosTopos::Vec3d d = m_surface.get_position(v);
-                    bool col = LosTopos::point_triangle_collision(d, d, 0, a, a, 1, b, b, 2, c, c, 3, s1, s2, s3, normal, rel_disp);
-                    std::cout << "collision = " << col << std::endl;
-                    std::cout << "s = " << s1 << " " << s2 << " " << s3 << std::endl;
-                    std::cout << "normal = " << normal << " rel_disp = " << rel_disp << std::endl;
-                    LosTopos::Vec3d x1 = a;
-                    LosTopos::Vec3d x2 = b;
-                    LosTopos::Vec3d x3 = c;
-                    LosTopos::Vec3d x0 = d;
-                    std::cout << "cross = " << cross(x3 - x2, x0 - x2) << std::endl;
-                    Vec3d dx(x3-x2);
-                    double m2=mag2(dx);
-                    double s=clamp(dot(x3-x0, dx)/m2, 0., 1.);
-                    normal=x0-(s*x2+(1-s)*x3);
-                    std::cout << "normal = " << normal << " mag = " << mag(normal) << std::endl;
-                }
-
-                
-                if ( distance < m_surface.m_proximity_epsilon && distance > 0 )
-                {
-                    assert(mag(normal) > 0);
-                    
-                    double relvel = dot(normal,
-                                        m_surface.m_velocities[v] -
-                                        ( s1 * m_surface.m_velocities[tri[0]] +
-                                         s2 * m_surface.m_velocities[tri[1]] +
-                                         s3 * m_surface.m_velocities[tri[2]] ) );
-                    
-                    Vec3d diff = m_surface.get_position(v) -
-                    ( s1 * m_surface.get_position(tri[0]) +
-                     s2 * m_surface.get_position(tri[1]) +
-                     s3 * m_surface.get_position(tri[2]) );
-                    
-                    if ( dot( normal, diff ) < 0.0 )
-                    {
-                        continue;
-                    }
-                    
-                    double d = m_surface.m_proximity_epsilon - distance;
-                    
-                    if (relvel > 0.1 * d / dt )
-                    {
-                        continue;
-                    }
-                    
-                    double impulse1 = max( 0.0, 0.1 * d / dt - relvel );
-                    
-                    double impulse2 = dt * k * d;
-                    
-                    double impulse = min( impulse1, impulse2 );
-                    
-                    Collision proximity( false, 
-                                        Vec4st( v, tri[0], tri[1], tri[2] ),
-                                        normal,
-                                        Vec4d( 1.0, s1, s2, s3 ),
-                                        dt * relvel );
-                    
-                    apply_triangle_point_impulse( proximity, impulse, dt );
-                    
-                }
+                apply_edge_edge_proximity_impulse( dt,
+                                                   m_surface.m_mesh.m_edges[candidate[0]],
+                                                   m_surface.m_mesh.m_edges[candidate[1]],
+                                                   edge_edge_batch.distance[slot],
+                                                   edge_edge_batch.s[0][slot],
+                                                   edge_edge_batch.s[1][slot],
+                                                   edge_edge_batch.get_normal(slot) );
             }
+            else
+            {
+                apply_point_triangle_proximity_impulse( dt,
+                                                        candidate[1],
+                                                        m_surface.m_mesh.get_triangle(candidate[0]),
+                                                        point_triangle_batch.distance[slot],
+                                                        point_triangle_batch.s[0][slot],
+                                                        point_triangle_batch.s[1][slot],
+                                                        point_triangle_batch.s[2][slot],
+                                                        point_triangle_batch.get_normal(slot) );
+            }
+        }
+    }
+    
+}
+
+// ---------------------------------------------------------
+///
+/// Apply a repulsion impulse to a pair of edges, given the result of their proximity query
+///
+// ---------------------------------------------------------
+
+void CollisionPipeline::apply_edge_edge_proximity_impulse( double dt, const Vec2st& e0, const Vec2st& e1, 
+                                                           double distance, double s0, double s2, const Vec3d& normal )
+{
+    static const double k = 10.0;
+    
+    if (distance < m_surface.m_proximity_epsilon && distance > 0)
+    {
+        assert(mag(normal) > 0);
+        
+        double relvel = dot( normal,
+                            s0 * m_surface.m_velocities[e0[0]] +
+                            (1.0 - s0) * m_surface.m_velocities[e0[1]] -
+                            s2 * m_surface.m_velocities[e1[0]] -
+                            (1.0 - s2) * m_surface.m_velocities[e1[1]] );
+        
+        Vec3d diff = s0 * m_surface.get_position(e0[0]) + 
+        (1.0 - s0) * m_surface.get_position(e0[1]) - 
+        s2 * m_surface.get_position(e1[0]) - 
+        (1.0 - s2) * m_surface.get_position(e1[1]);
+        
+        if ( dot( normal, diff ) < 0.0 )
+        {
+            return;
         }
+        
+        double d = m_surface.m_proximity_epsilon - distance;
+        
+        if (relvel > 0.1 * d / dt )
+        {
+            return;
+        }
+        
+        double impulse1 = max( 0.0, 0.1 * d / dt - relvel );
+        
+        double impulse2 = dt * k * d;
+        
+        double impulse = min( impulse1, impulse2 );
+        
+        Collision proximity( true, 
+                            Vec4st( e0[0], e0[1], e1[0], e1[1] ),
+                            normal,
+                            Vec4d( s0, 1.0-s0, s2, 1.0-s2 ),
+                            dt * relvel );
+        
+        apply_edge_edge_impulse( proximity, impulse, dt );
+        
+    }
+}
+
+// ---------------------------------------------------------
+///
+/// Apply a repulsion impulse to a vertex and triangle, given the result of their proximity query
+///
+// ---------------------------------------------------------
+
+void CollisionPipeline::apply_point_triangle_proximity_impulse( double dt, size_t v, const Vec3st& tri, 
+                                                                double distance, double s1, double s2, double s3, 
+                                                                const Vec3d& normal )
+{
+    static const double k = 10.0;
+    
+    if (distance == 0)
+    {
+        double s1, s2, s3;
+        LosTopos::Vec3d normal;
+        double rel_disp;
+        
+        LosTopos::Vec3d a = m_surface.get_position(tri[0]);
+        LosTopos::Vec3d b = m_surface.get_position(tri[1]);
+        LosTopos::Vec3d c = m_surface.get_position(tri[2]);
+        LosTopos::Vec3d d = m_surface.get_position(v);
+        bool col = LosTopos::point_triangle_collision(d, d, 0, a, a, 1, b, b, 2, c, c, 3, s1, s2, s3, normal, rel_disp);
+        std::cout << "collision = " << col << std::endl;
+        std::cout << "s = " << s1 << " " << s2 << " " << s3 << std::endl;
+        std::cout << "normal = " << normal << " rel_disp = " << rel_disp << std::endl;
+        LosTopos::Vec3d x1 = a;
+        LosTopos::Vec3d x2 = b;
+        LosTopos::Vec3d x3 = c;
+        LosTopos::Vec3d x0 = d;
+        std::cout << "cross = " << cross(x3 - x2, x0 - x2) << std::endl;
+        Vec3d dx(x3-x2);
+        double m2=mag2(dx);
+        double s=clamp(dot(x3-x0, dx)/m2, 0., 1.);
+        normal=x0-(s*x2+(1-s)*x3);
+        std::cout << "normal = " << normal << " mag = " << mag(normal) << std::endl;
     }
+
     
+    if ( distance < m_surface.m_proximity_epsilon && distance > 0 )
+    {
+        assert(mag(normal) > 0);
+        
+        double relvel = dot(normal,
+                            m_surface.m_velocities[v] -
+                            ( s1 * m_surface.m_velocities[tri[0]] +
+                             s2 * m_surface.m_velocities[tri[1]] +
+                             s3 * m_surface.m_velocities[tri[2]] ) );
+        
+        Vec3d diff = m_surface.get_position(v) -
+        ( s1 * m_surface.get_position(tri[0]) +
+         s2 * m_surface.get_position(tri[1]) +
+         s3 * m_surface.get_position(tri[2]) );
+        
+        if ( dot( normal, diff ) < 0.0 )
+        {
+            return;
+        }
+        
+        double d = m_surface.m_proximity_epsilon - distance;
+        
+        if (relvel > 0.1 * d / dt )
+        {
+            return;
+        }
+        
+        double impulse1 = max( 0.0, 0.1 * d / dt - relvel );
+        
+        double impulse2 = dt * k * d;
+        
+        double impulse = min( impulse1, impulse2 );
+        
+        Collision proximity( false, 
+                            Vec4st( v, tri[0], tri[1], tri[2] ),
+                            normal,
+                            Vec4d( 1.0, s1, s2, s3 ),
+                            dt * relvel );
+        
+        apply_triangle_point_impulse( proximity, impulse, dt );
+        
+    }
 }
 
 // ---------------------------------------------------------
@@ -227,6 +227,17 @@ private:
     void process_proximity_candidates( double dt,
                                       CollisionCandidateSet& candidates );
     
+    /// Apply a repulsion impulse to a pair of edges, given the result of their proximity query
+    ///
+    void apply_edge_edge_proximity_impulse( double dt, const Vec2st& e0, const Vec2st& e1, 
+                                            double distance, double s0, double s2, const Vec3d& normal );
+    
+    /// Apply a repulsion impulse to a vertex and triangle, given the result of their proximity query
+    ///
+    void apply_point_triangle_proximity_impulse( double dt, size_t v, const Vec3st& tri, 
+                                                 double distance, double s1, double s2, double s3, 
+                                                 const Vec3d& normal );
+    
     /// Test dynamic points vs. solid triangles for proximities, and apply repulsion forces
     /// 
     void dynamic_point_vs_solid_triangle_proximities(double dt);
@@ -15,6 +15,7 @@
 #include <dynamicsurface.h>
 
 #include <broadphasegrid.h>
+#include <broadphasehash.h>
 #include <cassert>
 #include <ccd_wrapper.h>
 #include <collisionpipeline.h>
@@ -64,13 +65,15 @@ DynamicSurface::DynamicSurface( const std::vector<Vec3d>& vertex_positions,
                                double in_proximity_epsilon,
                                double in_friction_coefficient,
                                bool in_collision_safety,
-                               bool in_verbose ) :
+                               bool in_verbose,
+                               bool in_use_hashed_broad_phase ) :
 m_proximity_epsilon( in_proximity_epsilon ),
 m_verbose( in_verbose ),   
 m_collision_safety( in_collision_safety ),
+m_localized_rollback( false ),
 m_masses( masses ), 
 m_mesh(), 
-m_broad_phase( new BroadPhaseGrid() ),
+m_broad_phase( in_use_hashed_broad_phase ? static_cast<BroadPhase*>( new BroadPhaseHash() ) : static_cast<BroadPhase*>( new BroadPhaseGrid() ) ),
 m_collision_pipeline( NULL ),    // allocated and initialized in the constructor body
 m_aabb_padding( max( in_proximity_epsilon, 1e-4 ) ),
 m_feature_edge_angle_threshold(M_PI/6),
@@ -740,6 +743,84 @@ int DynamicSurface::get_region_containing_point( const Vec3d& p )
 
 }
 
+// ---------------------------------------------------------
+///
+/// Collect the vertices within ROLLBACK_REGION_RINGS edges of the given vertices.  Scaling back a slightly larger 
+/// region than the offending elements themselves gives the neighbouring elements room to move out of the way.
+///
+// ---------------------------------------------------------
+
+void DynamicSurface::get_rollback_region( const std::vector<size_t>& seed_vertices, std::vector<bool>& in_region ) const
+{
+    static const unsigned int ROLLBACK_REGION_RINGS = 2;
+    
+    in_region.assign( get_num_vertices(), false );
+    
+    std::vector<size_t> front;
+    for ( size_t i = 0; i < seed_vertices.size(); ++i )
+    {
+        if ( !in_region[seed_vertices[i]] )
+        {
+            in_region[seed_vertices[i]] = true;
+            front.push_back( seed_vertices[i] );
+        }
+    }
+    
+    for ( unsigned int ring = 0; ring < ROLLBACK_REGION_RINGS; ++ring )
+    {
+        std::vector<size_t> next_front;
+        for ( size_t i = 0; i < front.size(); ++i )
+        {
+            const std::vector<size_t>& incident_edges = m_mesh.m_vertex_to_edge_map[front[i]];
+            for ( size_t e = 0; e < incident_edges.size(); ++e )
+            {
+                const Vec2st& edge = m_mesh.m_edges[incident_edges[e]];
+                size_t other = ( edge[0] == front[i] ) ? edge[1] : edge[0];
+                if ( !in_region[other] )
+                {
+                    in_region[other] = true;
+                    next_front.push_back( other );
+                }
+            }
+        }
+        front.swap( next_front );
+    }
+}
+
+// ---------------------------------------------------------
+///
+/// Halve the motion of the region around the given vertices, and restore everything else to its full predicted 
+/// motion, ready for collision handling to be redone.
+///
+// ---------------------------------------------------------
+
+void DynamicSurface::local_rollback( const std::vector<size_t>& offending_vertices, 
+                                     const std::vector<Vec3d>& saved_predicted_positions,
+                                     std::vector<double>& motion_fraction )
+{
+    std::vector<bool> in_region;
+    get_rollback_region( offending_vertices, in_region );
+    
+    size_t region_size = 0;
+    for ( size_t i = 0; i < get_num_vertices(); ++i )
+    {
+        if ( in_region[i] )
+        {
+            motion_fraction[i] *= 0.5;
+            ++region_size;
+        }
+        set_newposition( i, get_position(i) + motion_fraction[i] * ( saved_predicted_positions[i] - get_position(i) ) );
+    }
+    
+    if ( m_verbose )
+    {
+        std::cout << "scaling back motion of " << region_size << " vertices" << std::endl;
+    }
+    
+    g_stats.add_to_int( "DynamicSurface:local_rollbacks", 1 );
+    g_stats.add_to_int( "DynamicSurface:local_rollback_vertices", region_size );
+}
+
 // ---------------------------------------------------------
 ///
 /// Advance mesh by one time step 
@@ -771,6 +852,14 @@ void DynamicSurface::integrate( double desired_dt, double& actual_dt )
     
     const std::vector<Vec3d> saved_predicted_positions = get_newpositions();
     
+    // With localized rollback, each vertex covers this fraction of its predicted motion.  Regions which fail collision 
+    // handling have their fraction halved while the rest of the mesh keeps its full motion; only after 
+    // MAX_LOCAL_ROLLBACKS such retreats (or a failure that can't be localized) is the whole time step cut.
+    
+    static const unsigned int MAX_LOCAL_ROLLBACKS = 4;
+    unsigned int num_local_rollbacks = 0;
+    std::vector<double> motion_fraction( get_num_vertices(), 1.0 );
+    
     while ( !success )
     {
         
@@ -822,12 +911,24 @@ void DynamicSurface::integrate( double desired_dt, double& actual_dt )
             {
                 // back up and try again:
                 
+                if ( m_localized_rollback && num_local_rollbacks < MAX_LOCAL_ROLLBACKS && !impactZoneSolver.get_unsolved_vertices().empty() )
+                {
+                    local_rollback( impactZoneSolver.get_unsolved_vertices(), saved_predicted_positions, motion_fraction );
+                    ++num_local_rollbacks;
+                    continue;
+                }
+                
                 curr_dt = 0.5 * curr_dt;
                 for ( size_t i = 0; i < get_num_vertices(); ++i )
                 {
                     set_newposition(i, get_position(i) + 0.5 * (saved_predicted_positions[i] - get_position(i)) ) ;
                 }
                 
+                g_stats.add_to_int( "DynamicSurface:global_rollbacks", 1 );
+                
+                // the per-vertex motion fractions no longer apply once the whole step has been cut
+                num_local_rollbacks = MAX_LOCAL_ROLLBACKS;
+                
                 continue;      
             }
             
@@ -846,6 +947,30 @@ void DynamicSurface::integrate( double desired_dt, double& actual_dt )
                     assert( false );
                 }
                 
+                if ( m_localized_rollback && num_local_rollbacks < MAX_LOCAL_ROLLBACKS )
+                {
+                    if ( m_verbose )
+                    {
+                        std::cout << "Intersection in predicted mesh, scaling back motion around " << intersections.size() << " intersections." << std::endl;
+                    }
+                    
+                    std::vector<size_t> intersecting_vertices;
+                    for ( size_t i = 0; i < intersections.size(); ++i )
+                    {
+                        const Vec2st& edge = m_mesh.m_edges[intersections[i].m_edge_index];
+                        const Vec3st& tri = m_mesh.get_triangle( intersections[i].m_triangle_index );
+                        intersecting_vertices.push_back( edge[0] );
+                        intersecting_vertices.push_back( edge[1] );
+                        intersecting_vertices.push_back( tri[0] );
+                        intersecting_vertices.push_back( tri[1] );
+                        intersecting_vertices.push_back( tri[2] );
+                    }
+                    
+                    local_rollback( intersecting_vertices, saved_predicted_positions, motion_fraction );
+                    ++num_local_rollbacks;
+                    continue;
+                }
+                
                 if ( m_verbose )
                 {
                     std::cout << "Intersection in predicted mesh, cutting timestep." << std::endl;
@@ -859,6 +984,11 @@ void DynamicSurface::integrate( double desired_dt, double& actual_dt )
                     set_newposition( i, get_position(i) + 0.5 * ( saved_predicted_positions[i] - get_position(i) ) );
                 }
                 
+                g_stats.add_to_int( "DynamicSurface:global_rollbacks", 1 );
+                
+                // the per-vertex motion fractions no longer apply once the whole step has been cut
+                num_local_rollbacks = MAX_LOCAL_ROLLBACKS;
+                
                 continue;      
                 
             }                 
@@ -884,6 +1014,14 @@ void DynamicSurface::integrate( double desired_dt, double& actual_dt )
     static unsigned int step = 0;
     g_stats.add_per_frame_double( "DynamicSurface:integration_time_per_timestep", step, end_time - start_time );
     ++step;
+    
+    // cumulative hit rates of the floating-point filter in front of the exact CCD tests
+    g_stats.set_int( "CCD:point_triangle_tests", get_ccd_filter_counter( CCD_POINT_TRIANGLE_TESTS ) );
+    g_stats.set_int( "CCD:point_triangle_bounds_rejects", get_ccd_filter_counter( CCD_POINT_TRIANGLE_BOUNDS_REJECTS ) );
+    g_stats.set_int( "CCD:point_triangle_coplanarity_rejects", get_ccd_filter_counter( CCD_POINT_TRIANGLE_COPLANARITY_REJECTS ) );
+    g_stats.set_int( "CCD:edge_edge_tests", get_ccd_filter_counter( CCD_EDGE_EDGE_TESTS ) );
+    g_stats.set_int( "CCD:edge_edge_bounds_rejects", get_ccd_filter_counter( CCD_EDGE_EDGE_BOUNDS_REJECTS ) );
+    g_stats.set_int( "CCD:edge_edge_coplanarity_rejects", get_ccd_filter_counter( CCD_EDGE_EDGE_COPLANARITY_REJECTS ) );
 	if(m_verbose) std::cout << "Done integrating\n";
     
 }
@@ -1550,13 +1688,16 @@ void DynamicSurface::check_continuous_broad_phase_is_up_to_date() const
                 std::cout << "query_overlaps_broadphase_aabb: " << query_overlaps_broadphase_aabb << std::endl;
                 
                 
-                BroadPhaseGrid* grid_bf = static_cast<BroadPhaseGrid*>(m_broad_phase);
+                BroadPhaseGrid* grid_bf = dynamic_cast<BroadPhaseGrid*>(m_broad_phase);
                 
-                const std::vector<Vec3st>& cells = grid_bf->m_dynamic_vertex_grid.m_elementidxs[ brute_force_overlapping_vertices[k] ];
-                std::cout << "cells: " << std::endl;
-                for ( size_t m = 0; m < cells.size(); ++m )
+                if ( grid_bf != NULL )
                 {
-                    std::cout << cells[m] << std::endl;
+                    const std::vector<Vec3st>& cells = grid_bf->m_dynamic_vertex_grid.m_elementidxs[ brute_force_overlapping_vertices[k] ];
+                    std::cout << "cells: " << std::endl;
+                    for ( size_t m = 0; m < cells.size(); ++m )
+                    {
+                        std::cout << cells[m] << std::endl;
+                    }
                 }
                 
             }
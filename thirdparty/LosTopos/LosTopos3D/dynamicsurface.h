@@ -87,7 +87,8 @@ public:
        double in_proximity_epsilon = 1e-4,
        double in_friction_coefficient = 0.0,
        bool in_collision_safety = true,
-       bool in_verbose = false );
+       bool in_verbose = false,
+       bool in_use_hashed_broad_phase = false );
     
     /// Destructor
     /// 
@@ -109,6 +110,18 @@ public:
     /// 
     virtual void integrate( double dt, double& actual_dt );
 
+    /// Collect the vertices within a few edges of the given vertices, i.e. the connected region around them which is 
+    /// scaled back by a localized rollback.
+    ///
+    void get_rollback_region( const std::vector<size_t>& seed_vertices, std::vector<bool>& in_region ) const;
+
+    /// Halve the motion of the region around the given vertices, restoring all other vertices to their full predicted 
+    /// motion.  motion_fraction holds the fraction of its predicted motion each vertex currently covers.
+    ///
+    void local_rollback( const std::vector<size_t>& offending_vertices, 
+                         const std::vector<Vec3d>& saved_predicted_positions,
+                         std::vector<double>& motion_fraction );
+
     //
     // Utility
     //
@@ -433,6 +446,11 @@ public:
     ///
     bool m_collision_safety;
     
+    /// When collision handling fails during integration, scale back the motion of the offending regions only, rather 
+    /// than halving the time step for the whole mesh
+    ///
+    bool m_localized_rollback;
+    
     /// Vertex positions, predicted locations, velocities and masses
     ///
     std::vector<Vec3d> m_masses;
@@ -13,6 +13,7 @@
 #include <broadphase.h>
 #include <collisionpipeline.h>
 #include <collisionqueries.h>
+#include <edgepriorityqueue.h>
 #include <nondestructivetrimesh.h>
 #include <runstats.h>
 #include <subdivisionscheme.h>
@@ -1058,15 +1059,21 @@ bool EdgeCollapser::edge_is_collapsible( size_t edge_index, double& current_leng
     }
     
     current_length = m_surf.get_edge_length(edge_index);
+    
+    // local bounds, from the sizing field if there is one
+    double length_scale = m_surf.get_edge_length_scale(edge_index);
+    double min_edge_length = m_min_edge_length * length_scale;
+    double max_edge_length = m_max_edge_length * length_scale;
+    
     if ( m_use_curvature )
     {
         
         //collapse if we're below the lower limit
-        if(current_length < m_min_edge_length) 
+        if(current_length < min_edge_length) 
             return true;
         
         //don't collapse if we're near the upper limit, since it can produce edges above the limit
-        if(current_length > m_max_edge_length*0.5)
+        if(current_length > max_edge_length*0.5)
             return false;
         
         //check all incident edges to see if any of them are super short, and if so, split this guy accordingly.
@@ -1098,7 +1105,7 @@ bool EdgeCollapser::edge_is_collapsible( size_t edge_index, double& current_leng
     }
     else
     {
-        return current_length < m_min_edge_length;  
+        return current_length < min_edge_length;  
     }
     
     
@@ -1174,6 +1181,102 @@ bool EdgeCollapser::collapse_pass()
     
 }
 
+// --------------------------------------------------------
+///
+/// Collapse all short edges, keeping the candidates in a priority queue which is updated around the surviving vertex 
+/// of each collapse instead of rescanning every edge.  Runs to the same fixed point as repeated collapse_pass() calls: 
+/// edges which failed to collapse are retried only if some other collapse has succeeded since.
+///
+// --------------------------------------------------------
+
+bool EdgeCollapser::collapse_pass_queued()
+{
+    
+    if ( m_surf.m_verbose )
+    {
+        std::cout << "\n\n\n---------------------- EdgeCollapser: queued collapsing ----------------------" << std::endl;
+        std::cout << "m_min_edge_length: " << m_min_edge_length;
+        std::cout << ", m_use_curvature: " << m_use_curvature;
+        std::cout << ", m_min_curvature_multiplier: " << m_min_curvature_multiplier << std::endl;
+        std::cout << "m_surf.m_collision_safety: " << m_surf.m_collision_safety << std::endl;
+    }
+    
+    bool collapse_occurred = false;
+    
+    assert( m_surf.m_dirty_triangles.size() == 0 );
+    
+    NonDestructiveTriMesh& mesh = m_surf.m_mesh;
+    EdgePriorityQueue queue( false );
+    
+    // edge_is_collapsible() does not report the length for small-angle candidates, so key on the actual length
+    double dummy;
+    for( size_t i = 0; i < mesh.m_edges.size(); i++ )
+    {    
+        if(edge_is_collapsible(i, dummy)) 
+            queue.push( i, m_surf.get_edge_length(i) );
+    }
+    
+    std::vector<size_t> failed_edges;
+    std::vector<size_t> nearby_edges;
+    size_t collapses_since_retry = 0;
+    
+    for ( ;; )
+    {
+        size_t e;
+        double queued_length;
+        while ( queue.pop( e, queued_length ) )
+        {
+            if ( !edge_is_collapsible(e, dummy) ) { continue; }
+            
+            // the edge changed after it was queued: put it back in its proper place
+            double current_length = m_surf.get_edge_length(e);
+            if ( current_length != queued_length )
+            {
+                queue.push( e, current_length );
+                continue;
+            }
+            
+            size_t vertex_a = mesh.m_edges[e][0];
+            size_t vertex_b = mesh.m_edges[e][1];
+            
+            if ( !collapse_edge( e ) )
+            {
+                failed_edges.push_back( e );
+                continue;
+            }
+            
+            collapse_occurred = true;
+            g_stats.add_to_int( "EdgeCollapser:queued_collapses", 1 );
+            ++collapses_since_retry;
+            
+            size_t vertex_kept = mesh.vertex_is_deleted( vertex_a ) ? vertex_b : vertex_a;
+            if ( mesh.vertex_is_deleted( vertex_kept ) ) { continue; }
+            
+            EdgePriorityQueue::get_edges_near_vertex( mesh, vertex_kept, nearby_edges );
+            for ( size_t i = 0; i < nearby_edges.size(); ++i )
+            {
+                if ( edge_is_collapsible(nearby_edges[i], dummy) )
+                    queue.push( nearby_edges[i], m_surf.get_edge_length(nearby_edges[i]) );
+            }
+        }
+        
+        if ( failed_edges.empty() || collapses_since_retry == 0 ) { break; }
+        
+        // the mesh has changed since these failed, so they may succeed now
+        g_stats.add_to_int( "EdgeCollapser:queued_collapse_retries", failed_edges.size() );
+        for ( size_t i = 0; i < failed_edges.size(); ++i )
+        {
+            if ( edge_is_collapsible(failed_edges[i], dummy) )
+                queue.push( failed_edges[i], m_surf.get_edge_length(failed_edges[i]) );
+        }
+        failed_edges.clear();
+        collapses_since_retry = 0;
+    }
+    
+    return collapse_occurred;
+    
+}
+
 bool EdgeCollapser::collapse_will_produce_irregular_junction(size_t edge)
 {
     NonDestructiveTriMesh & mesh = m_surf.m_mesh;
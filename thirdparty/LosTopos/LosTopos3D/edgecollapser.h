@@ -53,6 +53,10 @@ public:
     ///
     bool collapse_pass();
     
+    /// Collapse all short edges using a locally updated priority queue of candidates.  Runs to completion in one call.
+    ///
+    bool collapse_pass_queued();
+    
     
     /// Minimum edge length.  Edges shorter than this will be collapsed.
     ///
@@ -0,0 +1,163 @@
+// ---------------------------------------------------------
+//
+//  edgepriorityqueue.cpp
+//
+//  Priority queue of candidate edges for the incremental remeshing passes.
+//
+// ---------------------------------------------------------
+
+// ---------------------------------------------------------
+// Includes
+// ---------------------------------------------------------
+
+#include <edgepriorityqueue.h>
+
+#include <algorithm>
+#include <cassert>
+#include <nondestructivetrimesh.h>
+
+// ---------------------------------------------------------
+// Member function definitions
+// ---------------------------------------------------------
+
+namespace LosTopos {
+
+// --------------------------------------------------------
+///
+/// Constructor
+///
+// --------------------------------------------------------
+
+EdgePriorityQueue::EdgePriorityQueue( bool longest_first ) :
+m_heap(),
+m_queued(),
+m_longest_first( longest_first )
+{}
+
+// --------------------------------------------------------
+///
+/// Queue an edge with the given length.  Does nothing if the edge is already queued.
+///
+// --------------------------------------------------------
+
+void EdgePriorityQueue::push( size_t edge_index, double length )
+{
+    if ( edge_index >= m_queued.size() )
+    {
+        m_queued.resize( edge_index + 1, 0 );
+    }
+
+    if ( m_queued[edge_index] ) { return; }
+    m_queued[edge_index] = 1;
+
+    Entry entry;
+    entry.m_length = length;
+    entry.m_edge_index = edge_index;
+    m_heap.push_back( entry );
+    sift_up( m_heap.size() - 1 );
+}
+
+// --------------------------------------------------------
+///
+/// Remove the highest priority edge.  Returns false if the queue is empty.
+///
+// --------------------------------------------------------
+
+bool EdgePriorityQueue::pop( size_t& edge_index, double& length )
+{
+    if ( m_heap.empty() ) { return false; }
+
+    edge_index = m_heap[0].m_edge_index;
+    length = m_heap[0].m_length;
+    m_queued[edge_index] = 0;
+
+    m_heap[0] = m_heap.back();
+    m_heap.pop_back();
+    if ( !m_heap.empty() )
+    {
+        sift_down( 0 );
+    }
+
+    return true;
+}
+
+// --------------------------------------------------------
+///
+/// Remove all edges
+///
+// --------------------------------------------------------
+
+void EdgePriorityQueue::clear()
+{
+    m_heap.clear();
+    m_queued.clear();
+}
+
+// --------------------------------------------------------
+///
+/// Move entry i towards the root until the heap property holds
+///
+// --------------------------------------------------------
+
+void EdgePriorityQueue::sift_up( size_t i )
+{
+    Entry entry = m_heap[i];
+    while ( i > 0 )
+    {
+        size_t parent = ( i - 1 ) / 2;
+        if ( !lower_priority( m_heap[parent], entry ) ) { break; }
+        m_heap[i] = m_heap[parent];
+        i = parent;
+    }
+    m_heap[i] = entry;
+}
+
+// --------------------------------------------------------
+///
+/// Move entry i towards the leaves until the heap property holds
+///
+// --------------------------------------------------------
+
+void EdgePriorityQueue::sift_down( size_t i )
+{
+    const size_t n = m_heap.size();
+    Entry entry = m_heap[i];
+    for ( ;; )
+    {
+        size_t child = 2 * i + 1;
+        if ( child >= n ) { break; }
+        if ( child + 1 < n && lower_priority( m_heap[child], m_heap[child+1] ) ) { ++child; }
+        if ( !lower_priority( entry, m_heap[child] ) ) { break; }
+        m_heap[i] = m_heap[child];
+        i = child;
+    }
+    m_heap[i] = entry;
+}
+
+// --------------------------------------------------------
+///
+/// Get the edges incident to the given vertex and to each of its neighbours.  Edge lengths, incident angles and the
+/// curvature and grading terms of the split and collapse criteria all depend only on this neighbourhood.
+///
+// --------------------------------------------------------
+
+void EdgePriorityQueue::get_edges_near_vertex( const NonDestructiveTriMesh& mesh, size_t vertex_index, std::vector<size_t>& edges )
+{
+    edges.clear();
+
+    const std::vector<size_t>& incident_edges = mesh.m_vertex_to_edge_map[vertex_index];
+    for ( size_t i = 0; i < incident_edges.size(); ++i )
+    {
+        size_t e = incident_edges[i];
+        edges.push_back( e );
+
+        size_t neighbour = mesh.m_edges[e][0] == vertex_index ? mesh.m_edges[e][1] : mesh.m_edges[e][0];
+        const std::vector<size_t>& neighbour_edges = mesh.m_vertex_to_edge_map[neighbour];
+        edges.insert( edges.end(), neighbour_edges.begin(), neighbour_edges.end() );
+    }
+
+    std::sort( edges.begin(), edges.end() );
+    edges.erase( std::unique( edges.begin(), edges.end() ), edges.end() );
+}
+
+}
@@ -0,0 +1,107 @@
+// ---------------------------------------------------------
+//
+//  edgepriorityqueue.h
+//
+//  Priority queue of candidate edges for the incremental remeshing passes.  Candidates are keyed by edge length and
+//  re-queued locally as operations modify the mesh, instead of rescanning and re-sorting every edge on each pass.
+//
+// ---------------------------------------------------------
+
+#ifndef LOSTOPOS_EDGEPRIORITYQUEUE_H
+#define LOSTOPOS_EDGEPRIORITYQUEUE_H
+
+// ---------------------------------------------------------
+//  Nested includes
+// ---------------------------------------------------------
+
+#include <cstddef>
+#include <vector>
+
+// ---------------------------------------------------------
+//  Forwards and typedefs
+// ---------------------------------------------------------
+
+namespace LosTopos {
+
+class NonDestructiveTriMesh;
+
+// ---------------------------------------------------------
+//  Class definitions
+// ---------------------------------------------------------
+
+// ---------------------------------------------------------
+///
+/// Binary heap of (length, edge) pairs.  An edge is held at most once; its key is not updated in place, so callers must
+/// re-evaluate each popped edge and push it again if its length has changed since it was queued.
+///
+// ---------------------------------------------------------
+
+class EdgePriorityQueue
+{
+
+public:
+
+    /// Constructor.  If longest_first is set, pop() returns the longest queued edge, otherwise the shortest.
+    ///
+    explicit EdgePriorityQueue( bool longest_first );
+
+    /// Queue an edge with the given length.  Does nothing if the edge is already queued.
+    ///
+    void push( size_t edge_index, double length );
+
+    /// Remove the highest priority edge.  Returns false if the queue is empty.
+    ///
+    bool pop( size_t& edge_index, double& length );
+
+    /// Whether any edges are queued
+    ///
+    bool empty() const { return m_heap.empty(); }
+
+    /// Number of queued edges
+    ///
+    size_t size() const { return m_heap.size(); }
+
+    /// Remove all edges
+    ///
+    void clear();
+
+    /// Get the edges whose split or collapse criteria may change when the given vertex or its one-ring is modified: the
+    /// edges incident to the vertex and to each of its neighbours.  Output is sorted and unique.
+    ///
+    static void get_edges_near_vertex( const NonDestructiveTriMesh& mesh, size_t vertex_index, std::vector<size_t>& edges );
+
+private:
+
+    struct Entry
+    {
+        double m_length;
+        size_t m_edge_index;
+    };
+
+    /// Heap ordering: true if a should be popped after b
+    ///
+    bool lower_priority( const Entry& a, const Entry& b ) const
+    {
+        return m_longest_first ? ( a.m_length < b.m_length ) : ( a.m_length > b.m_length );
+    }
+
+    void sift_up( size_t i );
+    void sift_down( size_t i );
+
+    /// Heap storage
+    ///
+    std::vector<Entry> m_heap;
+
+    /// Per-edge flag, set while the edge is in the heap
+    ///
+    std::vector<unsigned char> m_queued;
+
+    /// Pop order
+    ///
+    bool m_longest_first;
+
+};
+
+}
+
+#endif
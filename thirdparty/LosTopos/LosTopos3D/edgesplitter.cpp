@@ -11,6 +11,7 @@
 #include <edgesplitter.h>
 #include <broadphase.h>
 #include <collisionqueries.h>
+#include <edgepriorityqueue.h>
 #include <runstats.h>
 #include <subdivisionscheme.h>
 #include <surftrack.h>
@@ -819,14 +820,19 @@ bool EdgeSplitter::edge_length_needs_split(size_t edge_index) {
     size_t vertex_a = m_surf.m_mesh.m_edges[edge_index][0];
     size_t vertex_b = m_surf.m_mesh.m_edges[edge_index][1];
     
+    // local bounds, from the sizing field if there is one
+    double length_scale = m_surf.get_edge_length_scale(edge_index);
+    double max_edge_length = m_max_edge_length * length_scale;
+    double min_edge_length = m_min_edge_length * length_scale;
+    
     if ( m_use_curvature )
     {
         //split if we're above the upper limit
-        if(edge_length > m_max_edge_length)
+        if(edge_length > max_edge_length)
             return true;
         
         //don't split if splitting would take us below the lower limit
-        if(edge_length < 2*m_min_edge_length)
+        if(edge_length < 2*min_edge_length)
             return false;
         
         double curvature_value = get_edge_curvature( m_surf, vertex_a, vertex_b );
@@ -852,7 +858,7 @@ bool EdgeSplitter::edge_length_needs_split(size_t edge_index) {
         
     }
     else {
-        return edge_length > m_max_edge_length;
+        return edge_length > max_edge_length;
     }
     
     return false;
@@ -883,7 +889,7 @@ bool EdgeSplitter::edge_is_splittable( size_t edge_index, bool ignore_min_length
                 return false;
         }
         else {
-            if(m_surf.get_edge_length(edge_index) < m_surf.m_min_edge_length)
+            if(m_surf.get_edge_length(edge_index) < m_surf.m_min_edge_length * m_surf.get_edge_length_scale(edge_index))
                 return false;
         }
     }
@@ -1050,5 +1056,99 @@ bool EdgeSplitter::split_pass()
     return split_occurred || large_angle_split_occurred;
     
 }
+
+
+// --------------------------------------------------------
+///
+/// Split all long edges, keeping the candidates in a priority queue which is updated around each new vertex instead 
+/// of rescanning every edge.  Length-based splitting runs to completion inside this call; edges which failed to split 
+/// are retried only if some other split has succeeded since, matching the fixed point reached by repeated split_pass() 
+/// calls.  Returns whether any large-angle split occurred, since only those can leave new work for another call.
+///
+// --------------------------------------------------------
+
+bool EdgeSplitter::split_pass_queued()
+{
+    
+    if ( m_surf.m_verbose )
+    {
+        std::cout << "---------------------- Edge Splitter: queued splitting ----------------------" << std::endl;
+    }
+    
+    assert( m_max_edge_length != UNINITIALIZED_DOUBLE );
+    
+    NonDestructiveTriMesh& mesh = m_surf.m_mesh;
+    
+    //only do length-based splitting in regular mode.
+    if(!m_surf.m_aggressive_mode) {
+        
+        EdgePriorityQueue queue( true );
+        
+        for( size_t i = 0; i < mesh.m_edges.size(); i++ )
+        {    
+            if ( !edge_is_splittable(i) ) { continue; }
+            if ( edge_length_needs_split(i) )
+                queue.push( i, m_surf.get_edge_length(i) );
+        }
+        
+        std::vector<size_t> failed_edges;
+        std::vector<size_t> nearby_edges;
+        size_t splits_since_retry = 0;
+        
+        for ( ;; )
+        {
+            size_t longest_edge;
+            double queued_length;
+            while ( queue.pop( longest_edge, queued_length ) )
+            {
+                if ( !edge_is_splittable(longest_edge) ) { continue; }
+                if ( !edge_length_needs_split(longest_edge) ) { continue; }
+                
+                // the edge changed after it was queued: put it back in its proper place
+                double current_length = m_surf.get_edge_length(longest_edge);
+                if ( current_length != queued_length )
+                {
+                    queue.push( longest_edge, current_length );
+                    continue;
+                }
+                
+                size_t result_vert;
+                if ( !split_edge(longest_edge, result_vert) )
+                {
+                    failed_edges.push_back( longest_edge );
+                    continue;
+                }
+                
+                g_stats.add_to_int( "EdgeSplitter:queued_splits", 1 );
+                ++splits_since_retry;
+                
+                EdgePriorityQueue::get_edges_near_vertex( mesh, result_vert, nearby_edges );
+                for ( size_t i = 0; i < nearby_edges.size(); ++i )
+                {
+                    size_t e = nearby_edges[i];
+                    if ( edge_is_splittable(e) && edge_length_needs_split(e) )
+                        queue.push( e, m_surf.get_edge_length(e) );
+                }
+            }
+            
+            if ( failed_edges.empty() || splits_since_retry == 0 ) { break; }
+            
+            // the mesh has changed since these failed, so they may succeed now
+            g_stats.add_to_int( "EdgeSplitter:queued_split_retries", failed_edges.size() );
+            for ( size_t i = 0; i < failed_edges.size(); ++i )
+            {
+                size_t e = failed_edges[i];
+                if ( edge_is_splittable(e) && edge_length_needs_split(e) )
+                    queue.push( e, m_surf.get_edge_length(e) );
+            }
+            failed_edges.clear();
+            splits_since_retry = 0;
+        }
+    }
+    
+    // Now split to reduce large angles
+    return large_angle_split_pass();
+    
+}
     
 }
@@ -54,6 +54,11 @@ public:
     ///
     bool split_pass();
     
+    /// Split all long edges using a locally updated priority queue of candidates.  Returns true if another call may
+    /// find more work.
+    ///
+    bool split_pass_queued();
+    
     /// Split edges opposite large angles
     ///
     bool large_angle_split_pass();
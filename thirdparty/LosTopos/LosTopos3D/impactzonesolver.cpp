@@ -18,6 +18,8 @@
 
 namespace LosTopos {
 
+extern RunStats g_stats;
+
 namespace {
     
     // ---------------------------------------------------------
@@ -79,7 +81,7 @@ namespace {
                             
                             if ( !same_collision_exists )
                             {
-                                master_impact_zones[j].m_collisions.push_back( new_impact_zones[i].m_collisions[c] );
+                                master_impact_zones[j].add_collision( new_impact_zones[i].m_collisions[c], new_impact_zones[i].get_impulse(c) );
                                 found_new_collision = true;
                             }
                         }
@@ -99,17 +101,9 @@ namespace {
                 
                 if ( i_is_disjoint )
                 {
-                    // copy the impact zone
-                    
-                    ImpactZone new_zone;
-                    for ( size_t c = 0; c < new_impact_zones[i].m_collisions.size(); ++c )
-                    {
-                        new_zone.m_collisions.push_back( new_impact_zones[i].m_collisions[c] );
-                    }
+                    // copy the impact zone, keeping its impulses and factorization for warm starting
                     
-                    new_zone.m_all_solved = new_impact_zones[i].m_all_solved;
-                    
-                    master_impact_zones.push_back( new_zone );
+                    master_impact_zones.push_back( new_impact_zones[i] );
                 }
             }     // end for(i)
             
@@ -122,6 +116,23 @@ namespace {
         
     }
     
+    // ---------------------------------------------------------
+    ///
+    /// Fraction of the computed impulses applied per inelastic projection
+    ///
+    // ---------------------------------------------------------
+    
+    const double IMPULSE_MULTIPLIER = 0.8;
+    
+    // ---------------------------------------------------------
+    ///
+    /// If a preconditioned solve takes more than this many iterations, the zone's factorization has drifted too far from 
+    /// the current constraints (normals change as collisions are re-detected) and is recomputed for the next solve.
+    ///
+    // ---------------------------------------------------------
+    
+    const unsigned int MAX_ITERATIONS_BEFORE_REFACTOR = 10;
+    
     // ---------------------------------------------------------
     ///
     /// Helper function: multiply transpose(A) * D * B
@@ -157,7 +168,8 @@ namespace {
 
 ImpactZoneSolver::ImpactZoneSolver( DynamicSurface& surface) :
 m_surface( surface ),
-m_rigid_zone_infinite_mass( 1000.0 )
+m_rigid_zone_infinite_mass( 1000.0 ),
+m_unsolved_vertices()
 {}
 
 
@@ -173,9 +185,21 @@ bool ImpactZoneSolver::iterated_inelastic_projection( ImpactZone& iz, double dt
     
     static const unsigned int MAX_PROJECTION_ITERATIONS = 20;
     
+    // The first solve is warm started with the impulses from the last time this zone was solved.  Each projection 
+    // applies IMPULSE_MULTIPLIER of the computed impulses, so if the constraints don't change, the next solve's answer 
+    // is the remaining fraction of the previous one.
+    
+    std::vector<double> impulses( iz.m_collisions.size() );
+    for ( size_t c = 0; c < impulses.size(); ++c )
+    {
+        impulses[c] = iz.get_impulse(c);
+    }
+    
+    std::vector<double> total_impulses( iz.m_collisions.size(), 0.0 );
+    
     for ( unsigned int i = 0; i < MAX_PROJECTION_ITERATIONS; ++i )
     {
-        bool success = inelastic_projection( iz );
+        bool success = inelastic_projection( iz, impulses );
         
         if ( !success )
         {
@@ -183,6 +207,14 @@ bool ImpactZoneSolver::iterated_inelastic_projection( ImpactZone& iz, double dt
             return false;
         }
         
+        for ( size_t c = 0; c < impulses.size(); ++c )
+        {
+            total_impulses[c] += IMPULSE_MULTIPLIER * impulses[c];
+            impulses[c] *= ( 1.0 - IMPULSE_MULTIPLIER );
+        }
+        
+        iz.m_impulses = total_impulses;
+        
         bool collision_still_exists = false;
         
         for ( size_t c = 0; c < iz.m_collisions.size(); ++c )
@@ -272,7 +304,7 @@ bool ImpactZoneSolver::iterated_inelastic_projection( ImpactZone& iz, double dt
 ///
 // ---------------------------------------------------------
 
-bool ImpactZoneSolver::inelastic_projection( const ImpactZone& iz )
+bool ImpactZoneSolver::inelastic_projection( ImpactZone& iz, std::vector<double>& impulses )
 {
     
     if ( m_surface.m_verbose )
@@ -337,8 +369,13 @@ bool ImpactZoneSolver::inelastic_projection( const ImpactZone& iz )
     // minimize | M^(-1/2) * GC^T x - M^(1/2) * v |^2
     //
     
-    // solution vector
+    // solution vector, warm started from the given impulses
+    assert( impulses.size() == k );
     Array1d x((unsigned long)k);
+    for ( size_t i = 0; i < k; ++i )
+    {
+        x[(unsigned long)i] = impulses[i];
+    }
     
     KrylovSolverStatus solver_result;
     
@@ -354,39 +391,86 @@ bool ImpactZoneSolver::inelastic_projection( const ImpactZone& iz )
     
     if ( m_surface.m_verbose )  { std::cout << "system built" << std::endl; }
     
-    MINRES_CR_Solver solver;   
     SparseMatrixStaticCSR solver_matrix( A );    // convert dynamic to static
+    
+    // Precondition with the zone's factorization.  Rows for collisions appended since the last solve are factored 
+    // against the current matrix; the existing rows are reused as long as they keep the iteration count low.
+    
+    bool fresh_factor = ( iz.m_factor.m == 0 || iz.m_factor.m > to_int(k) );
+    if ( fresh_factor )
+    {
+        iz.m_factor.factor( solver_matrix );
+        g_stats.add_to_int( "ImpactZoneSolver:factorizations", 1 );
+    }
+    else if ( iz.m_factor.m < to_int(k) )
+    {
+        iz.m_factor.extend( solver_matrix );
+        g_stats.add_to_int( "ImpactZoneSolver:factor_extensions", 1 );
+    }
+    
+    CG_Solver solver;
     solver.max_iterations = 1000;
-    solver_result = solver.solve( solver_matrix, b.data, x.data ); 
+    solver_result = solver.solve( solver_matrix, b.data, x.data, &iz.m_factor, true );
+    
+    if ( solver_result != KRYLOV_CONVERGED && !fresh_factor )
+    {
+        // the reused factorization may have gone stale; try again with an up-to-date one
+        iz.m_factor.factor( solver_matrix );
+        g_stats.add_to_int( "ImpactZoneSolver:factorizations", 1 );
+        for ( size_t i = 0; i < k; ++i )
+        {
+            x[(unsigned long)i] = impulses[i];
+        }
+        solver_result = solver.solve( solver_matrix, b.data, x.data, &iz.m_factor, true );
+    }
+    
+    g_stats.add_to_int( "ImpactZoneSolver:solver_iterations", solver.iteration );
+    
+    if ( solver.iteration > MAX_ITERATIONS_BEFORE_REFACTOR )
+    {
+        iz.m_factor.clear();
+    }
     
     if ( solver_result != KRYLOV_CONVERGED )
     {
-        if ( m_surface.m_verbose )
+        // fall back to the unpreconditioned solver, from a zero initial guess
+        
+        MINRES_CR_Solver fallback_solver;
+        fallback_solver.max_iterations = 1000;
+        solver_result = fallback_solver.solve( solver_matrix, b.data, x.data ); 
+        
+        if ( solver_result != KRYLOV_CONVERGED )
         {
-            std::cout << "CR solver failed: ";      
-            if ( solver_result == KRYLOV_BREAKDOWN )
+            if ( m_surface.m_verbose )
             {
-                std::cout << "KRYLOV_BREAKDOWN" << std::endl;
-            }
-            else
-            {
-                std::cout << "KRYLOV_EXCEEDED_MAX_ITERATIONS" << std::endl;
+                std::cout << "CR solver failed: ";      
+                if ( solver_result == KRYLOV_BREAKDOWN )
+                {
+                    std::cout << "KRYLOV_BREAKDOWN" << std::endl;
+                }
+                else
+                {
+                    std::cout << "KRYLOV_EXCEEDED_MAX_ITERATIONS" << std::endl;
+                }
+                
+                double residual_norm = BLAS::abs_max(fallback_solver.r);
+                std::cout << "residual_norm: " << residual_norm << std::endl;
+                
             }
             
-            double residual_norm = BLAS::abs_max(solver.r);
-            std::cout << "residual_norm: " << residual_norm << std::endl;
-            
+            return false;          
         }
-        
-        return false;          
     } 
     
+    for ( size_t i = 0; i < k; ++i )
+    {
+        impulses[i] = x[(unsigned long)i];
+    }
+    
     // apply impulses 
     Array1d applied_impulses(3*(unsigned long)n);
     GCT.apply( x.data, applied_impulses.data );
     
-    static const double IMPULSE_MULTIPLIER = 0.8;
-    
     for ( size_t i = 0; i < applied_impulses.size(); ++i )
     {
         column_velocities[(unsigned long)i] -= IMPULSE_MULTIPLIER * inv_masses[(unsigned long)i] * applied_impulses[(unsigned long)i];      
@@ -414,6 +498,8 @@ bool ImpactZoneSolver::inelastic_projection( const ImpactZone& iz )
 bool ImpactZoneSolver::inelastic_impact_zones(double dt)
 {
     
+    m_unsolved_vertices.clear();
+    
     // copy
     std::vector<Vec3d> old_velocities = m_surface.m_velocities;
     
@@ -474,7 +560,13 @@ bool ImpactZoneSolver::inelastic_impact_zones(double dt)
             
             // apply inelastic projection
             
-            all_zones_solved_ok &= iterated_inelastic_projection( impact_zones[i], dt );
+            if ( !iterated_inelastic_projection( impact_zones[i], dt ) )
+            {
+                std::vector<size_t> zone_vertices;
+                impact_zones[i].get_all_vertices( zone_vertices );
+                m_unsolved_vertices.insert( m_unsolved_vertices.end(), zone_vertices.begin(), zone_vertices.end() );
+                all_zones_solved_ok = false;
+            }
             
             // reset predicted positions
             for ( size_t j = 0; j < impact_zones[i].m_collisions.size(); ++j )
@@ -514,6 +606,7 @@ bool ImpactZoneSolver::inelastic_impact_zones(double dt)
             bool detect_ok = m_surface.m_collision_pipeline->detect_new_collisions( impact_zones, total_collisions );
             if ( !detect_ok )
             {
+                m_unsolved_vertices.clear();
                 return false;
             }
         }
@@ -531,7 +624,6 @@ bool ImpactZoneSolver::inelastic_impact_zones(double dt)
 ///  Rigid Impact Zones, as described in [Bridson, Fedkiw, Anderson 2002].
 ///
 // ---------------------------------------------------------
-extern RunStats g_stats;
 
 bool ImpactZoneSolver::rigid_impact_zones(double dt)
 {
@@ -539,6 +631,8 @@ bool ImpactZoneSolver::rigid_impact_zones(double dt)
     
     g_stats.add_to_int( "ImpactZoneSolver:rigid_impact_zones", 1 );
     
+    m_unsolved_vertices.clear();
+    
     // copy
     std::vector<Vec3d> old_velocities = m_surface.m_velocities;
     
@@ -592,6 +686,7 @@ bool ImpactZoneSolver::rigid_impact_zones(double dt)
             if ( !rigid_motion_ok )
             {
                 std::cout << "rigid impact zone fails" << std::endl;
+                m_unsolved_vertices = zone_vertices;
                 return false;
             }
             
@@ -611,6 +706,7 @@ bool ImpactZoneSolver::rigid_impact_zones(double dt)
             
             if ( !detect_ok )
             {
+                m_unsolved_vertices.clear();
                 return false;
             }
             
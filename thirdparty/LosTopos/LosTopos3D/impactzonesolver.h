@@ -17,6 +17,7 @@
 // ---------------------------------------------------------
 
 #include <collisionpipeline.h>
+#include <sparse_ldl.h>
 #include <vector>
 
 // ---------------------------------------------------------
@@ -43,7 +44,9 @@ struct ImpactZone
     ///
     ImpactZone() :
     m_collisions(),
-    m_all_solved( false )
+    m_all_solved( false ),
+    m_impulses(),
+    m_factor()
     {}
     
     /// Get the set of all vertices in this impact zone
@@ -54,6 +57,14 @@ struct ImpactZone
     ///
     bool share_vertices( const ImpactZone& other ) const;
     
+    /// Append a collision, along with the impulse previously applied for it (if any)
+    ///
+    void add_collision( const Collision& collision, double impulse = 0.0 );
+    
+    /// Impulse previously applied for the given collision, or zero if it has not been solved yet
+    ///
+    double get_impulse( size_t collision_index ) const;
+    
     /// Set of collisions with connected vertices
     ///
     std::vector<Collision> m_collisions;  
@@ -62,6 +73,16 @@ struct ImpactZone
     ///
     bool m_all_solved;
     
+    /// Total impulse applied for each collision the last time this zone was solved, used to warm start the next solve.
+    /// May be shorter than m_collisions if collisions were appended since.
+    ///
+    std::vector<double> m_impulses;
+    
+    /// LDL^T factorization of the zone's constraint matrix, used to precondition the solve.  Covers the first m_factor.m 
+    /// collisions; since new collisions are only ever appended, it is extended rather than recomputed as the zone grows.
+    ///
+    SparseLDLFactor m_factor;
+    
 };
 
 
@@ -88,15 +109,21 @@ public:
     ///
     bool rigid_impact_zones(double dt);
     
+    /// Vertices of the impact zones which the last call to inelastic_impact_zones or rigid_impact_zones failed to solve.
+    /// Empty if that call succeeded, or if the failure could not be attributed to particular zones.
+    ///
+    const std::vector<size_t>& get_unsolved_vertices() const { return m_unsolved_vertices; }
+    
 protected:
     
     /// Iteratively project out relative normal velocities for a set of collisions in an impact zone until all collisions are solved.
     ///
     bool iterated_inelastic_projection( ImpactZone& iz, double dt );
     
-    /// Project out relative normal velocities for a set of collisions in an impact zone.
+    /// Project out relative normal velocities for a set of collisions in an impact zone.  On input, impulses holds the 
+    /// initial guess for the solver; on output, the computed impulses.
     ///
-    bool inelastic_projection( const ImpactZone& iz );
+    bool inelastic_projection( ImpactZone& iz, std::vector<double>& impulses );
     
     /// Compute the best-fit rigid motion for the set of moving vertices
     ///
@@ -110,6 +137,10 @@ protected:
     ///
     const double m_rigid_zone_infinite_mass;     
     
+    /// Vertices of the impact zones which could not be solved
+    ///
+    std::vector<size_t> m_unsolved_vertices;
+    
 };
 
 
@@ -158,6 +189,32 @@ inline bool ImpactZone::share_vertices( const ImpactZone& other ) const
     return false;
 }
 
+
+// --------------------------------------------------------
+///
+/// Append a collision to this ImpactZone, along with the impulse previously applied for it (if any)
+///
+// --------------------------------------------------------
+
+inline void ImpactZone::add_collision( const Collision& collision, double impulse )
+{
+    m_impulses.resize( m_collisions.size(), 0.0 );
+    m_collisions.push_back( collision );
+    m_impulses.push_back( impulse );
+}
+
+
+// --------------------------------------------------------
+///
+/// Impulse previously applied for the given collision, or zero if it has not been solved yet
+///
+// --------------------------------------------------------
+
+inline double ImpactZone::get_impulse( size_t collision_index ) const
+{
+    return collision_index < m_impulses.size() ? m_impulses[collision_index] : 0.0;
+}
+
 }
 
 #endif
@@ -10,10 +10,12 @@
 
 #include <meshsmoother.h>
 
+#include <accelerationhash.h>
 #include <impactzonesolver.h>
 #include <lapack_wrapper.h>
 #include <mat.h>
 #include <nondestructivetrimesh.h>
+#include <runstats.h>
 #include <surftrack.h>
 #include "trianglequality.h"
 
@@ -29,6 +31,8 @@
 
 namespace LosTopos {
     
+extern RunStats g_stats;
+
 double MeshSmoother::compute_max_timestep_quadratic_solve( const std::vector<Vec3st>& tris,
                                                           const std::vector<Vec3d>& positions,
                                                           const std::vector<Vec3d>& displacements,
@@ -837,6 +841,304 @@ bool MeshSmoother::null_space_smoothing_pass( double dt )
     
     return !converged;
 }
+
+// --------------------------------------------------------
+///
+/// Swept AABB of a vertex's one-ring while the vertex moves to newpos, padded by the proximity tolerances used by the
+/// pseudo-motion collision test.  Two moves whose boxes are disjoint cannot affect each other's collision test.
+///
+// --------------------------------------------------------
+
+void MeshSmoother::get_star_swept_aabb( size_t v, const Vec3d& newpos, Vec3d& xmin, Vec3d& xmax ) const
+{
+    const NonDestructiveTriMesh& mesh = m_surf.m_mesh;
+    
+    xmin = xmax = m_surf.get_position(v);
+    update_minmax( newpos, xmin, xmax );
     
+    const std::vector<size_t>& edges = mesh.m_vertex_to_edge_map[v];
+    for ( size_t i = 0; i < edges.size(); ++i )
+    {
+        const Vec2st& e = mesh.m_edges[edges[i]];
+        size_t other = ( e[0] == v ) ? e[1] : e[0];
+        update_minmax( m_surf.get_position(other), xmin, xmax );
+    }
+    
+    double padding = m_surf.m_improve_collision_epsilon + m_surf.m_aabb_padding;
+    xmin -= Vec3d(padding);
+    xmax += Vec3d(padding);
 }
 
+// --------------------------------------------------------
+///
+/// Shorten a vertex displacement until moving the vertex, with the rest of the mesh held still, is collision-free.
+/// Returns false if no fraction of the displacement down to 2^-MAX_HALVINGS is safe.
+///
+// --------------------------------------------------------
+
+bool MeshSmoother::clamp_vertex_displacement( size_t v, Vec3d& displacement ) const
+{
+    static const unsigned int MAX_HALVINGS = 3;
+    
+    const Vec3d& oldpos = m_surf.get_position(v);
+    for ( unsigned int i = 0; i <= MAX_HALVINGS; ++i )
+    {
+        if ( !m_surf.vertex_pseudo_motion_introduces_collision( v, oldpos, oldpos + displacement ) )
+        {
+            return true;
+        }
+        displacement *= 0.5;
+    }
+    
+    displacement = Vec3d(0,0,0);
+    return false;
+}
+
+// --------------------------------------------------------
+///
+/// Greedily partition the moving vertices into batches in which no two vertices are adjacent or share a neighbour, so
+/// the one-rings of a batch have no vertices in common.
+///
+// --------------------------------------------------------
+
+void MeshSmoother::get_independent_vertex_batches( const std::vector<unsigned char>& moving, std::vector< std::vector<size_t> >& batches ) const
+{
+    const NonDestructiveTriMesh& mesh = m_surf.m_mesh;
+    const size_t UNCOLOURED = ~static_cast<size_t>(0);
+    
+    std::vector<size_t> colour( moving.size(), UNCOLOURED );
+    std::vector<size_t> colour_stamp;   // colour_stamp[c] == v+1 if colour c is taken in v's 2-ring
+    
+    batches.clear();
+    
+    for ( size_t v = 0; v < moving.size(); ++v )
+    {
+        if ( !moving[v] ) { continue; }
+        
+        const std::vector<size_t>& edges = mesh.m_vertex_to_edge_map[v];
+        for ( size_t i = 0; i < edges.size(); ++i )
+        {
+            const Vec2st& e = mesh.m_edges[edges[i]];
+            size_t neighbour = ( e[0] == v ) ? e[1] : e[0];
+            if ( colour[neighbour] != UNCOLOURED ) { colour_stamp[colour[neighbour]] = v + 1; }
+            
+            const std::vector<size_t>& neighbour_edges = mesh.m_vertex_to_edge_map[neighbour];
+            for ( size_t j = 0; j < neighbour_edges.size(); ++j )
+            {
+                const Vec2st& ne = mesh.m_edges[neighbour_edges[j]];
+                size_t second = ( ne[0] == neighbour ) ? ne[1] : ne[0];
+                if ( colour[second] != UNCOLOURED ) { colour_stamp[colour[second]] = v + 1; }
+            }
+        }
+        
+        size_t c = 0;
+        while ( c < colour_stamp.size() && colour_stamp[c] == v + 1 ) { ++c; }
+        
+        if ( c == colour_stamp.size() )
+        {
+            colour_stamp.push_back( 0 );
+            batches.push_back( std::vector<size_t>() );
+        }
+        
+        colour[v] = c;
+        batches[c].push_back( v );
+    }
+}
+
+// --------------------------------------------------------
+///
+/// Parallel NULL-space smoothing.  Displacements for all vertices are computed concurrently, then applied one
+/// independent batch at a time: each vertex in a batch is checked against the (static) rest of the mesh concurrently, 
+/// with its displacement halved until collision-free, and the surviving moves are committed in order.  A move whose 
+/// swept one-ring overlaps a move already committed in the same batch is re-checked against the updated mesh first.
+/// Moves are never allowed to introduce collisions, so unlike null_space_smoothing_pass() no impact zone solve is needed.
+///
+// --------------------------------------------------------
+
+bool MeshSmoother::parallel_smoothing_pass( double dt )
+{
+    void * data = NULL;
+    if (m_surf.m_mesheventcallback)
+        m_surf.m_mesheventcallback->pre_smoothing(m_surf, &data);
+    
+    if ( m_surf.m_verbose )
+    {
+        std::cout << "---------------------- Los Topos: parallel vertex redistribution ----------------------" << std::endl;
+    }
+    
+    const NonDestructiveTriMesh& mesh = m_surf.m_mesh;
+    const int num_triangles = (int) mesh.num_triangles();
+    const int num_vertices = (int) m_surf.get_num_vertices();
+    
+    std::vector<double> triangle_areas( num_triangles, 0.0 );
+    std::vector<Vec3d> triangle_normals( num_triangles, Vec3d(0,0,0) );
+    std::vector<Vec3d> triangle_centroids( num_triangles, Vec3d(0,0,0) );
+    
+    #pragma omp parallel for schedule(static)
+    for ( int i = 0; i < num_triangles; ++i )
+    {
+        const Vec3st& tri = mesh.get_triangle(i);
+        if ( tri[0] == tri[1] ) { continue; }
+        
+        triangle_areas[i] = m_surf.get_triangle_area( i );
+        triangle_normals[i] = m_surf.get_triangle_normal( i );
+        triangle_centroids[i] = (m_surf.get_position(tri[0]) + m_surf.get_position(tri[1]) + m_surf.get_position(tri[2])) / 3;
+    }
+    
+    // select the vertices to smooth, and their fixed components, serially (the solid callback need not be reentrant)
+    
+    std::vector<unsigned char> moving( num_vertices, 0 );
+    std::vector<Vec3c> solid( num_vertices, Vec3c(0,0,0) );
+    
+    if ( !m_surf.m_aggressive_mode )
+    {
+        for ( int i = 0; i < num_vertices; ++i )
+        {
+            moving[i] = !mesh.vertex_is_deleted(i) && !m_surf.vertex_is_all_solid(i);
+        }
+    }
+    else
+    {
+        // as in null_space_smoothing_pass(), only smooth the vertices of triangles with bad angles
+        for ( int i = 0; i < num_triangles; ++i )
+        {
+            const Vec3st& tri = mesh.get_triangle(i);
+            if ( tri[0] == tri[1] ) { continue; }
+            
+            Vec3d angles;
+            triangle_angles( m_surf.get_position(tri[0]), m_surf.get_position(tri[1]), m_surf.get_position(tri[2]), angles[0], angles[1], angles[2] );
+            angles[0] = rad2deg(angles[0]); angles[1] = rad2deg(angles[1]); angles[2] = rad2deg(angles[2]);
+            
+            if ( min( angles[0], angles[1], angles[2] ) < m_surf.m_min_triangle_angle || 
+                 max( angles[0], angles[1], angles[2] ) > m_surf.m_max_triangle_angle )
+            {
+                for ( int j = 0; j < 3; ++j )
+                {
+                    if ( !m_surf.vertex_is_all_solid(tri[j]) ) { moving[tri[j]] = 1; }
+                }
+            }
+        }
+    }
+    
+    for ( int i = 0; i < num_vertices; ++i )
+    {
+        if ( moving[i] ) { solid[i] = m_surf.vertex_is_solid_3(i); }
+    }
+    
+    std::vector<Vec3d> displacements( num_vertices, Vec3d(0,0,0) );
+    
+    #pragma omp parallel for schedule(dynamic, 64)
+    for ( int i = 0; i < num_vertices; ++i )
+    {
+        if ( !moving[i] ) { continue; }
+        
+        null_space_smooth_vertex( i, triangle_areas, triangle_normals, triangle_centroids, displacements[i] );
+        for ( unsigned int k = 0; k < 3; ++k )
+        {
+            if ( solid[i][k] ) { displacements[i][k] = 0; }
+        }
+    }
+    
+    for ( int i = 0; i < num_vertices; ++i )
+    {
+        if ( moving[i] && displacements[i] == Vec3d(0,0,0) ) { moving[i] = 0; }
+    }
+    
+    // apply the displacements in batches of vertices with disjoint one-rings
+    
+    std::vector< std::vector<size_t> > batches;
+    get_independent_vertex_batches( moving, batches );
+    
+    AccelerationHash committed;
+    committed.set( max( m_surf.get_average_edge_length(), 1e-30 ) );
+    std::vector<size_t> overlapping;
+    
+    std::vector<Vec3d> final_displacements( num_vertices, Vec3d(0,0,0) );
+    
+    size_t num_moved = 0, num_clamped = 0, num_rejected = 0, num_rechecked = 0;
+    
+    for ( size_t b = 0; b < batches.size(); ++b )
+    {
+        const std::vector<size_t>& batch = batches[b];
+        const int batch_size = (int) batch.size();
+        
+        std::vector<Vec3d> batch_displacements( batch_size );
+        std::vector<unsigned char> batch_clamped( batch_size, 0 );
+        
+        #pragma omp parallel for schedule(dynamic, 16)
+        for ( int i = 0; i < batch_size; ++i )
+        {
+            size_t v = batch[i];
+            Vec3d displacement = displacements[v];
+            clamp_vertex_displacement( v, displacement );
+            batch_clamped[i] = ( displacement != displacements[v] );
+            batch_displacements[i] = displacement;
+        }
+        
+        committed.clear();
+        
+        for ( int i = 0; i < batch_size; ++i )
+        {
+            size_t v = batch[i];
+            Vec3d displacement = batch_displacements[i];
+            if ( displacement == Vec3d(0,0,0) ) { ++num_rejected; continue; }
+            
+            Vec3d oldpos = m_surf.get_position(v);
+            Vec3d xmin, xmax;
+            get_star_swept_aabb( v, oldpos + displacement, xmin, xmax );
+            
+            overlapping.clear();
+            committed.find_overlapping_elements( xmin, xmax, overlapping );
+            
+            if ( !overlapping.empty() )
+            {
+                // the parallel test did not see the moves committed nearby, so redo it against the current mesh
+                ++num_rechecked;
+                Vec3d unclamped = displacement;
+                if ( !clamp_vertex_displacement( v, displacement ) ) { ++num_rejected; continue; }
+                if ( displacement != unclamped ) { batch_clamped[i] = 1; }
+                get_star_swept_aabb( v, oldpos + displacement, xmin, xmax );
+            }
+            
+            if ( batch_clamped[i] ) { ++num_clamped; }
+            ++num_moved;
+            
+            m_surf.set_position( v, oldpos + displacement );
+            m_surf.set_newposition( v, oldpos + displacement );
+            final_displacements[v] = displacement;
+            committed.add_element( v, xmin, xmax );
+        }
+    }
+    
+    g_stats.add_to_int( "MeshSmoother:parallel_smoothing_batches", batches.size() );
+    g_stats.add_to_int( "MeshSmoother:parallel_smoothing_moves", num_moved );
+    g_stats.add_to_int( "MeshSmoother:parallel_smoothing_clamped", num_clamped );
+    g_stats.add_to_int( "MeshSmoother:parallel_smoothing_rejected", num_rejected );
+    g_stats.add_to_int( "MeshSmoother:parallel_smoothing_rechecked", num_rechecked );
+    
+    m_surf.m_velocities.resize( num_vertices );
+    
+    double max_position_change = 0.0;
+    for ( int i = 0; i < num_vertices; ++i )
+    {
+        m_surf.m_velocities[i] = final_displacements[i] / dt;
+        max_position_change = max( max_position_change, mag( final_displacements[i] ) );
+    }
+    
+    if ( m_surf.m_verbose ) 
+    { 
+        std::cout << "batches: " << batches.size() << ", moved: " << num_moved << ", clamped: " << num_clamped << ", rejected: " << num_rejected << std::endl;
+        std::cout << "max_position_change: " << max_position_change << std::endl; 
+    }
+    
+    // same convergence test as null_space_smoothing_pass()
+    const static double CONVERGENCE_TOL_SCALAR = 1.0;   
+    bool converged = ( max_position_change < CONVERGENCE_TOL_SCALAR * m_surf.get_average_edge_length() );
+    
+    if (m_surf.m_mesheventcallback)
+        m_surf.m_mesheventcallback->post_smoothing(m_surf, data);
+    
+    return !converged;
+}
+    
+}
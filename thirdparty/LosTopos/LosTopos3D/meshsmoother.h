@@ -58,6 +58,11 @@ public:
     ///
     bool null_space_smoothing_pass( double dt );
     
+    /// NULL-space smoothing of all vertices, computed in parallel and applied in independent batches of vertices.  Each
+    /// move is shortened or dropped as needed to stay collision-free.
+    ///
+    bool parallel_smoothing_pass( double dt );
+    
     /// Compute the maximum timestep that will not invert any triangle normals, using a quadratic solve as in [Jiao 2007].
     ///
     static double compute_max_timestep_quadratic_solve( const std::vector<Vec3st>& tris, 
@@ -97,6 +102,18 @@ private:
       const std::vector<Vec3d>& triangle_normals, 
       const std::vector<Vec3d>& triangle_centroids) const;
 
+    /// Swept, padded AABB of the one-ring of v while v moves to newpos
+    ///
+    void get_star_swept_aabb( size_t v, const Vec3d& newpos, Vec3d& xmin, Vec3d& xmax ) const;
+    
+    /// Halve the displacement of v until moving v alone is collision-free.  Returns false (and zeroes it) if none is.
+    ///
+    bool clamp_vertex_displacement( size_t v, Vec3d& displacement ) const;
+    
+    /// Partition the moving vertices into batches with pairwise disjoint one-rings
+    ///
+    void get_independent_vertex_batches( const std::vector<unsigned char>& moving, std::vector< std::vector<size_t> >& batches ) const;
+    
     /// The mesh this object operates on
     /// 
     SurfTrack& m_surf;
@@ -20,6 +20,8 @@
 #include <trianglequality.h>
 #include <edgesplitter.h>
 #include <facesplitter.h>
+#include <algorithm>
+#include <set>
 
 // ---------------------------------------------------------
 //  Extern globals
@@ -701,6 +703,36 @@ bool MeshSnapper::vert_pair_is_snappable( size_t vert0, size_t vert1 )
 // --------------------------------------------------------
 
 bool MeshSnapper::edge_pair_is_snappable( size_t edge0, size_t edge1, double& current_length )
+{
+    
+    if ( !edge_pair_is_snap_candidate( edge0, edge1 ) || !edge_pair_faces_allow_snap( edge0, edge1 ) )
+        return false;
+    
+    //TODO extend to handle constraints, solids, and boundaries
+    
+    const Vec2st& edge_data0 = m_surf.m_mesh.m_edges[edge0];
+    const Vec2st& edge_data1 = m_surf.m_mesh.m_edges[edge1];
+    
+    double s0, s2;
+    Vec3d normal;
+    
+    check_edge_edge_proximity( m_surf.get_position(edge_data0[0]),
+                              m_surf.get_position(edge_data0[1]),
+                              m_surf.get_position(edge_data1[0]),
+                              m_surf.get_position(edge_data1[1]),
+                              current_length, s0, s2, normal );
+    
+    return edge_pair_proximity_allows_snap( edge0, edge1, current_length, s0, s2 );
+    
+}
+
+// --------------------------------------------------------
+///
+/// Cheap topological tests for an edge edge pair, done before any geometry is looked at
+///
+// --------------------------------------------------------
+
+bool MeshSnapper::edge_pair_is_snap_candidate( size_t edge0, size_t edge1 )
 {
     
     // skip deleted vertices
@@ -718,6 +750,22 @@ bool MeshSnapper::edge_pair_is_snappable( size_t edge0, size_t edge1, double& cu
        edge_data0[1] == edge_data1[0] || edge_data0[1] == edge_data1[1] )
         return false;
     
+    return true;
+    
+}
+
+// --------------------------------------------------------
+///
+/// Check the angle between faces incident on an edge edge pair
+///
+// --------------------------------------------------------
+
+bool MeshSnapper::edge_pair_faces_allow_snap( size_t edge0, size_t edge1 )
+{
+    
+    const Vec2st& edge_data0 = m_surf.m_mesh.m_edges[edge0];
+    const Vec2st& edge_data1 = m_surf.m_mesh.m_edges[edge1];
+    
     //check if the edges are on two triangles sharing an edge, and if so
     //require that the faces be at less than 90 degrees to continue.
     //(otherwise, we're essentially snapping triangle to be degenerate/zero area in its plane.)
@@ -769,44 +817,47 @@ bool MeshSnapper::edge_pair_is_snappable( size_t edge0, size_t edge1, double& cu
     }
     
     
-    //TODO extend to handle constraints, solids, and boundaries
+    return true;
     
-    double s0, s2;
-    Vec3d normal;
+}
+
+// --------------------------------------------------------
+///
+/// Given the result of the proximity query for an edge edge pair, determine if it should be snapped
+///
+// --------------------------------------------------------
+
+bool MeshSnapper::edge_pair_proximity_allows_snap( size_t edge0, size_t edge1, double current_length, double s0, double s2 )
+{
     
-    check_edge_edge_proximity( m_surf.get_position(edge_data0[0]),
-                              m_surf.get_position(edge_data0[1]),
-                              m_surf.get_position(edge_data1[0]),
-                              m_surf.get_position(edge_data1[1]),
-                              current_length, s0, s2, normal );
+    if(current_length >= m_surf.m_merge_proximity_epsilon)
+        return false;
     
-    if(current_length < m_surf.m_merge_proximity_epsilon) {
-        
-        //check for "dimensional drop-down" cases which would lead to snapping two vertices that already share an edge.
-        if(s0 > 1 - m_edge_threshold) {
-            if(s2 > 1 - m_edge_threshold) {
-                if(m_surf.m_mesh.get_edge_index(edge_data0[0], edge_data1[0]) != m_surf.m_mesh.m_edges.size())
-                    return false;
-            }
-            else if(s2 < m_edge_threshold) {
-                if(m_surf.m_mesh.get_edge_index(edge_data0[0], edge_data1[1]) != m_surf.m_mesh.m_edges.size())
-                    return false;
-            }
+    const Vec2st& edge_data0 = m_surf.m_mesh.m_edges[edge0];
+    const Vec2st& edge_data1 = m_surf.m_mesh.m_edges[edge1];
+    
+    //check for "dimensional drop-down" cases which would lead to snapping two vertices that already share an edge.
+    if(s0 > 1 - m_edge_threshold) {
+        if(s2 > 1 - m_edge_threshold) {
+            if(m_surf.m_mesh.get_edge_index(edge_data0[0], edge_data1[0]) != m_surf.m_mesh.m_edges.size())
+                return false;
         }
-        else if(s0 < m_edge_threshold) {
-            if(s2 > 1 - m_edge_threshold) {
-                if(m_surf.m_mesh.get_edge_index(edge_data0[1], edge_data1[0]) != m_surf.m_mesh.m_edges.size())
-                    return false;
-            }
-            else if(s2 < m_edge_threshold) {
-                if(m_surf.m_mesh.get_edge_index(edge_data0[1], edge_data1[1]) != m_surf.m_mesh.m_edges.size())
-                    return false;
-            }
+        else if(s2 < m_edge_threshold) {
+            if(m_surf.m_mesh.get_edge_index(edge_data0[0], edge_data1[1]) != m_surf.m_mesh.m_edges.size())
+                return false;
         }
-        return true;
     }
-    else
-        return false;
+    else if(s0 < m_edge_threshold) {
+        if(s2 > 1 - m_edge_threshold) {
+            if(m_surf.m_mesh.get_edge_index(edge_data0[1], edge_data1[0]) != m_surf.m_mesh.m_edges.size())
+                return false;
+        }
+        else if(s2 < m_edge_threshold) {
+            if(m_surf.m_mesh.get_edge_index(edge_data0[1], edge_data1[1]) != m_surf.m_mesh.m_edges.size())
+                return false;
+        }
+    }
+    return true;
     
 }
 
@@ -818,6 +869,35 @@ bool MeshSnapper::edge_pair_is_snappable( size_t edge0, size_t edge1, double& cu
 // --------------------------------------------------------
 
 bool MeshSnapper::face_vertex_pair_is_snappable( size_t face, size_t vertex, double& current_length )
+{
+    
+    if ( !face_vertex_pair_is_snap_candidate( face, vertex ) || !face_vertex_pair_faces_allow_snap( face, vertex ) )
+        return false;
+    
+    //TODO extend to handle constraints, solids, and boundaries
+    
+    const Vec3st& face_data = m_surf.m_mesh.m_tris[face];
+    
+    double s0, s1, s2;
+    Vec3d normal;
+    
+    check_point_triangle_proximity( m_surf.get_position(vertex),
+                                   m_surf.get_position(face_data[0]),
+                                   m_surf.get_position(face_data[1]),
+                                   m_surf.get_position(face_data[2]),
+                                   current_length, s0, s1, s2, normal );
+    
+    return face_vertex_pair_proximity_allows_snap( face, vertex, current_length, s0, s1, s2 );
+    
+}
+
+// --------------------------------------------------------
+///
+/// Cheap topological tests for a face vertex pair, done before any geometry is looked at
+///
+// --------------------------------------------------------
+
+bool MeshSnapper::face_vertex_pair_is_snap_candidate( size_t face, size_t vertex )
 {
     
     // skip deleted pairs
@@ -829,6 +909,21 @@ bool MeshSnapper::face_vertex_pair_is_snappable( size_t face, size_t vertex, dou
     if(m_surf.m_mesh.triangle_contains_vertex(face_data, vertex))
         return false;
     
+    return true;
+    
+}
+
+// --------------------------------------------------------
+///
+/// Check the angle between the face and any adjacent face containing the vertex
+///
+// --------------------------------------------------------
+
+bool MeshSnapper::face_vertex_pair_faces_allow_snap( size_t face, size_t vertex )
+{
+    
+    const Vec3st& face_data = m_surf.m_mesh.m_tris[face];
+    
     //check if the vertex is contained in a face adjacent to the one it's merging with.
     //if so, require that the angle between the faces be less than 90 degrees.
     Vec3d tri_normal = m_surf.get_triangle_normal(face);
@@ -855,37 +950,212 @@ bool MeshSnapper::face_vertex_pair_is_snappable( size_t face, size_t vertex, dou
         }
     }
     
-    //TODO extend to handle constraints, solids, and boundaries
+    return true;
     
-    double s0, s1, s2;
-    Vec3d normal;
+}
+
+// --------------------------------------------------------
+///
+/// Given the result of the proximity query for a face vertex pair, determine if it should be snapped
+///
+// --------------------------------------------------------
+
+bool MeshSnapper::face_vertex_pair_proximity_allows_snap( size_t face, size_t vertex, double current_length, 
+                                                         double s0, double s1, double s2 )
+{
     
-    check_point_triangle_proximity( m_surf.get_position(vertex),
-                                   m_surf.get_position(face_data[0]),
-                                   m_surf.get_position(face_data[1]),
-                                   m_surf.get_position(face_data[2]),
-                                   current_length, s0, s1, s2, normal );
+    if(current_length >= m_surf.m_merge_proximity_epsilon)
+        return false;
+    
+    const Vec3st& face_data = m_surf.m_mesh.m_tris[face];
+    
+    //anticipate the case where we would drop down to vertex snapping
+    //but there is already a connecting edge. That should be an edge collapse, not a snap.
+    if(s1 < m_face_threshold && s2 < m_face_threshold &&
+       m_surf.m_mesh.get_edge_index(face_data[0], vertex) != m_surf.m_mesh.m_edges.size())
+        return false;
+    
+    if(s0 < m_face_threshold && s2 < m_face_threshold && 
+       m_surf.m_mesh.get_edge_index(face_data[1], vertex) != m_surf.m_mesh.m_edges.size())
+        return false;
+    
+    if(s0 < m_face_threshold && s1 < m_face_threshold &&
+       m_surf.m_mesh.get_edge_index(face_data[2], vertex) != m_surf.m_mesh.m_edges.size())
+        return false;
+    
+    return true;
+    
+}
+
+// --------------------------------------------------------
+///
+/// Run the batched proximity query on pending snap candidates, and append the pairs which should be snapped to the 
+/// list to try, in the order they were queued.  Clears the pending pairs and the batch.
+///
+// --------------------------------------------------------
+
+void MeshSnapper::add_snappable_pairs( std::vector<Vec2st>& pending_pairs, ProximityBatch& batch, bool face_vert_proximity,
+                                      std::vector<SortableProximity>& sortable_pairs_to_try )
+{
     
-    if(current_length < m_surf.m_merge_proximity_epsilon) {
+    if ( face_vert_proximity )
+    {
+        check_point_triangle_proximity( batch );
+    }
+    else
+    {
+        check_edge_edge_proximity( batch );
+    }
+    
+    for ( size_t i = 0; i < pending_pairs.size(); ++i )
+    {
+        size_t ind0 = pending_pairs[i][0];
+        size_t ind1 = pending_pairs[i][1];
+        double len = batch.distance[i];
         
-        //anticipate the case where we would drop down to vertex snapping
-        //but there is already a connecting edge. That should be an edge collapse, not a snap.
-        if(s1 < m_face_threshold && s2 < m_face_threshold &&
-           m_surf.m_mesh.get_edge_index(face_data[0], vertex) != m_surf.m_mesh.m_edges.size())
-            return false;
+        bool snappable;
+        if ( face_vert_proximity )
+        {
+            snappable = len < m_surf.m_merge_proximity_epsilon &&
+                        face_vertex_pair_faces_allow_snap( ind0, ind1 ) &&
+                        face_vertex_pair_proximity_allows_snap( ind0, ind1, len, batch.s[0][i], batch.s[1][i], batch.s[2][i] );
+        }
+        else
+        {
+            snappable = len < m_surf.m_merge_proximity_epsilon &&
+                        edge_pair_faces_allow_snap( ind0, ind1 ) &&
+                        edge_pair_proximity_allows_snap( ind0, ind1, len, batch.s[0][i], batch.s[1][i] );
+        }
         
-        if(s0 < m_face_threshold && s2 < m_face_threshold && 
-           m_surf.m_mesh.get_edge_index(face_data[1], vertex) != m_surf.m_mesh.m_edges.size())
-            return false;
+        if ( snappable )
+        {
+            sortable_pairs_to_try.push_back( SortableProximity( ind0, ind1, len, face_vert_proximity ) );
+        }
+    }
+    
+    pending_pairs.clear();
+    batch.clear();
+    
+}
+
+
+// --------------------------------------------------------
+///
+/// Queue the face-vertex pairs formed by the given vertex and the triangles near it for batched evaluation
+///
+// --------------------------------------------------------
+
+void MeshSnapper::add_vertex_face_candidates( size_t vertex, std::vector<Vec2st>& pending_pairs, ProximityBatch& batch,
+                                             std::vector<SortableProximity>& sortable_pairs_to_try )
+{
+    
+    Vec3d vmin, vmax;
+    m_surf.vertex_static_bounds(vertex, vmin, vmax);
+    vmin -= m_surf.m_merge_proximity_epsilon * Vec3d(1,1,1);
+    vmax += m_surf.m_merge_proximity_epsilon * Vec3d(1,1,1);
+    
+    std::vector<size_t> overlapping_tris;
+    m_surf.m_broad_phase->get_potential_triangle_collisions(vmin, vmax, false, true, overlapping_tris);
+    
+    for(size_t i = 0; i < overlapping_tris.size(); ++i) {
+        size_t face = overlapping_tris[i];
         
-        if(s0 < m_face_threshold && s1 < m_face_threshold &&
-           m_surf.m_mesh.get_edge_index(face_data[2], vertex) != m_surf.m_mesh.m_edges.size())
-            return false;
+        if(!face_vertex_pair_is_snap_candidate(face, vertex))
+            continue;
+        
+        const Vec3st& tri_data = m_surf.m_mesh.m_tris[face];
+        pending_pairs.push_back(Vec2st(face, vertex));
+        batch.push_back(m_surf.get_position(vertex), 
+                        m_surf.get_position(tri_data[0]), 
+                        m_surf.get_position(tri_data[1]), 
+                        m_surf.get_position(tri_data[2]));
+        
+        if(batch.full())
+            add_snappable_pairs(pending_pairs, batch, true, sortable_pairs_to_try);
+    }
+    
+}
+
+// --------------------------------------------------------
+///
+/// Queue the face-vertex pairs formed by the given triangle and the vertices near it for batched evaluation
+///
+// --------------------------------------------------------
+
+void MeshSnapper::add_face_vertex_candidates( size_t face, std::vector<Vec2st>& pending_pairs, ProximityBatch& batch,
+                                             std::vector<SortableProximity>& sortable_pairs_to_try )
+{
+    
+    Vec3d fmin, fmax;
+    m_surf.triangle_static_bounds(face, fmin, fmax);
+    fmin -= m_surf.m_merge_proximity_epsilon * Vec3d(1,1,1);
+    fmax += m_surf.m_merge_proximity_epsilon * Vec3d(1,1,1);
+    
+    std::vector<size_t> overlapping_verts;
+    m_surf.m_broad_phase->get_potential_vertex_collisions(fmin, fmax, false, true, overlapping_verts);
+    
+    const Vec3st& tri_data = m_surf.m_mesh.m_tris[face];
+    for(size_t i = 0; i < overlapping_verts.size(); ++i) {
+        size_t vertex = overlapping_verts[i];
+        
+        if(!face_vertex_pair_is_snap_candidate(face, vertex))
+            continue;
+        
+        pending_pairs.push_back(Vec2st(face, vertex));
+        batch.push_back(m_surf.get_position(vertex), 
+                        m_surf.get_position(tri_data[0]), 
+                        m_surf.get_position(tri_data[1]), 
+                        m_surf.get_position(tri_data[2]));
+        
+        if(batch.full())
+            add_snappable_pairs(pending_pairs, batch, true, sortable_pairs_to_try);
+    }
+    
+}
+
+// --------------------------------------------------------
+///
+/// Queue the edge-edge pairs formed by the given edge and the edges near it for batched evaluation.  Pairs are stored 
+/// with the lower numbered edge first.  If higher_only is set, only edges numbered above edge0 are paired with it, so 
+/// that a scan over all edges finds each pair once.
+///
+// --------------------------------------------------------
+
+void MeshSnapper::add_edge_edge_candidates( size_t edge0, bool higher_only, std::vector<Vec2st>& pending_pairs, ProximityBatch& batch,
+                                           std::vector<SortableProximity>& sortable_pairs_to_try )
+{
+    
+    Vec3d vmin, vmax;
+    m_surf.edge_static_bounds(edge0, vmin, vmax);
+    vmin -= m_surf.m_merge_proximity_epsilon * Vec3d(1,1,1);
+    vmax += m_surf.m_merge_proximity_epsilon * Vec3d(1,1,1);
+    
+    std::vector<size_t> overlapping_edges;
+    m_surf.m_broad_phase->get_potential_edge_collisions(vmin, vmax, false, true, overlapping_edges);
+    
+    for(size_t ind = 0; ind < overlapping_edges.size(); ++ind) {
+        size_t edge1 = overlapping_edges[ind];
+        
+        if(higher_only && edge0 >= edge1)
+            continue;
+        
+        if (!edge_pair_is_snap_candidate(edge0, edge1))
+            continue;
+        
+        size_t ea = std::min(edge0, edge1);
+        size_t eb = std::max(edge0, edge1);
+        const Vec2st& edge_data0 = m_surf.m_mesh.m_edges[ea];
+        const Vec2st& edge_data1 = m_surf.m_mesh.m_edges[eb];
+        pending_pairs.push_back(Vec2st(ea, eb));
+        batch.push_back(m_surf.get_position(edge_data0[0]), 
+                        m_surf.get_position(edge_data0[1]), 
+                        m_surf.get_position(edge_data1[0]), 
+                        m_surf.get_position(edge_data1[1]));
+        
+        if(batch.full())
+            add_snappable_pairs(pending_pairs, batch, false, sortable_pairs_to_try);
         
-        return true;
     }
-    else
-        return false;
     
 }
 
@@ -910,61 +1180,32 @@ bool MeshSnapper::snap_pass()
     //
     // get sets of geometry pairs to try snapping!
     //
+    // Pairs passing the topological tests are queued, and their proximities computed a batch at a time.
+    
+    std::vector<Vec2st> pending_pairs;
+    pending_pairs.reserve(PROXIMITY_BATCH_SIZE);
+    ProximityBatch batch;
     
     // first the face-vertex pairs
     for(size_t vertex = 0; vertex < m_surf.get_num_vertices(); ++vertex) {
         if(m_surf.m_mesh.vertex_is_deleted(vertex)) continue;
-        
-        Vec3d vmin, vmax;
-        m_surf.vertex_static_bounds(vertex, vmin, vmax);
-        vmin -= m_surf.m_merge_proximity_epsilon * Vec3d(1,1,1);
-        vmax += m_surf.m_merge_proximity_epsilon * Vec3d(1,1,1);
-        
-        std::vector<size_t> overlapping_tris;
-        m_surf.m_broad_phase->get_potential_triangle_collisions(vmin, vmax, false, true, overlapping_tris);
-        
-        for(size_t i = 0; i < overlapping_tris.size(); ++i) {
-            size_t face = overlapping_tris[i];
-            Vec3st tri_data = m_surf.m_mesh.m_tris[face];
-            
-            double len;
-            if(face_vertex_pair_is_snappable(face, vertex, len))
-            {
-                SortableProximity prox(face, vertex, len, true);
-                sortable_pairs_to_try.push_back(prox);
-            }
-        }
+        add_vertex_face_candidates(vertex, pending_pairs, batch, sortable_pairs_to_try);
     }
     
+    if(!batch.empty())
+        add_snappable_pairs(pending_pairs, batch, true, sortable_pairs_to_try);
+    
     //now the edge-edge pairs
     for(size_t edge0 = 0; edge0 < m_surf.m_mesh.m_edges.size(); ++edge0) {
         if(m_surf.m_mesh.edge_is_deleted(edge0)) continue;
         
-        Vec3d vmin, vmax;
-        m_surf.edge_static_bounds(edge0, vmin, vmax);
-        vmin -= m_surf.m_merge_proximity_epsilon * Vec3d(1,1,1);
-        vmax += m_surf.m_merge_proximity_epsilon * Vec3d(1,1,1);
-        
-        std::vector<size_t> overlapping_edges;
-        m_surf.m_broad_phase->get_potential_edge_collisions(vmin, vmax, false, true, overlapping_edges);
-        
-        for(size_t ind = 0; ind < overlapping_edges.size(); ++ind) {
-            size_t edge1 = overlapping_edges[ind];
-            
-            //always use the lower numbered edge, to avoid duplicates
-            if(edge0 >= edge1)
-                continue;
-            
-            double len;
-            if (edge_pair_is_snappable(edge0, edge1, len))
-            {
-                SortableProximity prox(edge0, edge1, len, false);
-                sortable_pairs_to_try.push_back(prox);
-            }
-            
-        }
+        //always use the lower numbered edge, to avoid duplicates
+        add_edge_edge_candidates(edge0, true, pending_pairs, batch, sortable_pairs_to_try);
     }
     
+    if(!batch.empty())
+        add_snappable_pairs(pending_pairs, batch, false, sortable_pairs_to_try);
+    
     //
     // sort in ascending order by distance (prefer to merge nearby geometry first)
     //
@@ -1045,6 +1286,207 @@ bool MeshSnapper::snap_pass()
     return snap_occurred;
     
 }
+
+namespace {
+
+/// Heap ordering putting the closest proximity on top
+///
+struct FartherProximity
+{
+    bool operator()( const SortableProximity& a, const SortableProximity& b ) const
+    {
+        return a.m_length > b.m_length;
+    }
+};
+
+typedef std::pair<std::pair<size_t, size_t>, bool> ProximityKey;
+
+inline ProximityKey proximity_key( const SortableProximity& p )
+{
+    return ProximityKey( std::make_pair( p.m_index0, p.m_index1 ), p.m_face_vert_proximity );
+}
+
+}
+
+// --------------------------------------------------------
+///
+/// Snap proximal geometry, closest pairs first, keeping the candidates in a priority queue.  After each snap attempt 
+/// only the neighbourhoods of the vertices it moved or created are queried again, so proximities formed by the snap are 
+/// tested immediately, in distance order, and the rest of the surface is never re-queried.
+///
+// --------------------------------------------------------
+
+bool MeshSnapper::snap_pass_queued()
+{
+    
+    if ( m_surf.m_verbose )
+    {
+        std::cout << "\n\n\n---------------------- MeshSnapper: queued collapsing ----------------------" << std::endl;
+        std::cout << "m_merge_proximity_epsilon: " << m_surf.m_merge_proximity_epsilon;
+        
+    }
+    
+    bool snap_occurred = false;
+    
+    assert( m_surf.m_dirty_triangles.size() == 0 );
+    
+    NonDestructiveTriMesh& mesh = m_surf.m_mesh;
+    
+    std::vector<SortableProximity> queue;
+    std::set<ProximityKey> queued;
+    
+    std::vector<Vec2st> pending_pairs;
+    pending_pairs.reserve(PROXIMITY_BATCH_SIZE);
+    ProximityBatch batch;
+    
+    // seed the queue with the same full scan as snap_pass()
+    
+    for(size_t vertex = 0; vertex < m_surf.get_num_vertices(); ++vertex) {
+        if(mesh.vertex_is_deleted(vertex)) continue;
+        add_vertex_face_candidates(vertex, pending_pairs, batch, queue);
+    }
+    
+    if(!batch.empty())
+        add_snappable_pairs(pending_pairs, batch, true, queue);
+    
+    for(size_t edge0 = 0; edge0 < mesh.m_edges.size(); ++edge0) {
+        if(mesh.edge_is_deleted(edge0)) continue;
+        add_edge_edge_candidates(edge0, true, pending_pairs, batch, queue);
+    }
+    
+    if(!batch.empty())
+        add_snappable_pairs(pending_pairs, batch, false, queue);
+    
+    for ( size_t i = 0; i < queue.size(); ++i )
+    {
+        queued.insert( proximity_key( queue[i] ) );
+    }
+    std::make_heap( queue.begin(), queue.end(), FartherProximity() );
+    
+    if ( m_surf.m_verbose )
+    {
+        std::cout << queue.size() << " candidate pairs queued" << std::endl;
+    }
+    
+    std::vector<SortableProximity> found_pairs;
+    std::vector<size_t> touched_vertices;
+    
+    while ( !queue.empty() )
+    {
+        std::pop_heap( queue.begin(), queue.end(), FartherProximity() );
+        SortableProximity pair = queue.back();
+        queue.pop_back();
+        queued.erase( proximity_key( pair ) );
+        
+        size_t ind0 = pair.m_index0;
+        size_t ind1 = pair.m_index1;
+        
+        double cur_len;
+        bool snappable = pair.m_face_vert_proximity ? face_vertex_pair_is_snappable(ind0, ind1, cur_len) :
+                                                      edge_pair_is_snappable(ind0, ind1, cur_len);
+        
+        if ( !snappable )
+        {
+            //Snapping not attempted because the situation changed.
+            if (m_surf.m_mesheventcallback)
+                m_surf.m_mesheventcallback->log() << "snap not attempted" << std::endl;
+            continue;
+        }
+        
+        // the pair moved apart after it was queued: put it back in its proper place
+        if ( cur_len > pair.m_length )
+        {
+            pair.m_length = cur_len;
+            queue.push_back( pair );
+            std::push_heap( queue.begin(), queue.end(), FartherProximity() );
+            queued.insert( proximity_key( pair ) );
+            continue;
+        }
+        
+        if(m_surf.m_mesheventcallback)
+            m_surf.m_mesheventcallback->log() << "Snap pair to try: " << (pair.m_face_vert_proximity ? "vf" : "ee") << " pair: " << ind0 << " and " << ind1 << " with distance " << cur_len << std::endl;
+        
+        size_t history_mark = m_surf.m_mesh_change_history.size();
+        
+        bool result = pair.m_face_vert_proximity ? snap_face_vertex_pair(ind0, ind1) : snap_edge_pair(ind0, ind1);
+        
+        if (m_surf.m_mesheventcallback)
+            m_surf.m_mesheventcallback->log() << (result ? "snap successful" : "snap failed") << std::endl;
+        
+        if ( result )
+        {
+            g_stats.add_to_int( "MeshSnapper:queued_snaps", 1 );
+        }
+        snap_occurred |= result;
+        
+        //
+        // find the vertices this attempt moved (the vertex kept by a snap) or created (by splits, even if the snap 
+        // itself then failed); everything whose proximities changed is incident to one of them
+        //
+        
+        touched_vertices.clear();
+        for ( size_t h = history_mark; h < m_surf.m_mesh_change_history.size(); ++h )
+        {
+            const MeshUpdateEvent& event = m_surf.m_mesh_change_history[h];
+            if ( event.m_type == MeshUpdateEvent::SNAP )
+            {
+                touched_vertices.push_back( event.m_v0 );
+            }
+            touched_vertices.insert( touched_vertices.end(), event.m_created_verts.begin(), event.m_created_verts.end() );
+        }
+        
+        if ( touched_vertices.empty() ) { continue; }
+        
+        std::sort( touched_vertices.begin(), touched_vertices.end() );
+        touched_vertices.erase( std::unique( touched_vertices.begin(), touched_vertices.end() ), touched_vertices.end() );
+        
+        found_pairs.clear();
+        
+        for ( size_t i = 0; i < touched_vertices.size(); ++i )
+        {
+            size_t vertex = touched_vertices[i];
+            if ( mesh.vertex_is_deleted(vertex) ) { continue; }
+            
+            add_vertex_face_candidates(vertex, pending_pairs, batch, found_pairs);
+            
+            const std::vector<size_t>& incident_tris = mesh.m_vertex_to_triangle_map[vertex];
+            for ( size_t j = 0; j < incident_tris.size(); ++j )
+            {
+                add_face_vertex_candidates(incident_tris[j], pending_pairs, batch, found_pairs);
+            }
+        }
+        
+        if(!batch.empty())
+            add_snappable_pairs(pending_pairs, batch, true, found_pairs);
+        
+        for ( size_t i = 0; i < touched_vertices.size(); ++i )
+        {
+            size_t vertex = touched_vertices[i];
+            if ( mesh.vertex_is_deleted(vertex) ) { continue; }
+            
+            const std::vector<size_t>& incident_edges = mesh.m_vertex_to_edge_map[vertex];
+            for ( size_t j = 0; j < incident_edges.size(); ++j )
+            {
+                add_edge_edge_candidates(incident_edges[j], false, pending_pairs, batch, found_pairs);
+            }
+        }
+        
+        if(!batch.empty())
+            add_snappable_pairs(pending_pairs, batch, false, found_pairs);
+        
+        for ( size_t i = 0; i < found_pairs.size(); ++i )
+        {
+            if ( !queued.insert( proximity_key( found_pairs[i] ) ).second ) { continue; }
+            
+            g_stats.add_to_int( "MeshSnapper:queued_new_proximities", 1 );
+            queue.push_back( found_pairs[i] );
+            std::push_heap( queue.begin(), queue.end(), FartherProximity() );
+        }
+    }
+    
+    return snap_occurred;
+    
+}
     
     
 }
@@ -29,7 +29,10 @@ namespace LosTopos {
 class SurfTrack;
 class FaceSplitter;
 class EdgeSplitter;
+struct ProximityBatch;
+struct SortableProximity;
 template<unsigned int N, class T> struct Vec;
+typedef Vec<2,size_t> Vec2st;
 typedef Vec<3,double> Vec3d;
 typedef Vec<3,size_t> Vec3st;
 
@@ -56,6 +59,10 @@ public:
     ///
     bool snap_pass();
     
+    /// Collapse all proximal vertices, closest first, using a locally updated priority queue of candidate pairs
+    ///
+    bool snap_pass_queued();
+    
   
 private:
     
@@ -116,6 +123,50 @@ private:
     ///
     bool face_vertex_pair_is_snappable( size_t vert0, size_t vert1, double& cur_length );
 
+    /// Topological tests for an edge pair (deleted, duplicate or adjacent edges)
+    ///
+    bool edge_pair_is_snap_candidate( size_t edge0, size_t edge1 );
+
+    /// Check that faces incident on both edges are not nearly coplanar
+    ///
+    bool edge_pair_faces_allow_snap( size_t edge0, size_t edge1 );
+
+    /// Given the edge pair's proximity query result, check the distance and "dimensional drop-down" cases
+    ///
+    bool edge_pair_proximity_allows_snap( size_t edge0, size_t edge1, double cur_length, double s0, double s2 );
+
+    /// Topological tests for a face-vertex pair (deleted elements, or the face containing the vertex)
+    ///
+    bool face_vertex_pair_is_snap_candidate( size_t face, size_t vertex );
+
+    /// Check that faces adjacent to the face and containing the vertex are not nearly coplanar with it
+    ///
+    bool face_vertex_pair_faces_allow_snap( size_t face, size_t vertex );
+
+    /// Given the face-vertex pair's proximity query result, check the distance and "dimensional drop-down" cases
+    ///
+    bool face_vertex_pair_proximity_allows_snap( size_t face, size_t vertex, double cur_length, double s0, double s1, double s2 );
+
+    /// Evaluate a batch of pending candidate pairs and append the snappable ones to the list to try
+    ///
+    void add_snappable_pairs( std::vector<Vec2st>& pending_pairs, ProximityBatch& batch, bool face_vert_proximity,
+                              std::vector<SortableProximity>& sortable_pairs_to_try );
+
+    /// Queue the face-vertex pairs of a vertex and its nearby triangles for evaluation
+    ///
+    void add_vertex_face_candidates( size_t vertex, std::vector<Vec2st>& pending_pairs, ProximityBatch& batch,
+                                     std::vector<SortableProximity>& sortable_pairs_to_try );
+
+    /// Queue the face-vertex pairs of a triangle and its nearby vertices for evaluation
+    ///
+    void add_face_vertex_candidates( size_t face, std::vector<Vec2st>& pending_pairs, ProximityBatch& batch,
+                                     std::vector<SortableProximity>& sortable_pairs_to_try );
+
+    /// Queue the edge-edge pairs of an edge and its nearby edges for evaluation, optionally only with higher numbered edges
+    ///
+    void add_edge_edge_candidates( size_t edge0, bool higher_only, std::vector<Vec2st>& pending_pairs, ProximityBatch& batch,
+                                   std::vector<SortableProximity>& sortable_pairs_to_try );
+
 
 
     /// Perform a split-n-merge operation on a face-vert pair
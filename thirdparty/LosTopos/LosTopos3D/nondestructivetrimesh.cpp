@@ -137,6 +137,8 @@ void NonDestructiveTriMesh::nondestructive_remove_triangle(size_t tri)
     // Mark the labels as invalid, for good measure.
     m_triangle_labels[tri] = Vec2i(-1,-1);
     
+    m_deleted_triangles.push_back( tri );
+    
 }
 
 
@@ -152,10 +154,28 @@ size_t NonDestructiveTriMesh::nondestructive_add_triangle( const Vec3st& tri, co
     assert( tri[1] < m_vertex_to_edge_map.size() );
     assert( tri[2] < m_vertex_to_edge_map.size() );
     
-    size_t idx = m_tris.size();
-    m_tris.push_back(tri);
-    m_triangle_to_edge_map.resize(idx+1);
-    m_triangle_labels.push_back(label);
+    size_t idx;
+    if ( !m_free_triangles.empty() )
+    {
+        // reuse a deleted slot
+        idx = m_free_triangles.back();
+        m_free_triangles.pop_back();
+        assert( triangle_is_deleted(idx) );
+        
+        m_tris[idx] = tri;
+        m_triangle_to_edge_map[idx] = Vec3st(0);
+        m_triangle_labels[idx] = label;
+        
+        for (size_t i = 0; i < m_fds.size(); i++)
+            m_fds[i]->reset(idx);
+    }
+    else
+    {
+        idx = m_tris.size();
+        m_tris.push_back(tri);
+        m_triangle_to_edge_map.resize(idx+1);
+        m_triangle_labels.push_back(label);
+    }
     
     ////////////////////////////////////////////////////////////
     
@@ -341,6 +361,21 @@ size_t NonDestructiveTriMesh::nondestructive_add_vertex( )
     assert( m_vertex_to_edge_map.size() == m_vertex_to_triangle_map.size() );
     assert( m_vertex_to_edge_map.size() == m_is_boundary_vertex.size() );
     
+    if ( !m_free_vertices.empty() )
+    {
+        // reuse a deleted slot
+        size_t idx = m_free_vertices.back();
+        m_free_vertices.pop_back();
+        assert( vertex_is_deleted(idx) && m_vertex_to_triangle_map[idx].empty() );
+        
+        m_is_boundary_vertex[idx] = false;
+        
+        for (size_t i = 0; i < m_vds.size(); i++)
+            m_vds[i]->reset(idx);
+        
+        return idx;
+    }
+    
     m_vertex_to_edge_map.resize( m_vertex_to_edge_map.size() + 1 );
     m_vertex_to_triangle_map.resize( m_vertex_to_triangle_map.size() + 1 );
     m_is_boundary_vertex.resize( m_is_boundary_vertex.size() + 1 );
@@ -370,6 +405,8 @@ void NonDestructiveTriMesh::nondestructive_remove_vertex(size_t vtx)
     }
     
     m_vertex_to_edge_map[vtx].clear();   //edges incident on vertices
+    
+    m_deleted_vertices.push_back( vtx );
 }
 
 
@@ -403,12 +440,109 @@ void NonDestructiveTriMesh::set_num_vertices( size_t num_vertices )
     m_vertex_to_edge_map.resize( num_vertices );
     m_vertex_to_triangle_map.resize( num_vertices );
     m_is_boundary_vertex.resize( num_vertices );
+    
+    // deleted slots may have been cut off
+    m_free_vertices.clear();
+    m_deleted_vertices.clear();
 
     test_connectivity();
     
 }
 
 
+// ---------------------------------------------------------
+///
+/// Make the slots of elements deleted since the last call available for reuse.  Slots which have been brought back to 
+/// life in the meantime (or reported more than once) are skipped.
+///
+// ---------------------------------------------------------
+
+void NonDestructiveTriMesh::recycle_deleted_elements()
+{
+    std::sort( m_deleted_vertices.begin(), m_deleted_vertices.end() );
+    m_deleted_vertices.erase( std::unique( m_deleted_vertices.begin(), m_deleted_vertices.end() ), m_deleted_vertices.end() );
+    for ( size_t i = 0; i < m_deleted_vertices.size(); ++i )
+    {
+        size_t v = m_deleted_vertices[i];
+        if ( v < nv() && vertex_is_deleted(v) && m_vertex_to_triangle_map[v].empty() )
+        {
+            m_free_vertices.push_back( v );
+        }
+    }
+    m_deleted_vertices.clear();
+    
+    std::sort( m_deleted_edges.begin(), m_deleted_edges.end() );
+    m_deleted_edges.erase( std::unique( m_deleted_edges.begin(), m_deleted_edges.end() ), m_deleted_edges.end() );
+    for ( size_t i = 0; i < m_deleted_edges.size(); ++i )
+    {
+        size_t e = m_deleted_edges[i];
+        if ( e < ne() && edge_is_deleted(e) && m_edge_to_triangle_map[e].empty() )
+        {
+            m_free_edges.push_back( e );
+        }
+    }
+    m_deleted_edges.clear();
+    
+    std::sort( m_deleted_triangles.begin(), m_deleted_triangles.end() );
+    m_deleted_triangles.erase( std::unique( m_deleted_triangles.begin(), m_deleted_triangles.end() ), m_deleted_triangles.end() );
+    for ( size_t i = 0; i < m_deleted_triangles.size(); ++i )
+    {
+        size_t t = m_deleted_triangles[i];
+        if ( t < nt() && triangle_is_deleted(t) )
+        {
+            m_free_triangles.push_back( t );
+        }
+    }
+    m_deleted_triangles.clear();
+}
+
+
+// ---------------------------------------------------------
+///
+/// Forget all deleted slots
+///
+// ---------------------------------------------------------
+
+void NonDestructiveTriMesh::clear_free_lists()
+{
+    m_free_vertices.clear();
+    m_free_edges.clear();
+    m_free_triangles.clear();
+    m_deleted_vertices.clear();
+    m_deleted_edges.clear();
+    m_deleted_triangles.clear();
+}
+
+
+// ---------------------------------------------------------
+///
+/// Fraction of vertex, edge or triangle slots (whichever is largest) holding deleted elements.  Counts are taken from 
+/// the free lists, so this is cheap, and exact as long as recycle_deleted_elements() has been called since the last 
+/// deletion.
+///
+// ---------------------------------------------------------
+
+double NonDestructiveTriMesh::deleted_fraction() const
+{
+    double fraction = 0.0;
+    
+    if ( nv() > 0 )
+    {
+        fraction = std::max( fraction, (double)( m_free_vertices.size() + m_deleted_vertices.size() ) / (double) nv() );
+    }
+    if ( ne() > 0 )
+    {
+        fraction = std::max( fraction, (double)( m_free_edges.size() + m_deleted_edges.size() ) / (double) ne() );
+    }
+    if ( nt() > 0 )
+    {
+        fraction = std::max( fraction, (double)( m_free_triangles.size() + m_deleted_triangles.size() ) / (double) nt() );
+    }
+    
+    return fraction;
+}
+
+
 // ---------------------------------------------------------
 ///
 /// Query primitive counts
@@ -451,12 +585,29 @@ size_t NonDestructiveTriMesh::nt() const
 size_t NonDestructiveTriMesh::nondestructive_add_edge(size_t vtx0, size_t vtx1)
 {
     
-    size_t edge_index = m_edges.size();
-    m_edges.push_back(Vec2st(vtx0, vtx1));
-    
-    m_edge_to_triangle_map.push_back( std::vector<size_t>( 0 ) );
-    
-    m_is_boundary_edge.push_back( true );
+    size_t edge_index;
+    if ( !m_free_edges.empty() )
+    {
+        // reuse a deleted slot
+        edge_index = m_free_edges.back();
+        m_free_edges.pop_back();
+        assert( edge_is_deleted(edge_index) && m_edge_to_triangle_map[edge_index].empty() );
+        
+        m_edges[edge_index] = Vec2st(vtx0, vtx1);
+        m_is_boundary_edge[edge_index] = true;
+        
+        for (size_t i = 0; i < m_eds.size(); i++)
+            m_eds[i]->reset(edge_index);
+    }
+    else
+    {
+        edge_index = m_edges.size();
+        m_edges.push_back(Vec2st(vtx0, vtx1));
+        
+        m_edge_to_triangle_map.push_back( std::vector<size_t>( 0 ) );
+        
+        m_is_boundary_edge.push_back( true );
+    }
     
     m_vertex_to_edge_map[vtx0].push_back(edge_index);
     m_vertex_to_edge_map[vtx1].push_back(edge_index);
@@ -502,6 +653,8 @@ void NonDestructiveTriMesh::nondestructive_remove_edge( size_t edge_index )
     m_edges[edge_index][0] = 0;
     m_edges[edge_index][1] = 0; 
     
+    m_deleted_edges.push_back( edge_index );
+    
 }
 
 
@@ -688,6 +841,8 @@ void NonDestructiveTriMesh::clear_connectivity()
     m_is_boundary_edge.clear();
     m_is_boundary_vertex.clear();
     
+    clear_free_lists();
+    
 }
 
 
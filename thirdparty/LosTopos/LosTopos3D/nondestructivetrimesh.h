@@ -5,8 +5,9 @@
 //  Christopher Batty, Fang Da 2014
 //
 //  The graph of a triangle surface mesh (no spatial information).  Elements can be added and 
-//  removed dynamically.  Removing elements leaves empty space in the data structures, but they 
-//  can be defragmented by updating the connectivity information (rebuilding the mesh).
+//  removed dynamically.  Removing elements leaves empty space in the data structures, which can 
+//  be reused by later additions once recycled, or defragmented by updating the connectivity 
+//  information (rebuilding the mesh).
 //
 // ---------------------------------------------------------
 
@@ -217,7 +218,7 @@ public:
     
     /// Return the vertex incident on two edges.  Returns ~0 if edges are not adjacent.
     ///
-    inline size_t get_common_vertex( size_t edge_a, size_t edge_b );
+    inline size_t get_common_vertex( size_t edge_a, size_t edge_b ) const;
 
     /// Determine if two triangles are adjacent (if they share an edge)
     ///
@@ -247,6 +248,20 @@ public:
     ///
     void test_connectivity() const;
     
+    /// Make the slots of elements deleted since the last call available for reuse by subsequent additions.  Slots are 
+    /// not reused right away, so indices of elements deleted during an operation stay unambiguous until the caller 
+    /// decides they are no longer referenced.
+    ///
+    void recycle_deleted_elements();
+    
+    /// Forget all deleted slots (e.g. after the mesh has been defragmented)
+    ///
+    void clear_free_lists();
+    
+    /// Fraction of vertex, edge or triangle slots (whichever is largest) holding deleted elements
+    ///
+    double deleted_fraction() const;
+    
     //
     // Data members
     //
@@ -287,6 +302,15 @@ public:
     ///
     std::vector<Vec3st> m_tris;
     
+    /// Deleted slots available for reuse by nondestructive_add_vertex, nondestructive_add_edge and 
+    /// nondestructive_add_triangle
+    ///
+    std::vector<size_t> m_free_vertices, m_free_edges, m_free_triangles;
+    
+    /// Slots deleted since the last call to recycle_deleted_elements()
+    ///
+    std::vector<size_t> m_deleted_vertices, m_deleted_edges, m_deleted_triangles;
+    
     ///////////////////////////////////////
     /// Attached data
     
@@ -300,6 +324,7 @@ public:
         virtual size_t size() const = 0;
         virtual void resize(size_t n) = 0;
         virtual void compress(const std::vector<int> & map) = 0;
+        virtual void reset(size_t i) = 0;
 
     protected:
         NonDestructiveTriMesh * m_mesh;
@@ -317,6 +342,7 @@ public:
         size_t size() const { return m_data.size(); }
         void resize(size_t n) { m_data.resize(n); }
         void compress(const std::vector<int> & map) { assert(map.size() == m_data.size()); for (size_t i = 0; i < map.size(); i++) if (map[i] >= 0) m_data[map[i]] = m_data[i]; }   // map needs to be in ascending order
+        void reset(size_t i) { m_data[i] = T(); }   // restore a reused slot to the value a newly appended one would have
 
     protected:
     public:
@@ -333,6 +359,7 @@ public:
         virtual size_t size() const = 0;
         virtual void resize(size_t n) = 0;
         virtual void compress(const std::vector<int> & map) = 0;
+        virtual void reset(size_t i) = 0;
         
     protected:
         NonDestructiveTriMesh * m_mesh;
@@ -350,6 +377,7 @@ public:
         size_t size() const { return m_data.size(); }
         void resize(size_t n) { m_data.resize(n); }
         void compress(const std::vector<int> & map) { assert(map.size() == m_data.size()); for (size_t i = 0; i < map.size(); i++) if (map[i] >= 0) m_data[map[i]] = m_data[i]; }   // map needs to be in ascending order
+        void reset(size_t i) { m_data[i] = T(); }   // restore a reused slot to the value a newly appended one would have
 
     protected:
         std::vector<T> m_data;
@@ -365,6 +393,7 @@ public:
         virtual size_t size() const = 0;
         virtual void resize(size_t n) = 0;
         virtual void compress(const std::vector<int> & map) = 0;
+        virtual void reset(size_t i) = 0;
         
     protected:
         NonDestructiveTriMesh * m_mesh;
@@ -382,6 +411,7 @@ public:
         size_t size() const { return m_data.size(); }
         void resize(size_t n) { m_data.resize(n); }
         void compress(const std::vector<int> & map) { assert(map.size() == m_data.size()); for (size_t i = 0; i < map.size(); i++) if (map[i] >= 0) m_data[map[i]] = m_data[i]; }   // map needs to be in ascending order
+        void reset(size_t i) { m_data[i] = T(); }   // restore a reused slot to the value a newly appended one would have
 
     protected:
         std::vector<T> m_data;
@@ -889,7 +919,7 @@ inline size_t NonDestructiveTriMesh::get_common_edge( size_t triangle_a, size_t
 ///
 // --------------------------------------------------------
 
-inline size_t NonDestructiveTriMesh::get_common_vertex( size_t edge_a, size_t edge_b )
+inline size_t NonDestructiveTriMesh::get_common_vertex( size_t edge_a, size_t edge_b ) const
 {
   const Vec2st& edge_a_verts = m_edges[edge_a];
   const Vec2st& edge_b_verts = m_edges[edge_b];
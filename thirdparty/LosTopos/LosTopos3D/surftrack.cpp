@@ -16,6 +16,7 @@
 
 #include <surftrack.h>
 
+#include <algorithm>
 #include <array3.h>
 #include <broadphase.h>
 #include <cassert>
@@ -78,11 +79,17 @@ m_perform_smoothing( true ),
 m_merge_proximity_epsilon( 1e-5 ),
 m_subdivision_scheme(NULL),
 m_collision_safety(true),
+m_use_hashed_broad_phase(false),
+m_localized_rollback(false),
 m_allow_topology_changes(true),
 m_allow_non_manifold(true),
 m_perform_improvement(true),
 m_remesh_boundaries(true),
 m_pull_apart_distance(0.1),
+m_defrag_threshold(0.0),
+m_queued_remeshing(false),
+m_queued_snapping(false),
+m_parallel_smoothing(false),
 m_verbose(false)
 {}
 
@@ -110,7 +117,8 @@ DynamicSurface( vs,
                initial_parameters.m_proximity_epsilon,
                initial_parameters.m_friction_coefficient,
                initial_parameters.m_collision_safety,
-               initial_parameters.m_verbose),
+               initial_parameters.m_verbose,
+               initial_parameters.m_use_hashed_broad_phase),
 
 m_collapser( *this, initial_parameters.m_use_curvature_when_collapsing, initial_parameters.m_remesh_boundaries, initial_parameters.m_min_curvature_multiplier ),
 m_splitter( *this, initial_parameters.m_use_curvature_when_splitting, initial_parameters.m_remesh_boundaries, initial_parameters.m_max_curvature_multiplier ),
@@ -143,12 +151,21 @@ m_remesh_boundaries( initial_parameters.m_remesh_boundaries),
 m_aggressive_mode(false),
 m_allow_vertex_movement_during_collapse( initial_parameters.m_allow_vertex_movement_during_collapse ),
 m_perform_smoothing( initial_parameters.m_perform_smoothing),
+m_defrag_threshold( initial_parameters.m_defrag_threshold ),
+m_queued_remeshing( initial_parameters.m_queued_remeshing ),
+m_queued_snapping( initial_parameters.m_queued_snapping ),
+m_parallel_smoothing( initial_parameters.m_parallel_smoothing ),
 m_mesheventcallback(NULL),
 m_solid_vertices_callback(NULL),
+m_sizing_field_callback(NULL),
 m_vertex_change_history(),
 m_triangle_change_history(),
 m_defragged_triangle_map(),
-m_defragged_vertex_map()
+m_defragged_vertex_map(),
+m_junction_index_valid(false),
+m_junction_vertices(),
+m_junction_slots(),
+m_junction_dirty_vertices()
 {
     
     if ( m_verbose )
@@ -160,6 +177,8 @@ m_defragged_vertex_map()
         std::cout << "initial_parameters.m_use_fraction: " << initial_parameters.m_use_fraction << std::endl;
     }
     
+    m_localized_rollback = initial_parameters.m_localized_rollback;
+    
     if ( m_collision_safety )
     {
         rebuild_static_broad_phase();
@@ -254,6 +273,7 @@ SurfTrack::~SurfTrack()
 size_t SurfTrack::add_triangle( const Vec3st& t, const Vec2i& label )
 {
     size_t new_triangle_index = m_mesh.nondestructive_add_triangle( t, label );
+    mark_junction_vertices_dirty( new_triangle_index );
     
     assert( t[0] < get_num_vertices() );
     assert( t[1] < get_num_vertices() );
@@ -298,6 +318,7 @@ size_t SurfTrack::add_triangle( const Vec3st& t, const Vec2i& label )
 
 void SurfTrack::remove_triangle(size_t t)
 {
+    mark_junction_vertices_dirty( t );
     m_mesh.nondestructive_remove_triangle( t );
     if ( m_collision_safety )
     {
@@ -386,6 +407,317 @@ void SurfTrack::remove_vertex( size_t vertex_index )
 }
 
 
+// ---------------------------------------------------------
+///
+/// Determine if moving a single vertex from oldpos to newpos, with the rest of the mesh held still, introduces a 
+/// collision or brings the vertex's incident elements closer than m_improve_collision_epsilon to other geometry.
+/// Only reads the mesh and broad phase, so concurrent calls are safe while nothing is modified.
+///
+// ---------------------------------------------------------
+
+bool SurfTrack::vertex_pseudo_motion_introduces_collision(size_t v, const Vec3d & oldpos, const Vec3d & newpos) const
+{
+    // code adapted from EdgeSplitter::split_edge_pseudo_motion_introduces_intersection()
+    
+    if (!m_collision_safety)
+        return false;
+    
+    const std::vector<Vec3d> & x = get_positions();
+    
+    const std::vector<size_t> & tris = m_mesh.m_vertex_to_triangle_map[v];
+    const std::vector<size_t> & edges = m_mesh.m_vertex_to_edge_map[v];
+    std::vector<size_t> edge_other_endpoints(edges.size());
+    
+    for (size_t i = 0; i < edges.size(); i++)
+        edge_other_endpoints[i] = (m_mesh.m_edges[edges[i]][0] == v ? m_mesh.m_edges[edges[i]][1] : m_mesh.m_edges[edges[i]][0]);
+    
+    // new point vs all triangles
+    {
+        
+        Vec3d aabb_low, aabb_high;
+        minmax(oldpos, newpos, aabb_low, aabb_high);
+        
+        aabb_low  -= m_aabb_padding * Vec3d(1,1,1);
+        aabb_high += m_aabb_padding * Vec3d(1,1,1);
+        
+        std::vector<size_t> overlapping_triangles;
+        m_broad_phase->get_potential_triangle_collisions(aabb_low, aabb_high, true, true, overlapping_triangles);
+        
+        for (size_t i = 0; i < overlapping_triangles.size(); i++)
+        {
+            // exclude incident triangles
+            if (m_mesh.get_triangle(overlapping_triangles[i])[0] == v ||
+                m_mesh.get_triangle(overlapping_triangles[i])[1] == v ||
+                m_mesh.get_triangle(overlapping_triangles[i])[2] == v)
+                continue;
+            
+            Vec3st sorted_triangle = sort_triangle(m_mesh.get_triangle(overlapping_triangles[i]));
+            size_t a = sorted_triangle[0];
+            size_t b = sorted_triangle[1];
+            size_t c = sorted_triangle[2];
+            
+            double t_zero_distance;
+            check_point_triangle_proximity(oldpos, x[a], x[b], x[c], t_zero_distance);
+            if (t_zero_distance < m_improve_collision_epsilon)
+                return true;
+            
+            if (point_triangle_collision(oldpos, newpos, v, x[a], x[a], a, x[b], x[b], b, x[c], x[c], c))
+            {
+                if (m_verbose)
+                    std::cout << "Vertex pseudo-motion collision: point triangle: with triangle " << overlapping_triangles[i] << std::endl;
+                return true;
+            }
+        }
+        
+    }
+    
+    // new edges vs all edges
+    {
+        Vec3d edge_aabb_low, edge_aabb_high;
+        
+        // do one big query into the broad phase for all new edges
+        minmax(oldpos, newpos, edge_aabb_low, edge_aabb_high);
+        for (size_t i = 0; i < edge_other_endpoints.size(); ++i)
+            update_minmax(get_position(edge_other_endpoints[i]), edge_aabb_low, edge_aabb_high);
+        
+        edge_aabb_low  -= m_aabb_padding * Vec3d(1,1,1);
+        edge_aabb_high += m_aabb_padding * Vec3d(1,1,1);
+        
+        std::vector<size_t> overlapping_edges;
+        m_broad_phase->get_potential_edge_collisions(edge_aabb_low, edge_aabb_high, true, true, overlapping_edges);
+        
+        for (size_t i = 0; i < overlapping_edges.size(); i++)
+        {
+            if (m_mesh.m_edges[overlapping_edges[i]][0] == m_mesh.m_edges[overlapping_edges[i]][1])
+                continue;
+            
+            for (size_t j = 0; j < edges.size(); j++)
+            {
+                // exclude adjacent edges
+                if (m_mesh.get_common_vertex(edges[j], overlapping_edges[i]) < m_mesh.nv())
+                    continue;
+                
+                size_t n = edge_other_endpoints[j];
+                size_t e0 = m_mesh.m_edges[overlapping_edges[i]][0];
+                size_t e1 = m_mesh.m_edges[overlapping_edges[i]][1];
+                if (e0 > e1)
+                    std::swap(e0, e1);
+                
+                double t_zero_distance;
+                check_edge_edge_proximity(oldpos, x[n], x[e0], x[e1], t_zero_distance);
+                if (t_zero_distance < m_improve_collision_epsilon)
+                    return true;
+                
+                bool collision = (n < v ?
+                                  segment_segment_collision(x[n], x[n], n, oldpos, newpos, v, x[e0], x[e0], e0, x[e1], x[e1], e1) :
+                                  segment_segment_collision(oldpos, newpos, v, x[n], x[n], n, x[e0], x[e0], e0, x[e1], x[e1], e1));
+                
+                if (collision)
+                {
+                    if (m_verbose)
+                        std::cout << "Vertex pseudo-motion collision: edge edge: edge other vertex = " << edge_other_endpoints[j] << " edge = " << overlapping_edges[i] << std::endl;
+                    return true;
+                }
+            }
+        }
+    }
+    
+    // new triangles vs all points
+    {
+        Vec3d triangle_aabb_low, triangle_aabb_high;
+        
+        // do one big query into the broad phase for all new triangles
+        minmax(oldpos, newpos, triangle_aabb_low, triangle_aabb_high);
+        for (size_t i = 0; i < edge_other_endpoints.size(); ++i)
+            update_minmax(get_position(edge_other_endpoints[i]), triangle_aabb_low, triangle_aabb_high);
+        
+        triangle_aabb_low  -= m_aabb_padding * Vec3d(1,1,1);
+        triangle_aabb_high += m_aabb_padding * Vec3d(1,1,1);
+        
+        std::vector<size_t> overlapping_vertices;
+        m_broad_phase->get_potential_vertex_collisions(triangle_aabb_low, triangle_aabb_high, true, true, overlapping_vertices);
+        
+        for (size_t i = 0; i < overlapping_vertices.size(); i++)
+        {
+            if (m_mesh.m_vertex_to_triangle_map[overlapping_vertices[i]].empty())
+                continue;
+            
+            const Vec3d & vert = get_position(overlapping_vertices[i]);
+            
+            for (size_t j = 0; j < tris.size(); j++)
+            {
+                // exclude incident triangles
+                if (m_mesh.get_triangle(tris[j])[0] == overlapping_vertices[i] ||
+                    m_mesh.get_triangle(tris[j])[1] == overlapping_vertices[i] ||
+                    m_mesh.get_triangle(tris[j])[2] == overlapping_vertices[i])
+                    continue;
+                
+                Vec3st sorted_triangle = sort_triangle(m_mesh.get_triangle(tris[j]));
+                size_t a = sorted_triangle[0];
+                size_t b = sorted_triangle[1];
+                size_t c = sorted_triangle[2];
+                
+                Vec3d oldxa = (a == v ? oldpos : x[a]);
+                Vec3d newxa = (a == v ? newpos : x[a]);
+                Vec3d oldxb = (b == v ? oldpos : x[b]);
+                Vec3d newxb = (b == v ? newpos : x[b]);
+                Vec3d oldxc = (c == v ? oldpos : x[c]);
+                Vec3d newxc = (c == v ? newpos : x[c]);
+                
+                double t_zero_distance;
+                check_point_triangle_proximity(vert, oldxa, oldxb, oldxc, t_zero_distance);
+                if (t_zero_distance < m_improve_collision_epsilon)
+                    return true;
+                
+                if (point_triangle_collision(vert, vert, overlapping_vertices[i], oldxa, newxa, a, oldxb, newxb, b, oldxc, newxc, c))
+                {
+                    if (m_verbose)
+                        std::cout << "Vertex pseudo-motion collision: triangle point: with triangle " << tris[j] << " with vertex " << overlapping_vertices[i] << std::endl;
+                    return true;
+                }
+            }
+        }
+    }
+    
+    return false;
+}
+
+// ---------------------------------------------------------
+///
+/// Scale factor for the edge length bounds at an edge, from the sizing field callback.  The finer end of the edge wins,
+/// so that an edge is split (and not collapsed) whenever either of its vertices asks for it.
+///
+// ---------------------------------------------------------
+
+double SurfTrack::get_edge_length_scale( size_t edge_index ) const
+{
+    if ( !m_sizing_field_callback ) { return 1.0; }
+    
+    const Vec2st& e = m_mesh.m_edges[edge_index];
+    double scale0 = m_sizing_field_callback->edge_length_scale( *this, e[0] );
+    double scale1 = m_sizing_field_callback->edge_length_scale( *this, e[1] );
+    
+    if ( !( scale0 > 0 ) ) { scale0 = 1.0; }
+    if ( !( scale1 > 0 ) ) { scale1 = 1.0; }
+    
+    return min( scale0, scale1 );
+}
+
+// ---------------------------------------------------------
+///
+/// Flag the vertices of a triangle for re-examination by the junction index.  Nothing is recorded while the index is 
+/// invalid, since it will be rebuilt from scratch anyway.
+///
+// ---------------------------------------------------------
+
+void SurfTrack::mark_junction_vertices_dirty( size_t triangle_index )
+{
+    if ( !m_junction_index_valid ) { return; }
+    
+    const Vec3st& tri = m_mesh.get_triangle( triangle_index );
+    m_junction_dirty_vertices.push_back( tri[0] );
+    m_junction_dirty_vertices.push_back( tri[1] );
+    m_junction_dirty_vertices.push_back( tri[2] );
+}
+
+// ---------------------------------------------------------
+///
+/// Number of distinct regions on the triangles incident to a vertex
+///
+// ---------------------------------------------------------
+
+size_t SurfTrack::get_num_incident_regions( size_t vertex_index ) const
+{
+    const std::vector<size_t>& incident_tris = m_mesh.m_vertex_to_triangle_map[vertex_index];
+    
+    std::vector<int> regions;
+    regions.reserve( 2 * incident_tris.size() );
+    for ( size_t i = 0; i < incident_tris.size(); ++i )
+    {
+        const Vec2i& label = m_mesh.get_triangle_label( incident_tris[i] );
+        regions.push_back( label[0] );
+        regions.push_back( label[1] );
+    }
+    
+    std::sort( regions.begin(), regions.end() );
+    return std::unique( regions.begin(), regions.end() ) - regions.begin();
+}
+
+// ---------------------------------------------------------
+///
+/// Add or remove a vertex from the junction list, keeping the per-vertex slots consistent
+///
+// ---------------------------------------------------------
+
+void SurfTrack::set_vertex_is_junction( size_t vertex_index, bool is_junction )
+{
+    const size_t NOT_A_JUNCTION = static_cast<size_t>(~0);
+    
+    if ( vertex_index >= m_junction_slots.size() )
+    {
+        m_junction_slots.resize( vertex_index + 1, NOT_A_JUNCTION );
+    }
+    
+    size_t slot = m_junction_slots[vertex_index];
+    
+    if ( is_junction && slot == NOT_A_JUNCTION )
+    {
+        m_junction_slots[vertex_index] = m_junction_vertices.size();
+        m_junction_vertices.push_back( vertex_index );
+    }
+    else if ( !is_junction && slot != NOT_A_JUNCTION )
+    {
+        size_t moved = m_junction_vertices.back();
+        m_junction_vertices[slot] = moved;
+        m_junction_slots[moved] = slot;
+        m_junction_vertices.pop_back();
+        m_junction_slots[vertex_index] = NOT_A_JUNCTION;
+    }
+}
+
+// ---------------------------------------------------------
+///
+/// Bring the junction index up to date and return the junction vertices.  Only vertices flagged since the last call are 
+/// re-examined, unless the index has been invalidated (initially, and by defragmentation).
+///
+// ---------------------------------------------------------
+
+const std::vector<size_t>& SurfTrack::get_junction_vertices()
+{
+    if ( !m_junction_index_valid )
+    {
+        m_junction_vertices.clear();
+        m_junction_slots.assign( get_num_vertices(), static_cast<size_t>(~0) );
+        m_junction_dirty_vertices.clear();
+        
+        for ( size_t v = 0; v < get_num_vertices(); ++v )
+        {
+            if ( get_num_incident_regions( v ) >= 3 )
+            {
+                set_vertex_is_junction( v, true );
+            }
+        }
+        
+        m_junction_index_valid = true;
+        g_stats.add_to_int( "SurfTrack:junction_index_rebuilds", 1 );
+        return m_junction_vertices;
+    }
+    
+    std::sort( m_junction_dirty_vertices.begin(), m_junction_dirty_vertices.end() );
+    m_junction_dirty_vertices.erase( std::unique( m_junction_dirty_vertices.begin(), m_junction_dirty_vertices.end() ), m_junction_dirty_vertices.end() );
+    
+    for ( size_t i = 0; i < m_junction_dirty_vertices.size(); ++i )
+    {
+        size_t v = m_junction_dirty_vertices[i];
+        set_vertex_is_junction( v, v < get_num_vertices() && get_num_incident_regions( v ) >= 3 );
+    }
+    
+    g_stats.add_to_int( "SurfTrack:junction_index_updates", m_junction_dirty_vertices.size() );
+    m_junction_dirty_vertices.clear();
+    
+    return m_junction_vertices;
+}
+
 // ---------------------------------------------------------
 ///
 /// Remove deleted vertices and triangles from the mesh data structures
@@ -395,6 +727,7 @@ void SurfTrack::remove_vertex( size_t vertex_index )
 void SurfTrack::defrag_mesh( )
 {
     assert(!"depcrated; use defrag_mesh_from_scratch() instead.");
+    m_junction_index_valid = false;
     
     //
     // First clear deleted vertices from the data structures
@@ -500,11 +833,48 @@ void SurfTrack::defrag_mesh_from_scratch(std::vector<size_t> & vertices_to_be_ma
 {
     defrag_mesh_from_scratch_manual(vertices_to_be_mapped);
 }
+
+// ---------------------------------------------------------
+///
+/// Hand the slots of elements deleted since the last call over to the mesh free lists, so that subsequent additions 
+/// reuse them, and only defragment from scratch once the fraction of deleted slots exceeds m_defrag_threshold.
+/// Vertex indices of live vertices stay valid across calls which don't defragment.  Returns true if the mesh was 
+/// defragmented, in which case vertices_to_be_mapped has been remapped.
+///
+// ---------------------------------------------------------
+
+bool SurfTrack::defrag_mesh_incremental(std::vector<size_t> & vertices_to_be_mapped)
+{
+    if ( m_mesh.deleted_fraction() > m_defrag_threshold )
+    {
+        defrag_mesh_from_scratch(vertices_to_be_mapped);
+        g_stats.add_to_int( "SurfTrack:full_defrags", 1 );
+        return true;
+    }
+    
+    // Deleted edges are never taken out of the broad phase; do it now, before their slots get reused
+    if ( m_collision_safety )
+    {
+        for ( size_t i = 0; i < m_mesh.m_deleted_edges.size(); ++i )
+        {
+            m_broad_phase->remove_edge( m_mesh.m_deleted_edges[i] );
+        }
+    }
+    
+    m_mesh.recycle_deleted_elements();
+    g_stats.add_to_int( "SurfTrack:incremental_defrags", 1 );
+    
+    return false;
+}
     
 void SurfTrack::defrag_mesh_from_scratch_manual(std::vector<size_t> & vertices_to_be_mapped)
 {
     double start_time = get_time_in_seconds();
     
+    // bring the junction index up to date, so it can simply be renumbered along with the vertices
+    if (m_junction_index_valid)
+        get_junction_vertices();
+    
     // defragment vertices
     std::vector<int> vm(get_num_vertices(), -1);
     size_t j = 0;
@@ -515,6 +885,17 @@ void SurfTrack::defrag_mesh_from_scratch_manual(std::vector<size_t> & vertices_t
     for (size_t i = 0; i < vertices_to_be_mapped.size(); i++)
         vertices_to_be_mapped[i] = vm[vertices_to_be_mapped[i]];
     
+    if (m_junction_index_valid)
+    {
+        m_junction_slots.assign(j, static_cast<size_t>(~0));
+        for (size_t i = 0; i < m_junction_vertices.size(); i++)
+        {
+            assert(vm[m_junction_vertices[i]] >= 0);    // a junction vertex has incident triangles, so it is not deleted
+            m_junction_vertices[i] = vm[m_junction_vertices[i]];
+            m_junction_slots[m_junction_vertices[i]] = i;
+        }
+    }
+    
     for (size_t i = 0; i < m_mesh.m_vds.size(); i++)
     {
         m_mesh.m_vds[i]->compress(vm);
@@ -663,6 +1044,8 @@ void SurfTrack::defrag_mesh_from_scratch_manual(std::vector<size_t> & vertices_t
         }
     }
     
+    m_mesh.clear_free_lists();
+    
     double end_time = get_time_in_seconds();
     g_stats.add_to_double("total_defrag_time", end_time - start_time);
 
@@ -679,6 +1062,9 @@ void SurfTrack::defrag_mesh_from_scratch_copy(std::vector<size_t> & vertices_to_
 {
     double start_time = get_time_in_seconds();
     
+    // vertices are renumbered; the junction index is rebuilt on next use
+    m_junction_index_valid = false;
+    
     // defragment vertices
     std::vector<int> vm(get_num_vertices(), -1);
     size_t j = 0;
@@ -1077,6 +1463,7 @@ void SurfTrack::trim_degeneracies( std::vector<size_t>& triangle_indices )
                             m_mesh.set_triangle_label(i, Vec2i(region_0, region_1));
                         else
                             m_mesh.set_triangle_label(i, Vec2i(region_1, region_0));
+                        mark_junction_vertices_dirty(i);
                         
                         dirty.push_back(std::pair<size_t, Vec2i>(i, m_mesh.get_triangle_label(i)));
                     }
@@ -1138,7 +1525,7 @@ void SurfTrack::improve_mesh( )
         
         // edge splitting
         //std::cout << "Splits\n";
-        while ( m_splitter.split_pass() ) {
+        while ( m_queued_remeshing ? m_splitter.split_pass_queued() : m_splitter.split_pass() ) {
             if (m_mesheventcallback)
                 m_mesheventcallback->log() << "Split pass " << i << " finished" << std::endl;
             i++;
@@ -1155,11 +1542,21 @@ void SurfTrack::improve_mesh( )
         // edge collapsing
         i = 0;
         //std::cout << "Collapses\n";
-        while ( m_collapser.collapse_pass() ) {
+        if ( m_queued_remeshing )
+        {
+            // runs to completion in one call
+            m_collapser.collapse_pass_queued();
             if (m_mesheventcallback)
-                m_mesheventcallback->log() << "Collapse pass " << i << " finished" << std::endl;
-            i++;
-            //std::cout << "Collapses\n";
+                m_mesheventcallback->log() << "Queued collapse pass finished" << std::endl;
+        }
+        else
+        {
+            while ( m_collapser.collapse_pass() ) {
+                if (m_mesheventcallback)
+                    m_mesheventcallback->log() << "Collapse pass " << i << " finished" << std::endl;
+                i++;
+                //std::cout << "Collapses\n";
+            }
         }
         
         // process t1 transitions (vertex separation)
@@ -1183,6 +1580,14 @@ void SurfTrack::improve_mesh( )
 //                m_mesheventcallback->log() << "Smoothing pass finished" << std::endl;
 //        }
         
+        // parallel smoothing never introduces collisions, so unlike the pass above it is safe to run here
+        if ( m_perform_smoothing && m_parallel_smoothing )
+        {
+            m_smoother.parallel_smoothing_pass( 1.0 );
+            if (m_mesheventcallback)
+                m_mesheventcallback->log() << "Parallel smoothing pass finished" << std::endl;
+        }
+        
 //        
 //        ////////////////////////////////////////////////////////////
 //        //enter aggressive improvement mode to improve remaining bad triangles up to minimum bounds,
@@ -1278,7 +1683,7 @@ void SurfTrack::topology_changes( )
     }
     
     //bool merge_occurred = merge_occurred = m_merger.merge_pass(); //OLD MERGING CODE
-    bool merge_occurred = m_snapper.snap_pass();   //NEW MERGING CODE
+    bool merge_occurred = m_queued_snapping ? m_snapper.snap_pass_queued() : m_snapper.snap_pass();   //NEW MERGING CODE
     
     if (m_mesheventcallback)
         m_mesheventcallback->log() << "Snap pass finished" << std::endl;
@@ -1292,6 +1697,150 @@ void SurfTrack::topology_changes( )
         m_mesheventcallback->log() << "Topology changes finished" << std::endl;
 }
 
+// ---------------------------------------------------------
+///
+/// Compute cheap indicators of whether remeshing is needed
+///
+// ---------------------------------------------------------
+
+void SurfTrack::compute_remeshing_indicators( RemeshingIndicators& indicators )
+{
+    indicators = RemeshingIndicators();
+    
+    // edge length histogram bounds
+    for ( size_t i = 0; i < m_mesh.m_edges.size(); ++i )
+    {
+        if ( m_mesh.edge_is_deleted(i) ) { continue; }
+        
+        double length = get_edge_length(i);
+        double scale = get_edge_length_scale(i);
+        indicators.m_min_edge_length_ratio = min( indicators.m_min_edge_length_ratio, length / ( m_min_edge_length * scale ) );
+        indicators.m_max_edge_length_ratio = max( indicators.m_max_edge_length_ratio, length / ( m_max_edge_length * scale ) );
+    }
+    
+    // triangle angles
+    for ( size_t i = 0; i < m_mesh.num_triangles(); ++i )
+    {
+        if ( m_mesh.triangle_is_deleted(i) ) { continue; }
+        
+        const Vec3st& tri = m_mesh.get_triangle(i);
+        if ( triangle_with_bad_angle(i) ||
+             rad2deg( max_triangle_angle( get_position(tri[0]), get_position(tri[1]), get_position(tri[2]) ) ) > m_large_triangle_angle_to_split )
+        {
+            ++indicators.m_num_bad_angle_triangles;
+        }
+    }
+    
+    // T1 candidates: junction vertices whose region graph is incomplete (see T1Transition::t1_pass())
+    const std::vector<size_t>& junction_vertices = get_junction_vertices();
+    std::vector<int> regions;
+    std::vector< std::pair<int,int> > region_pairs;
+    for ( size_t i = 0; i < junction_vertices.size(); ++i )
+    {
+        const std::vector<size_t>& incident_triangles = m_mesh.m_vertex_to_triangle_map[junction_vertices[i]];
+        
+        regions.clear();
+        region_pairs.clear();
+        for ( size_t j = 0; j < incident_triangles.size(); ++j )
+        {
+            const Vec2i& label = m_mesh.get_triangle_label( incident_triangles[j] );
+            regions.push_back( label[0] );
+            regions.push_back( label[1] );
+            region_pairs.push_back( std::make_pair( min( label[0], label[1] ), max( label[0], label[1] ) ) );
+        }
+        
+        std::sort( regions.begin(), regions.end() );
+        regions.erase( std::unique( regions.begin(), regions.end() ), regions.end() );
+        std::sort( region_pairs.begin(), region_pairs.end() );
+        region_pairs.erase( std::unique( region_pairs.begin(), region_pairs.end() ), region_pairs.end() );
+        
+        if ( region_pairs.size() < regions.size() * ( regions.size() - 1 ) / 2 )
+        {
+            ++indicators.m_num_t1_candidates;
+        }
+    }
+    
+    // separation between non-adjacent elements, only looking as far as the merge distance
+    if ( !m_allow_topology_changes || !m_collision_safety ) { return; }
+    
+    const double epsilon = m_merge_proximity_epsilon;
+    std::vector<size_t> candidates;
+    
+    for ( size_t v = 0; v < get_num_vertices() && !( indicators.m_min_separation < epsilon ); ++v )
+    {
+        if ( m_mesh.vertex_is_deleted(v) || m_mesh.m_vertex_to_triangle_map[v].empty() ) { continue; }
+        
+        const Vec3d& x = get_position(v);
+        candidates.clear();
+        m_broad_phase->get_potential_triangle_collisions( x - Vec3d(epsilon), x + Vec3d(epsilon), true, true, candidates );
+        
+        for ( size_t i = 0; i < candidates.size(); ++i )
+        {
+            const Vec3st& tri = m_mesh.get_triangle( candidates[i] );
+            if ( tri[0] == v || tri[1] == v || tri[2] == v ) { continue; }
+            
+            double distance;
+            check_point_triangle_proximity( x, get_position(tri[0]), get_position(tri[1]), get_position(tri[2]), distance );
+            indicators.m_min_separation = min( indicators.m_min_separation, distance );
+        }
+    }
+    
+    for ( size_t e = 0; e < m_mesh.m_edges.size() && !( indicators.m_min_separation < epsilon ); ++e )
+    {
+        if ( m_mesh.edge_is_deleted(e) ) { continue; }
+        
+        const Vec2st& edge = m_mesh.m_edges[e];
+        Vec3d low, high;
+        minmax( get_position(edge[0]), get_position(edge[1]), low, high );
+        candidates.clear();
+        m_broad_phase->get_potential_edge_collisions( low - Vec3d(epsilon), high + Vec3d(epsilon), true, true, candidates );
+        
+        for ( size_t i = 0; i < candidates.size(); ++i )
+        {
+            if ( candidates[i] <= e ) { continue; }
+            if ( m_mesh.get_common_vertex( e, candidates[i] ) < m_mesh.nv() ) { continue; }
+            
+            const Vec2st& other = m_mesh.m_edges[candidates[i]];
+            if ( other[0] == other[1] ) { continue; }
+            
+            double distance;
+            check_edge_edge_proximity( get_position(edge[0]), get_position(edge[1]), get_position(other[0]), get_position(other[1]), distance );
+            indicators.m_min_separation = min( indicators.m_min_separation, distance );
+        }
+    }
+}
+
+// ---------------------------------------------------------
+///
+/// Whether improve_mesh() may have work to do
+///
+// ---------------------------------------------------------
+
+bool SurfTrack::improvement_needed( const RemeshingIndicators& indicators ) const
+{
+    if ( !m_perform_improvement ) { return false; }
+    if ( m_splitter.m_use_curvature || m_collapser.m_use_curvature ) { return true; }
+    
+    return indicators.m_min_edge_length_ratio < 1.0 ||
+           indicators.m_max_edge_length_ratio > 1.0 ||
+           indicators.m_num_bad_angle_triangles > 0 ||
+           ( m_t1_transition_enabled && indicators.m_num_t1_candidates > 0 );
+}
+
+// ---------------------------------------------------------
+///
+/// Whether topology_changes() may have work to do
+///
+// ---------------------------------------------------------
+
+bool SurfTrack::topology_changes_needed( const RemeshingIndicators& indicators ) const
+{
+    if ( !m_allow_topology_changes ) { return false; }
+    if ( !m_collision_safety ) { return true; }
+    
+    return indicators.m_min_separation < m_merge_proximity_epsilon;
+}
+
 void SurfTrack::assert_no_bad_labels()
 {
     for(size_t i = 0; i < m_mesh.m_triangle_labels.size(); ++i) {
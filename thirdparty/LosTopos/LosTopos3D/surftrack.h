@@ -141,6 +141,14 @@ struct SurfTrackInitializationParameters
     /// Whether to enforce collision-free surfaces (including during mesh maintenance operations)
     ///
     bool m_collision_safety;
+
+    /// Whether to use the sparse hashed broad phase instead of dense regular grids
+    ///
+    bool m_use_hashed_broad_phase;
+
+    /// Whether to scale back motion only around failed collision handling, rather than halving the whole time step
+    ///
+    bool m_localized_rollback;
     
     /// Whether to allow changes in topology
     ///
@@ -160,6 +168,25 @@ struct SurfTrackInitializationParameters
   
     /// Pull apart distance, in terms of absolute length
     double m_pull_apart_distance;
+    
+    /// Fraction of deleted mesh slots above which defrag_mesh_incremental() defragments from scratch instead of 
+    /// recycling the slots
+    ///
+    double m_defrag_threshold;
+    
+    /// Whether improve_mesh() drives splits and collapses from locally updated priority queues instead of repeated
+    /// full passes
+    ///
+    bool m_queued_remeshing;
+    
+    /// Whether topology_changes() snaps from a locally updated proximity queue, so that proximities formed by a snap
+    /// are handled in the same call
+    ///
+    bool m_queued_snapping;
+    
+    /// Whether improve_mesh() smooths with the parallel, collision-safe smoothing pass (requires m_perform_smoothing)
+    ///
+    bool m_parallel_smoothing;
 
     /// Whether to be verbose in outputting data
     ///
@@ -430,6 +457,43 @@ struct MeshUpdateEvent
 
 };
 
+// ---------------------------------------------------------
+///
+/// Cheap summary of the mesh state, used to decide whether a round of topology changes and mesh improvement has 
+/// anything to do.  See SurfTrack::compute_remeshing_indicators().
+///
+// ---------------------------------------------------------
+
+struct RemeshingIndicators
+{
+    RemeshingIndicators() :
+    m_min_edge_length_ratio( BIG_DOUBLE ),
+    m_max_edge_length_ratio( 0.0 ),
+    m_num_bad_angle_triangles( 0 ),
+    m_num_t1_candidates( 0 ),
+    m_min_separation( BIG_DOUBLE )
+    {}
+    
+    /// Edge length histogram bounds: the smallest ratio of an edge's length to its lower bound, and the largest ratio of 
+    /// an edge's length to its upper bound (both bounds scaled by the sizing field, if any)
+    ///
+    double m_min_edge_length_ratio;
+    double m_max_edge_length_ratio;
+    
+    /// Number of triangles with an angle outside the allowed range, or above the large angle split threshold
+    ///
+    size_t m_num_bad_angle_triangles;
+    
+    /// Number of junction vertices with a pair of incident regions which do not share a triangle
+    ///
+    size_t m_num_t1_candidates;
+    
+    /// Smallest distance between non-adjacent mesh elements closer than the merge proximity epsilon, or BIG_DOUBLE if 
+    /// there are none.  The search stops at the first such pair, so this is only an upper bound on the true minimum.
+    ///
+    double m_min_separation;
+};
+
 // ---------------------------------------------------------
 ///
 /// A DynamicSurface with topological and mesh maintenance operations.
@@ -496,6 +560,11 @@ public:
     void defrag_mesh_from_scratch(std::vector<size_t> & vertices_to_be_mapped);
     void defrag_mesh_from_scratch_manual(std::vector<size_t> & vertices_to_be_mapped);
     void defrag_mesh_from_scratch_copy(std::vector<size_t> & vertices_to_be_mapped);
+    
+    /// Recycle the slots of deleted elements, defragmenting from scratch only if too many of them have accumulated.
+    /// Returns true if the mesh was defragmented.
+    ///
+    bool defrag_mesh_incremental(std::vector<size_t> & vertices_to_be_mapped);
 
     /// Check for labels with -1 as their value, or the same label on both sides.
     /// 
@@ -514,6 +583,20 @@ public:
     ///
     void topology_changes( );
     
+    /// Compute the remeshing indicators of the current mesh: a linear sweep over edges and triangles, plus broad phase 
+    /// proximity queries which stop at the first pair within merge distance
+    ///
+    void compute_remeshing_indicators( RemeshingIndicators& indicators );
+    
+    /// Whether improve_mesh() may have work to do, going by the given indicators.  Always true when curvature-driven 
+    /// splitting or collapsing is on, since the indicators don't track curvature.
+    ///
+    bool improvement_needed( const RemeshingIndicators& indicators ) const;
+    
+    /// Whether topology_changes() may have work to do, going by the given indicators
+    ///
+    bool topology_changes_needed( const RemeshingIndicators& indicators ) const;
+    
     /// Run mesh cutting operations on a given set of edges
     ///
     void cut_mesh( const std::vector< std::pair<size_t, size_t> >& edges);
@@ -663,6 +746,22 @@ public:
     /// boolean, whether to do null space smoothing on vertex positions
     int m_perform_smoothing;
     
+    /// Fraction of deleted mesh slots above which defrag_mesh_incremental() defragments from scratch
+    ///
+    double m_defrag_threshold;
+    
+    /// Whether improve_mesh() uses the priority-queue driven split and collapse passes
+    ///
+    bool m_queued_remeshing;
+    
+    /// Whether topology_changes() uses the priority-queue driven snap pass
+    ///
+    bool m_queued_snapping;
+    
+    /// Whether improve_mesh() runs MeshSmoother::parallel_smoothing_pass()
+    ///
+    bool m_parallel_smoothing;
+    
     
     //Return whether the given edge is a feature as determined by dihedral angles.
     bool edge_is_feature(size_t edge) const;
@@ -727,6 +826,23 @@ public:
     };
     
     SolidVerticesCallback * m_solid_vertices_callback;
+    
+    /// Sizing field callback, for adaptive remeshing
+    ///
+    class SizingFieldCallback
+    {
+    public:
+        /// Factor by which the edge length bounds (m_min_edge_length, m_max_edge_length) are scaled at vertex v.
+        /// Non-positive values are ignored.
+        virtual double edge_length_scale(const SurfTrack & st, size_t v) = 0;
+    };
+    
+    SizingFieldCallback * m_sizing_field_callback;
+    
+    /// Scale factor for the edge length bounds at an edge: the smaller of the sizing field values at its two vertices,
+    /// or 1 if there is no sizing field.
+    ///
+    double get_edge_length_scale( size_t edge_index ) const;
         
     /// History of vertex removal or addition events
     ///
@@ -747,7 +863,51 @@ public:
     /// History of higher level mesh update events (split, flip, collapse, smooth)
     ///    
     std::vector<MeshUpdateEvent> m_mesh_change_history;
-
+    
+    /// Determine if moving one vertex, with everything else held still, introduces a collision
+    ///
+    bool vertex_pseudo_motion_introduces_collision( size_t v, const Vec3d& oldpos, const Vec3d& newpos ) const;
+    
+    //
+    // Junction vertex index
+    //
+    
+    /// Bring the junction index up to date and return the vertices incident to three or more regions, in no particular
+    /// order.  The first call (and the first call after a defrag) scans every vertex; later calls only re-examine the 
+    /// vertices whose incident triangles have been added, removed or relabelled since.
+    ///
+    const std::vector<size_t>& get_junction_vertices();
+    
+    /// Flag the vertices of a triangle for re-examination by the junction index.  Called by add_triangle() and 
+    /// remove_triangle(); code which changes triangle labels directly on m_mesh must call it too.
+    ///
+    void mark_junction_vertices_dirty( size_t triangle_index );
+    
+    /// Number of distinct regions on the triangles incident to a vertex
+    ///
+    size_t get_num_incident_regions( size_t vertex_index ) const;
+    
+private:
+    
+    /// Add or remove a vertex from m_junction_vertices
+    ///
+    void set_vertex_is_junction( size_t vertex_index, bool is_junction );
+    
+    /// Whether m_junction_vertices is valid; dirty vertices are only recorded while it is
+    ///
+    bool m_junction_index_valid;
+    
+    /// Vertices incident to three or more regions
+    ///
+    std::vector<size_t> m_junction_vertices;
+    
+    /// For each vertex, its position in m_junction_vertices, or ~0 if it is not a junction
+    ///
+    std::vector<size_t> m_junction_slots;
+    
+    /// Vertices whose incident triangles changed since the junction index was last updated
+    ///
+    std::vector<size_t> m_junction_dirty_vertices;
     
 };
 
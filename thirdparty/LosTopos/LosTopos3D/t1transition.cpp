@@ -7,6 +7,7 @@
 //
 // ---------------------------------------------------------
 
+#include <algorithm>
 #include <queue>
 #include <set>
 
@@ -92,17 +93,23 @@ bool T1Transition::t1_pass()
     NonDestructiveTriMesh & mesh = m_surf.m_mesh;
     bool pop_occurred = false;
     
+    // only vertices incident to three or more regions can need pulling apart; visit them in index order so that the
+    //  result does not depend on the order the junction index happens to store them in
+    std::vector<size_t> junction_vertices = m_surf.get_junction_vertices();
+    std::sort(junction_vertices.begin(), junction_vertices.end());
+    
     // find the region count
     int max_region = -1;
-    for (size_t i = 0; i < mesh.nt(); i++)
+    for (size_t i = 0; i < junction_vertices.size(); i++)
     {
-        if (mesh.get_triangle(i)[0] == mesh.get_triangle(i)[1] && mesh.get_triangle(i)[0] == mesh.get_triangle(i)[2])
-            continue;
-        Vec2i label = mesh.get_triangle_label(i);
-        assert(label[0] >= 0);
-        assert(label[1] >= 0);
-        if (label[0] > max_region) max_region = label[0];
-        if (label[1] > max_region) max_region = label[1];
+        for (size_t j = 0; j < mesh.m_vertex_to_triangle_map[junction_vertices[i]].size(); j++)
+        {
+            Vec2i label = mesh.get_triangle_label(mesh.m_vertex_to_triangle_map[junction_vertices[i]][j]);
+            assert(label[0] >= 0);
+            assert(label[1] >= 0);
+            if (label[0] > max_region) max_region = label[0];
+            if (label[1] > max_region) max_region = label[1];
+        }
     }
     int nregion = max_region + 1;
     
@@ -111,11 +118,12 @@ bool T1Transition::t1_pass()
     
     // a list of candidate directions
     std::vector<SortableDirectionCandidate> candidates;
+    std::vector<SortableDirectionCandidate> velocity_field_candidates;     // candidates whose tendency is yet to be sampled from the velocity field
     
-    // loop through all the vertices
-    for (size_t i = 0; i < mesh.nv(); i++)
+    // loop through the junction vertices
+    for (size_t i = 0; i < junction_vertices.size(); i++)
     {
-        size_t xj = i;
+        size_t xj = junction_vertices[i];
         
         std::set<int> vertex_regions_set;
         for (size_t i = 0; i < mesh.m_vertex_to_triangle_map[xj].size(); i++)
@@ -217,10 +225,18 @@ bool T1Transition::t1_pass()
                     Vec3d pull_apart_direction;
                     double pull_apart_tendency = 0;
                     if (m_velocity_field_callback)
-                        pull_apart_tendency = try_pull_vertex_apart_using_velocity_field(xj, A, B, pull_apart_direction);
-                    else
-                        pull_apart_tendency = try_pull_vertex_apart_using_surface_tension(xj, A, B, pull_apart_direction);
+                    {
+                        // the divergences of all candidates are sampled together below
+                        SortableDirectionCandidate candidate;
+                        candidate.vertex = xj;
+                        candidate.regions = Vec2i(A, B);
+                        candidate.direction = velocity_field_pull_apart_direction(xj, A, B);
+                        candidate.tendency = 0;
+                        velocity_field_candidates.push_back(candidate);
+                        continue;
+                    }
                     
+                    pull_apart_tendency = try_pull_vertex_apart_using_surface_tension(xj, A, B, pull_apart_direction);
                     if (pull_apart_tendency > 0)
                     {
                         SortableDirectionCandidate candidate;
@@ -235,6 +251,30 @@ bool T1Transition::t1_pass()
         }
     }
     
+    // sample the velocity divergences of all velocity field candidates in one evaluation
+    if (velocity_field_candidates.size() > 0)
+    {
+        std::vector<Vec3d> positions(velocity_field_candidates.size());
+        std::vector<Vec3d> directions(velocity_field_candidates.size());
+        for (size_t i = 0; i < velocity_field_candidates.size(); i++)
+        {
+            positions[i] = m_surf.get_position(velocity_field_candidates[i].vertex);
+            directions[i] = velocity_field_candidates[i].direction;
+        }
+        
+        std::vector<double> divergences;
+        sample_directional_divergences(positions, directions, divergences);
+        
+        for (size_t i = 0; i < velocity_field_candidates.size(); i++)
+        {
+            if (divergences[i] > 0)
+            {
+                velocity_field_candidates[i].tendency = divergences[i];
+                candidates.push_back(velocity_field_candidates[i]);
+            }
+        }
+    }
+    
     // sort the candidate pairs according to the strength of the tensile force
     std::sort(candidates.begin(), candidates.end());
     
@@ -266,9 +306,10 @@ bool T1Transition::t1_pass()
         if (contact)
             continue;
         
-        if (m_velocity_field_callback)
-            pull_apart_tendency = try_pull_vertex_apart_using_velocity_field(xj, A, B, pull_apart_direction);
-        else
+        // the velocity field candidates keep the divergence sampled for all of them above, as resampling it after each
+        //  pop would cost a full velocity field evaluation per candidate; the checks above cover their validity.
+        //  surface tension trial pulls are redone since earlier pops may have changed the geometry around xj.
+        if (!m_velocity_field_callback)
             pull_apart_tendency = try_pull_vertex_apart_using_surface_tension(xj, A, B, pull_apart_direction);
         if (pull_apart_tendency < 0)
             continue;
@@ -338,7 +379,7 @@ bool T1Transition::t1_pass()
                 A_edges.push_back(edge);
         }
         
-        if (vertex_pseudo_motion_introduces_collision(xj, original_position, b_desired_position))
+        if (m_surf.vertex_pseudo_motion_introduces_collision(xj, original_position, b_desired_position))
         {
             if (m_surf.m_verbose)
                 std::cout << "Vertex popping: pulling vertex " << xj << " apart introduces collision." << std::endl;
@@ -660,11 +701,11 @@ double T1Transition::try_pull_vertex_apart_using_surface_tension(size_t xj, int
 
 // --------------------------------------------------------
 ///
-/// Decide whether to cut an X-junction vertex between two given regions
+/// Direction to pull an X-junction vertex apart in between two given regions: from the centroid of the region B cone to that of the region A cone
 ///
 // --------------------------------------------------------
 
-double T1Transition::try_pull_vertex_apart_using_velocity_field(size_t xj, int A, int B, Vec3d & pull_apart_direction)
+Vec3d T1Transition::velocity_field_pull_apart_direction(size_t xj, int A, int B)
 {
     NonDestructiveTriMesh & mesh = m_surf.m_mesh;
     
@@ -717,39 +758,56 @@ double T1Transition::try_pull_vertex_apart_using_velocity_field(size_t xj, int A
     centroidB /= vertsB.size();
     
     // the pull apart direction is along the line between the two centroids
-    pull_apart_direction = (centroidA - centroidB);
+    Vec3d pull_apart_direction = (centroidA - centroidB);
     pull_apart_direction /= mag(pull_apart_direction);
     
-    // compute the mean edge length around vertex xj
-    double mean_edge_length = 0;
-    int edge_count = 0;
-    for (size_t i = 0; i < mesh.m_vertex_to_edge_map[xj].size(); i++)
-    {
-        size_t v0 = mesh.m_edges[mesh.m_vertex_to_edge_map[xj][i]][0];
-        size_t v1 = mesh.m_edges[mesh.m_vertex_to_edge_map[xj][i]][1];
-        mean_edge_length += mag(m_surf.get_position(v1) - m_surf.get_position(v0));
-        edge_count++;
-    }
-    assert(edge_count > 0);
-    mean_edge_length /= edge_count;
-    
+    return pull_apart_direction;
+}
+
+// --------------------------------------------------------
+///
+/// Sample the velocity divergences along the given directions, asking the velocity field callback for all of them at
+/// once, or else finite differencing its velocities over the pull apart distance
+///
+// --------------------------------------------------------
+
+void T1Transition::sample_directional_divergences(const std::vector<Vec3d> & positions, const std::vector<Vec3d> & directions, std::vector<double> & divergences)
+{
     assert(m_velocity_field_callback);
     
-    // decide the final positions
-    Vec3d xxj = m_surf.get_position(xj);
-    //    Vec3d x_a = xxj + pull_apart_direction * mean_edge_length * m_pull_apart_distance;
-    //    Vec3d x_b = xxj - pull_apart_direction * mean_edge_length * m_pull_apart_distance;
-    Vec3d x_a = xxj + pull_apart_direction * m_pull_apart_distance;
-    Vec3d x_b = xxj - pull_apart_direction * m_pull_apart_distance;
+    divergences.resize(positions.size());
+    if (m_velocity_field_callback->sampleDirectionalDivergences(positions, directions, divergences))
+        return;
     
-    //    Vec3d vxj = m_velocity_field_callback->sampleVelocity(xxj);
-    Vec3d v_a = m_velocity_field_callback->sampleVelocity(x_a);
-    Vec3d v_b = m_velocity_field_callback->sampleVelocity(x_b);
+    for (size_t i = 0; i < positions.size(); i++)
+    {
+        // decide the final positions
+        Vec3d x_a = positions[i] + directions[i] * m_pull_apart_distance;
+        Vec3d x_b = positions[i] - directions[i] * m_pull_apart_distance;
+        
+        Vec3d v_a = m_velocity_field_callback->sampleVelocity(x_a);
+        Vec3d v_b = m_velocity_field_callback->sampleVelocity(x_b);
+        
+        divergences[i] = dot(v_a - v_b, directions[i]) / (m_pull_apart_distance * 2);
+    }
+}
+
+// --------------------------------------------------------
+///
+/// Decide whether to cut an X-junction vertex between two given regions
+///
+// --------------------------------------------------------
+
+double T1Transition::try_pull_vertex_apart_using_velocity_field(size_t xj, int A, int B, Vec3d & pull_apart_direction)
+{
+    pull_apart_direction = velocity_field_pull_apart_direction(xj, A, B);
     
-    //    double divergence = dot(v_a - v_b, pull_apart_direction) / (mean_edge_length * m_pull_apart_distance * 2);
-    double divergence = dot(v_a - v_b, pull_apart_direction) / (m_pull_apart_distance * 2);
+    std::vector<Vec3d> positions(1, m_surf.get_position(xj));
+    std::vector<Vec3d> directions(1, pull_apart_direction);
+    std::vector<double> divergences;
+    sample_directional_divergences(positions, directions, divergences);
     
-    return divergence;
+    return divergences[0];
 }
 
 void T1Transition::triangulate_popped_vertex(size_t xj, int A, int B, size_t a, size_t b, std::vector<size_t> & faces_to_delete, std::vector<Vec3st> & faces_to_create, std::vector<Vec2i> & face_labels_to_create)
@@ -850,181 +908,12 @@ void T1Transition::triangulate_popped_vertex(size_t xj, int A, int B, size_t a,
 
 bool T1Transition::pulling_vertex_apart_introduces_collision(size_t v, const Vec3d & oldpos, const Vec3d & newpos0, const Vec3d & newpos1)
 {
-    bool collision0 = vertex_pseudo_motion_introduces_collision(v, oldpos, newpos0);
-    bool collision1 = vertex_pseudo_motion_introduces_collision(v, oldpos, newpos1);
+    bool collision0 = m_surf.vertex_pseudo_motion_introduces_collision(v, oldpos, newpos0);
+    bool collision1 = m_surf.vertex_pseudo_motion_introduces_collision(v, oldpos, newpos1);
     
     return collision0 || collision1;
 }
 
-bool T1Transition::vertex_pseudo_motion_introduces_collision(size_t v, const Vec3d & oldpos, const Vec3d & newpos)
-{
-    // code adapted from EdgeSplitter::split_edge_pseudo_motion_introduces_intersection()
-    
-    if (!m_surf.m_collision_safety)
-        return false;
-    
-    NonDestructiveTriMesh & m_mesh = m_surf.m_mesh;
-    
-    const std::vector<Vec3d> & x = m_surf.get_positions();
-    
-    std::vector<size_t> & tris = m_surf.m_mesh.m_vertex_to_triangle_map[v];
-    std::vector<size_t> & edges = m_surf.m_mesh.m_vertex_to_edge_map[v];
-    std::vector<size_t> edge_other_endpoints(edges.size());
-    
-    for (size_t i = 0; i < edges.size(); i++)
-        edge_other_endpoints[i] = (m_mesh.m_edges[edges[i]][0] == v ? m_mesh.m_edges[edges[i]][1] : m_mesh.m_edges[edges[i]][0]);
-    
-    // new point vs all triangles
-    {
-        
-        Vec3d aabb_low, aabb_high;
-        minmax(oldpos, newpos, aabb_low, aabb_high);
-        
-        aabb_low  -= m_surf.m_aabb_padding * Vec3d(1,1,1);
-        aabb_high += m_surf.m_aabb_padding * Vec3d(1,1,1);
-        
-        std::vector<size_t> overlapping_triangles;
-        m_surf.m_broad_phase->get_potential_triangle_collisions(aabb_low, aabb_high, true, true, overlapping_triangles);
-        
-        for (size_t i = 0; i < overlapping_triangles.size(); i++)
-        {
-            // exclude incident triangles
-            if (m_mesh.get_triangle(overlapping_triangles[i])[0] == v ||
-                m_mesh.get_triangle(overlapping_triangles[i])[1] == v ||
-                m_mesh.get_triangle(overlapping_triangles[i])[2] == v)
-                continue;
-            
-            Vec3st sorted_triangle = sort_triangle(m_mesh.get_triangle(overlapping_triangles[i]));
-            size_t a = sorted_triangle[0];
-            size_t b = sorted_triangle[1];
-            size_t c = sorted_triangle[2];
-            
-            double t_zero_distance;
-            check_point_triangle_proximity(oldpos, x[a], x[b], x[c], t_zero_distance);
-            if (t_zero_distance < m_surf.m_improve_collision_epsilon)
-                return true;
-            
-            if (point_triangle_collision(oldpos, newpos, v, x[a], x[a], a, x[b], x[b], b, x[c], x[c], c))
-            {
-                if (m_surf.m_verbose)
-                    std::cout << "Popping collision: point triangle: with triangle " << overlapping_triangles[i] << std::endl;
-                return true;
-            }
-        }
-        
-    }
-    
-    // new edges vs all edges
-    {
-        Vec3d edge_aabb_low, edge_aabb_high;
-        
-        // do one big query into the broad phase for all new edges
-        minmax(oldpos, newpos, edge_aabb_low, edge_aabb_high);
-        for (size_t i = 0; i < edge_other_endpoints.size(); ++i)
-            update_minmax(m_surf.get_position(edge_other_endpoints[i]), edge_aabb_low, edge_aabb_high);
-        
-        edge_aabb_low  -= m_surf.m_aabb_padding * Vec3d(1,1,1);
-        edge_aabb_high += m_surf.m_aabb_padding * Vec3d(1,1,1);
-        
-        std::vector<size_t> overlapping_edges;
-        m_surf.m_broad_phase->get_potential_edge_collisions(edge_aabb_low, edge_aabb_high, true, true, overlapping_edges);
-        
-        for (size_t i = 0; i < overlapping_edges.size(); i++)
-        {
-            if (m_mesh.m_edges[overlapping_edges[i]][0] == m_mesh.m_edges[overlapping_edges[i]][1])
-                continue;
-            
-            for (size_t j = 0; j < edges.size(); j++)
-            {
-                // exclude adjacent edges
-                if (m_mesh.get_common_vertex(edges[j], overlapping_edges[i]) < m_mesh.nv())
-                    continue;
-                
-                size_t n = edge_other_endpoints[j];
-                size_t e0 = m_mesh.m_edges[overlapping_edges[i]][0];
-                size_t e1 = m_mesh.m_edges[overlapping_edges[i]][1];
-                if (e0 > e1)
-                    std::swap(e0, e1);
-                
-                double t_zero_distance;
-                check_edge_edge_proximity(oldpos, x[n], x[e0], x[e1], t_zero_distance);
-                if (t_zero_distance < m_surf.m_improve_collision_epsilon)
-                    return true;
-                
-                bool collision = (n < v ?
-                                  segment_segment_collision(x[n], x[n], n, oldpos, newpos, v, x[e0], x[e0], e0, x[e1], x[e1], e1) :
-                                  segment_segment_collision(oldpos, newpos, v, x[n], x[n], n, x[e0], x[e0], e0, x[e1], x[e1], e1));
-                
-                if (collision)
-                {
-                    if (m_surf.m_verbose)
-                        std::cout << "Popping collision: edge edge: edge other vertex = " << edge_other_endpoints[j] << " edge = " << overlapping_edges[i] << std::endl;
-                    return true;
-                }
-            }
-        }
-    }
-    
-    // new triangles vs all points
-    {
-        Vec3d triangle_aabb_low, triangle_aabb_high;
-        
-        // do one big query into the broad phase for all new triangles
-        minmax(oldpos, newpos, triangle_aabb_low, triangle_aabb_high);
-        for (size_t i = 0; i < edge_other_endpoints.size(); ++i)
-            update_minmax(m_surf.get_position(edge_other_endpoints[i]), triangle_aabb_low, triangle_aabb_high);
-        
-        triangle_aabb_low  -= m_surf.m_aabb_padding * Vec3d(1,1,1);
-        triangle_aabb_high += m_surf.m_aabb_padding * Vec3d(1,1,1);
-        
-        std::vector<size_t> overlapping_vertices;
-        m_surf.m_broad_phase->get_potential_vertex_collisions(triangle_aabb_low, triangle_aabb_high, true, true, overlapping_vertices);
-        
-        for (size_t i = 0; i < overlapping_vertices.size(); i++)
-        {
-            if (m_mesh.m_vertex_to_triangle_map[overlapping_vertices[i]].empty())
-                continue;
-            
-            const Vec3d & vert = m_surf.get_position(overlapping_vertices[i]);
-            
-            for (size_t j = 0; j < tris.size(); j++)
-            {
-                // exclude incident triangles
-                if (m_mesh.get_triangle(tris[j])[0] == overlapping_vertices[i] ||
-                    m_mesh.get_triangle(tris[j])[1] == overlapping_vertices[i] ||
-                    m_mesh.get_triangle(tris[j])[2] == overlapping_vertices[i])
-                    continue;
-                
-                Vec3st sorted_triangle = sort_triangle(m_mesh.get_triangle(tris[j]));
-                size_t a = sorted_triangle[0];
-                size_t b = sorted_triangle[1];
-                size_t c = sorted_triangle[2];
-                
-                Vec3d oldxa = (a == v ? oldpos : x[a]);
-                Vec3d newxa = (a == v ? newpos : x[a]);
-                Vec3d oldxb = (b == v ? oldpos : x[b]);
-                Vec3d newxb = (b == v ? newpos : x[b]);
-                Vec3d oldxc = (c == v ? oldpos : x[c]);
-                Vec3d newxc = (c == v ? newpos : x[c]);
-                
-                double t_zero_distance;
-                check_point_triangle_proximity(vert, oldxa, oldxb, oldxc, t_zero_distance);
-                if (t_zero_distance < m_surf.m_improve_collision_epsilon)
-                    return true;
-                
-                if (point_triangle_collision(vert, vert, overlapping_vertices[i], oldxa, newxa, a, oldxb, newxb, b, oldxc, newxc, c))
-                {
-                    if (m_surf.m_verbose)
-                        std::cout << "Popping collision: triangle point: with triangle " << tris[j] << " with vertex " << overlapping_vertices[i] << std::endl;
-                    return true;
-                }
-            }
-        }
-    }
-    
-    return false;
-}
-
 bool T1Transition::vertex_pseudo_motion_introduces_collision(size_t v, const Vec3d & oldpos, const Vec3d & newpos, const std::vector<size_t> & tris, const std::vector<size_t> & edges)
 {
     NonDestructiveTriMesh & mesh = m_surf.m_mesh;
@@ -52,6 +52,10 @@ public:
     public:
         virtual Vec3d sampleVelocity(Vec3d & pos) = 0;
         
+        /// Velocity divergence along each direction, dot(dir, grad(u) * dir), at each position, evaluated together.
+        /// Returns false if not provided, in which case it is estimated by finite differences of sampleVelocity().
+        virtual bool sampleDirectionalDivergences(const std::vector<Vec3d> & positions, const std::vector<Vec3d> & directions, std::vector<double> & divergences) { return false; }
+        
     };
     
     
@@ -97,15 +101,17 @@ private:
     ///
     struct InteriorStencil;    
     
-    /// Collision safety helper functions
-    /// Move one vertex and test for collision
-    ///
-    bool vertex_pseudo_motion_introduces_collision(size_t v, const Vec3d & oldpos, const Vec3d & newpos);
-    
+    /// Collision safety helper functions (see also SurfTrack::vertex_pseudo_motion_introduces_collision())
     /// Move one vertex and test for collision, using only the specified subset of incident edges and triangles (ignoring the rest if any)
     ///
     bool vertex_pseudo_motion_introduces_collision(size_t v, const Vec3d & oldpos, const Vec3d & newpos, const std::vector<size_t> & tris, const std::vector<size_t> & edges);
     
+    /// Velocity field helper functions: the direction to pull a vertex apart in, and the velocity divergences along the
+    /// directions at the positions, all from one evaluation of the velocity field callback where it supports that
+    ///
+    Vec3d velocity_field_pull_apart_direction(size_t xj, int A, int B);
+    void sample_directional_divergences(const std::vector<Vec3d> & positions, const std::vector<Vec3d> & directions, std::vector<double> & divergences);
+    
     /// Vertex popping helper function: generate the new triangulation after pulling a vertex apart
     ///
     void triangulate_popped_vertex(size_t xj, int A, int B, size_t a, size_t b, std::vector<size_t> & faces_to_delete, std::vector<Vec3st> & faces_to_create, std::vector<Vec2i> & face_labels_to_create);
@@ -14,11 +14,38 @@
 #include <collisionqueries.h>
 #include <tunicate.h>
 #include <vec.h>
+#include <atomic>
 
 bool tunicate_verbose = false;
 
 namespace LosTopos {
 
+// --------------------------------------------------------------------------------------------------
+// Conservative filter counters (shared by all CCD implementations)
+// --------------------------------------------------------------------------------------------------
+
+namespace {
+    std::atomic<size_t> g_ccd_filter_counters[CCD_FILTER_NUM_COUNTERS];
+}
+
+void increment_ccd_filter_counter( CCDFilterCounter counter )
+{
+    g_ccd_filter_counters[counter].fetch_add( 1, std::memory_order_relaxed );
+}
+
+size_t get_ccd_filter_counter( CCDFilterCounter counter )
+{
+    return g_ccd_filter_counters[counter].load( std::memory_order_relaxed );
+}
+
+void reset_ccd_filter_counters()
+{
+    for ( int i = 0; i < CCD_FILTER_NUM_COUNTERS; ++i )
+    {
+        g_ccd_filter_counters[i].store( 0, std::memory_order_relaxed );
+    }
+}
+
 
 #ifdef USE_TUNICATE_CCD
 
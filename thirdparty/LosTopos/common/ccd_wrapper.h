@@ -15,6 +15,28 @@
 #include <vec.h>
 
 namespace LosTopos {
+
+// --------------------------------------------------------------------------------------------------
+// Conservative filter counters
+// --------------------------------------------------------------------------------------------------
+
+// Counters for the floating-point filter run ahead of the exact continuous collision tests: how many tests were
+// requested, and how many were rejected by the swept bounding box or by the sign of the coplanarity cubic.
+enum CCDFilterCounter
+{
+    CCD_POINT_TRIANGLE_TESTS,
+    CCD_POINT_TRIANGLE_BOUNDS_REJECTS,
+    CCD_POINT_TRIANGLE_COPLANARITY_REJECTS,
+    CCD_EDGE_EDGE_TESTS,
+    CCD_EDGE_EDGE_BOUNDS_REJECTS,
+    CCD_EDGE_EDGE_COPLANARITY_REJECTS,
+    CCD_FILTER_NUM_COUNTERS
+};
+
+void increment_ccd_filter_counter( CCDFilterCounter counter );
+size_t get_ccd_filter_counter( CCDFilterCounter counter );
+void reset_ccd_filter_counters();
+
 // --------------------------------------------------------------------------------------------------
 // 2D continuous collision detection
 // --------------------------------------------------------------------------------------------------
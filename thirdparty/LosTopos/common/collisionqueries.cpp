@@ -310,6 +310,169 @@ void check_point_triangle_proximity(const Vec3d &x0, const Vec3d &x1, const Vec3
     }
 }
 
+// Batched 3D ============================================================================================
+//
+// The batched routines compute every branch of the scalar routines above and select the result, so the loop over 
+// queries has no control flow and can be vectorized.  The arithmetic is the same as in the scalar versions.  Selects
+// are kept two-way and conditions are combined with non-short-circuit operators so the compiler can if-convert them.
+
+namespace {
+
+inline double select(bool c, double a, double b)
+{
+    return c ? a : b;
+}
+
+inline Vec3d select(bool c, const Vec3d &a, const Vec3d &b)
+{
+    return Vec3d(select(c, a[0], b[0]), select(c, a[1], b[1]), select(c, a[2], b[2]));
+}
+
+inline Vec3d batch_point(const ProximityBatch &batch, unsigned int p, size_t i)
+{
+    return Vec3d(batch.x[p][0][i], batch.x[p][1][i], batch.x[p][2][i]);
+}
+
+// check_point_edge_proximity(false, ...) with normal, without branches
+inline void point_edge_proximity(const Vec3d &x0, const Vec3d &x1, const Vec3d &x2, double normal_multiplier,
+                                 double &distance, double &s, Vec3d &normal)
+{
+    Vec3d dx(x2-x1);
+    double m2=mag2(dx);
+    double t=dot(x2-x0, dx)/m2;
+    s=select(t<0., 0., select(t>1., 1., t));
+    normal=x0-(s*x1+(1-s)*x2);
+    distance=mag(normal);
+    normal*=normal_multiplier/(distance+1e-30);
+}
+
+inline void store_result(ProximityBatch &batch, size_t i, double distance, double s0, double s1, double s2, const Vec3d &normal)
+{
+    batch.distance[i]=distance;
+    batch.s[0][i]=s0;
+    batch.s[1][i]=s1;
+    batch.s[2][i]=s2;
+    batch.normal[0][i]=normal[0];
+    batch.normal[1][i]=normal[1];
+    batch.normal[2][i]=normal[2];
+}
+
+}
+
+void check_edge_edge_proximity(ProximityBatch &batch)
+{
+    const size_t n=batch.size;
+    for(size_t i=0; i<n; ++i){
+        const Vec3d x0=batch_point(batch, 0, i), x1=batch_point(batch, 1, i), x2=batch_point(batch, 2, i), x3=batch_point(batch, 3, i);
+        
+        Vec3d x01=x0-x1;
+        double r00=mag(x01)+1e-30;
+        x01/=r00;
+        Vec3d x32=x3-x2;
+        double r01=dot(x32,x01);
+        x32-=r01*x01;
+        double r11=mag(x32)+1e-30;
+        x32/=r11;
+        Vec3d x31=x3-x1;
+        double s2=dot(x32,x31)/r11;
+        double s0=(dot(x01,x31)-r01*s2)/r00;
+        
+        // the four point-edge candidates of the scalar routine
+        double d1, t1, d0, t0, d3, t3, d2, t2;
+        Vec3d n1, n0, n3, n2;
+        point_edge_proximity(x1, x2, x3, 1., d1, t1, n1);
+        point_edge_proximity(x0, x2, x3, 1., d0, t0, n0);
+        point_edge_proximity(x3, x0, x1, -1., d3, t3, n3);
+        point_edge_proximity(x2, x0, x1, -1., d2, t2, n2);
+        
+        // closest points interior to both edges
+        Vec3d ni=(s0*x0+(1-s0)*x1)-(s2*x2+(1-s2)*x3);
+        double di=mag(ni);
+        Vec3d nc=cross(x1-x0, x3-x2);
+        nc/=mag(nc)+1e-300;
+        ni=select(di>0, ni/di, nc);
+        
+        bool s0_low=(s0<0), s0_high=(s0>1), s0_mid=!(s0_low | s0_high);
+        bool s2_low=(s2<0), s2_high=(s2>1), s2_mid=!(s2_low | s2_high);
+        
+        // second point-edge test candidate (x3 or x2 against edge 0-1)
+        double db=select(s2_low, d3, d2);
+        double tb=select(s2_low, t3, t2);
+        Vec3d nb=select(s2_low, n3, n2);
+        
+        // first point-edge test: x1 or x0 against edge 2-3 for an out-of-range s0, otherwise the second candidate
+        double da=select(s0_low, d1, select(s0_high, d0, db));
+        double ta=select(s0_low, t1, select(s0_high, t0, tb));
+        Vec3d na=select(s0_low, n1, select(s0_high, n0, nb));
+        
+        // the second test only runs when both parameters are out of range, and sets s0 if closer
+        bool take_b=!s0_mid & !s2_mid & (db<da);
+        bool interior=s0_mid & s2_mid;
+        
+        double d_out=select(take_b, db, da);
+        double s0_out=select(s0_mid, ta, select(take_b, tb, select(s2_mid, select(s0_low, 0., 1.), s0)));
+        double s2_out=select(s0_mid, select(s2_low, 0., 1.), ta);
+        Vec3d n_out=select(take_b, nb, na);
+        
+        store_result(batch, i, select(interior, di, d_out), select(interior, s0, s0_out), select(interior, s2, s2_out), 0., 
+                     select(interior, ni, n_out));
+    }
+}
+
+void check_point_triangle_proximity(ProximityBatch &batch)
+{
+    const size_t n=batch.size;
+    for(size_t i=0; i<n; ++i){
+        const Vec3d x0=batch_point(batch, 0, i), x1=batch_point(batch, 1, i), x2=batch_point(batch, 2, i), x3=batch_point(batch, 3, i);
+        
+        Vec3d x13=x1-x3;
+        double r00=mag(x13)+1e-30;
+        x13/=r00;
+        Vec3d x23=x2-x3;
+        double r01=dot(x23,x13);
+        x23-=r01*x13;
+        double r11=mag(x23)+1e-30;
+        x23/=r11;
+        Vec3d x03=x0-x3;
+        double s2=dot(x23,x03)/r11;
+        double s1=(dot(x13,x03)-r01*s2)/r00;
+        double s3=1-s1-s2;
+        
+        // closest point interior to the triangle
+        Vec3d ni=x0-(s1*x1+s2*x2+s3*x3);
+        double di=mag(ni);
+        Vec3d nc=cross(x2-x1, x3-x1);
+        nc/=mag(nc)+1e-300;
+        ni=select(di>0, ni/di, nc);
+        
+        // the three point-edge candidates
+        double d12, t12, d13, t13, d23, t23;
+        Vec3d n12, n13, n23;
+        point_edge_proximity(x0, x1, x2, 1., d12, t12, n12);
+        point_edge_proximity(x0, x1, x3, 1., d13, t13, n13);
+        point_edge_proximity(x0, x2, x3, 1., d23, t23, n23);
+        
+        bool inside=(s1>=0) & (s2>=0) & (s3>=0);
+        bool pos1=(s1>0), pos2=!pos1 & (s2>0), pos12=pos1 | pos2;
+        
+        // s1>0 rules out edge 2-3, s2>0 rules out edge 1-3, otherwise edge 1-2 is ruled out
+        double da=select(pos12, d12, d23);
+        double db=select(pos2, d23, d13);
+        bool take_b=(db<da);
+        
+        double a1=select(pos12, t12, 0.), a2=select(pos12, 1-t12, t23), a3=select(pos12, 0., 1-t23);
+        double b1=select(pos2, 0., t13), b2=select(pos2, t23, 0.), b3=select(pos2, 1-t23, 1-t13);
+        Vec3d na=select(pos12, n12, n23);
+        Vec3d nb=select(pos2, n23, n13);
+        
+        double o1=select(take_b, b1, a1), o2=select(take_b, b2, a2), o3=select(take_b, b3, a3);
+        Vec3d n_out=select(take_b, nb, na);
+        
+        store_result(batch, i, select(inside, di, select(take_b, db, da)), select(inside, s1, o1), select(inside, s2, o2), 
+                     select(inside, s3, o3), select(inside, ni, n_out));
+    }
+}
+
 double signed_volume(const Vec3d &x0, const Vec3d &x1, const Vec3d &x2, const Vec3d &x3)
 {
     // Equivalent to triple(x1-x0, x2-x0, x3-x0), six times the signed volume of the tetrahedron.
@@ -1,6 +1,7 @@
 #ifndef COLLISIONQUERIES_H
 #define COLLISIONQUERIES_H
 
+#include <cassert>
 #include <vec.h>
 
 namespace LosTopos {
@@ -30,6 +31,51 @@ void check_point_triangle_proximity(const Vec3d &x0, const Vec3d &x1, const Vec3
 void check_point_triangle_proximity(const Vec3d &x0, const Vec3d &x1, const Vec3d &x2, const Vec3d &x3,
                                     double &distance, double &s1, double &s2, double &s3, Vec3d &normal);
 
+// Batched 3D ============================================================================================
+
+// Number of queries evaluated per call of the batched routines below.
+const size_t PROXIMITY_BATCH_SIZE = 64;
+
+// A block of proximity queries in structure-of-arrays form, so the batched routines can evaluate many candidates
+// with vector instructions.  For point-triangle queries the four points are the point then the triangle corners; for
+// edge-edge queries they are edge 0-1 then edge 2-3.  Outputs match the scalar routines of the same name.
+struct ProximityBatch
+{
+    ProximityBatch() : size(0) {}
+    
+    bool empty() const { return size == 0; }
+    bool full() const { return size == PROXIMITY_BATCH_SIZE; }
+    void clear() { size = 0; }
+    
+    // Append one query, returning its slot in the batch
+    size_t push_back(const Vec3d &x0, const Vec3d &x1, const Vec3d &x2, const Vec3d &x3)
+    {
+        assert(size < PROXIMITY_BATCH_SIZE);
+        const Vec3d* points[4] = { &x0, &x1, &x2, &x3 };
+        for(unsigned int p=0; p<4; ++p)
+            for(unsigned int a=0; a<3; ++a)
+                x[p][a][size]=(*points[p])[a];
+        return size++;
+    }
+    
+    Vec3d get_normal(size_t i) const { return Vec3d(normal[0][i], normal[1][i], normal[2][i]); }
+    
+    size_t size;
+    
+    // inputs: x[point][axis][query]
+    double x[4][3][PROXIMITY_BATCH_SIZE];
+    
+    // outputs: distance, barycentric coordinates (s1,s2,s3 for point-triangle; s0,s2 for edge-edge) and normal
+    double distance[PROXIMITY_BATCH_SIZE];
+    double s[3][PROXIMITY_BATCH_SIZE];
+    double normal[3][PROXIMITY_BATCH_SIZE];
+};
+
+// Batched equivalents of check_edge_edge_proximity and check_point_triangle_proximity (with barycentric coordinates 
+// and normal), evaluated branch-free over all queries in the batch.
+void check_edge_edge_proximity(ProximityBatch &batch);
+void check_point_triangle_proximity(ProximityBatch &batch);
+
 
 double signed_volume(const Vec3d &x0, const Vec3d &x1, const Vec3d &x2, const Vec3d &x3);
 
@@ -0,0 +1,97 @@
+#include <sparse_ldl.h>
+#include <cmath>
+
+namespace LosTopos {
+//============================================================================
+// pivots smaller than this fraction of the matrix diagonal are considered singular
+static const double PIVOT_TOLERANCE=1e-12;
+
+void SparseLDLFactor::
+clear(void)
+{
+    m=n=0;
+    column.clear();
+    diagonal.clear();
+    num_modified_pivots=0;
+}
+
+void SparseLDLFactor::
+extend(const SparseMatrixStaticCSR &A)
+{
+    assert(A.m==A.n);
+    assert(m<=A.m);
+    const int start=m;
+    m=n=A.m;
+    column.resize(m);
+    diagonal.resize(m);
+    work.assign(m, 0);
+
+    for(int k=start; k<m; ++k){
+        // scatter the strictly lower part of row k of A, and find its diagonal
+        double akk=0;
+        for(int p=A.rowstart[k]; p<A.rowstart[k+1]; ++p){
+            int j=A.colindex[p];
+            if(j<k) work[j]=A.value[p];
+            else if(j==k) akk=A.value[p];
+        }
+        // forward substitution with the already factored rows: solve L*z=a for z=D*l
+        double dk=akk;
+        for(int j=0; j<k; ++j){
+            double zj=work[j];
+            if(zj==0) continue;
+            work[j]=0;
+            const std::vector<SparseEntry> &c=column[j];
+            for(size_t p=0; p<c.size(); ++p) work[c[p].index]-=c[p].value*zj;
+            double lkj=zj/diagonal[j];
+            column[j].push_back(SparseEntry(k, lkj));
+            dk-=lkj*zj;
+        }
+        if(!(dk>PIVOT_TOLERANCE*std::fabs(akk))){
+            dk=(akk>0 ? akk : 1);
+            ++num_modified_pivots;
+        }
+        diagonal[k]=dk;
+    }
+}
+
+size_t SparseLDLFactor::
+nonzeros(void) const
+{
+    size_t count=0;
+    for(size_t j=0; j<column.size(); ++j) count+=column[j].size();
+    return count;
+}
+
+void SparseLDLFactor::
+apply(const double *x, double *y) const
+{
+    assert(x && y);
+    if(x!=y) BLAS::copy(m, x, y);
+    // solve L*u=x
+    for(int j=0; j<m; ++j){
+        double yj=y[j];
+        if(yj==0) continue;
+        const std::vector<SparseEntry> &c=column[j];
+        for(size_t p=0; p<c.size(); ++p) y[c[p].index]-=c[p].value*yj;
+    }
+    // solve D*v=u
+    for(int j=0; j<m; ++j) y[j]/=diagonal[j];
+    // solve L^T*y=v
+    for(int j=m-1; j>=0; --j){
+        const std::vector<SparseEntry> &c=column[j];
+        double d=y[j];
+        for(size_t p=0; p<c.size(); ++p) d-=c[p].value*y[c[p].index];
+        y[j]=d;
+    }
+}
+
+void SparseLDLFactor::
+apply_and_subtract(const double *x, const double *y, double *z) const
+{
+    assert(x && y && z);
+    temp.resize(m);
+    apply(x, &temp[0]);
+    for(int i=0; i<m; ++i) z[i]=y[i]-temp[i];
+}
+
+}
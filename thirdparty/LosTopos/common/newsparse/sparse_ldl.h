@@ -0,0 +1,50 @@
+#ifndef SPARSE_LDL_H
+#define SPARSE_LDL_H
+
+// Sparse LDL^T factorization, usable as a direct solver or preconditioner.
+
+#include <linear_operator.h>
+#include <sparse_matrix.h>
+#include <vector>
+
+namespace LosTopos {
+//============================================================================
+// Factorization A=L*D*L^T of a symmetric positive (semi-)definite matrix,
+// computed one row at a time ("up-looking"). Row k of L only depends on rows
+// 0..k-1, so when a matrix grows by appending rows and columns the existing
+// factor can be extended instead of being recomputed.
+// Pivots which are tiny or negative (e.g. from redundant rows) are replaced by
+// the corresponding diagonal entry of A, so the factor always stays usable as a
+// preconditioner, though it is then no longer exact.
+// apply() solves L*D*L^T*y=x.
+struct SparseLDLFactor: public LinearOperator
+{
+    std::vector<std::vector<SparseEntry> > column; // strictly lower triangle of L, by column, sorted by row
+    std::vector<double> diagonal; // D
+    unsigned int num_modified_pivots;
+
+    SparseLDLFactor(void) : LinearOperator(0), column(0), diagonal(0), num_modified_pivots(0) {}
+    void clear(void);
+    // factor rows m..A.m-1 of A, assuming rows 0..m-1 are already factored
+    void extend(const SparseMatrixStaticCSR &A);
+    // factor all of A
+    void factor(const SparseMatrixStaticCSR &A) { clear(); extend(A); }
+    // number of off-diagonal entries in L
+    size_t nonzeros(void) const;
+    using LinearOperator::apply;
+    using LinearOperator::apply_and_subtract;
+    using LinearOperator::apply_transpose;
+    using LinearOperator::apply_transpose_and_subtract;
+    virtual void apply(const double *x, double *y) const;
+    virtual void apply_and_subtract(const double *x, const double *y, double *z) const;
+    virtual void apply_transpose(const double *x, double *y) const { apply(x, y); }
+    virtual void apply_transpose_and_subtract(const double *x, const double *y, double *z) const { apply_and_subtract(x, y, z); }
+
+private:
+    std::vector<double> work; // dense row accumulator used by extend()
+    mutable std::vector<double> temp; // intermediate vector for apply_and_subtract()
+};
+
+}
+
+#endif
@@ -20,6 +20,7 @@
 //#include <rootparity2d.h>
 #include <rootparitycollisiontest.h>
 #include <tunicate.h>
+#include <cfloat>
 
 namespace LosTopos {
 
@@ -29,6 +30,10 @@ namespace
     ///
     const double g_degen_normal_epsilon = 1e-6;
 
+    /// Multiple of DBL_EPSILON * (max coordinate)^3 bounding the rounding error of a computed coplanarity coefficient
+    ///
+    const double g_coplanarity_error_factor = 128.0;
+
     //
     // Local function declarations
     //
@@ -49,10 +54,137 @@ namespace
                                                 double &s0, double &s2, Vec3d& normal );
 
     
+    bool swept_bounds_disjoint( const Vec3d* a, size_t na, const Vec3d* b, size_t nb );
+
+    bool coplanarity_sign_is_stable( const Vec3d &x0, const Vec3d &x1, const Vec3d &x2, const Vec3d &x3,
+                                     const Vec3d &xnew0, const Vec3d &xnew1, const Vec3d &xnew2, const Vec3d &xnew3 );
+
+    bool point_triangle_filter_rejects( const Vec3d &x0, const Vec3d &x1, const Vec3d &x2, const Vec3d &x3,
+                                        const Vec3d &xnew0, const Vec3d &xnew1, const Vec3d &xnew2, const Vec3d &xnew3 );
+
+    bool edge_edge_filter_rejects( const Vec3d &x0, const Vec3d &x1, const Vec3d &x2, const Vec3d &x3,
+                                   const Vec3d &xnew0, const Vec3d &xnew1, const Vec3d &xnew2, const Vec3d &xnew3 );
+
     //
     // Local function definitions
     //
 
+    /// Whether the bounding boxes of two point sets are separated along some axis.  Each moving primitive stays inside
+    /// the convex hull of its start and end vertices, so disjoint boxes mean no contact at any time in [0,1].  Only
+    /// comparisons are involved, so the test is exact.
+    ///
+    bool swept_bounds_disjoint( const Vec3d* a, size_t na, const Vec3d* b, size_t nb )
+    {
+        for ( unsigned int axis = 0; axis < 3; ++axis )
+        {
+            double amin = a[0][axis], amax = a[0][axis];
+            for ( size_t i = 1; i < na; ++i )
+            {
+                amin = std::min( amin, a[i][axis] );
+                amax = std::max( amax, a[i][axis] );
+            }
+            
+            double bmin = b[0][axis], bmax = b[0][axis];
+            for ( size_t i = 1; i < nb; ++i )
+            {
+                bmin = std::min( bmin, b[i][axis] );
+                bmax = std::max( bmax, b[i][axis] );
+            }
+            
+            if ( amax < bmin || bmax < amin ) { return true; }
+        }
+        return false;
+    }
+    
+    /// Whether the four linearly moving points provably never become coplanar for t in [0,1].
+    ///
+    /// The coplanarity function f(t) = (x1-x0).((x2-x0)x(x3-x0)) is a cubic in t.  Its Bernstein coefficients follow 
+    /// from blossoming the triple product of the three linearly interpolated edge vectors, and f lies within their 
+    /// convex hull on [0,1].  If every coefficient has the same sign by more than a bound on the rounding error, f has
+    /// no root and neither the point-triangle nor the edge-edge configuration can collide.
+    ///
+    bool coplanarity_sign_is_stable( const Vec3d &x0, const Vec3d &x1, const Vec3d &x2, const Vec3d &x3,
+                                     const Vec3d &xnew0, const Vec3d &xnew1, const Vec3d &xnew2, const Vec3d &xnew3 )
+    {
+        const Vec3d a0 = x1 - x0, b0 = x2 - x0, c0 = x3 - x0;
+        const Vec3d a1 = xnew1 - xnew0, b1 = xnew2 - xnew0, c1 = xnew3 - xnew0;
+        
+        double m = 0.0;
+        for ( unsigned int i = 0; i < 3; ++i )
+        {
+            m = std::max( m, std::max( std::max( std::fabs(a0[i]), std::fabs(b0[i]) ), std::fabs(c0[i]) ) );
+            m = std::max( m, std::max( std::max( std::fabs(a1[i]), std::fabs(b1[i]) ), std::fabs(c1[i]) ) );
+        }
+        
+        // Too small to bound the error reliably (m^3 may underflow); leave it to the exact test
+        if ( m < 1e-90 ) { return false; }
+        
+        const double error_bound = g_coplanarity_error_factor * DBL_EPSILON * m * m * m;
+        
+        const Vec3d b0c0 = cross( b0, c0 ), b1c1 = cross( b1, c1 );
+        const Vec3d b0c1_b1c0 = cross( b0, c1 ) + cross( b1, c0 );
+        
+        const double coef0 = dot( a0, b0c0 );
+        const double coef1 = ( dot( a1, b0c0 ) + dot( a0, b0c1_b1c0 ) ) / 3.0;
+        const double coef2 = ( dot( a0, b1c1 ) + dot( a1, b0c1_b1c0 ) ) / 3.0;
+        const double coef3 = dot( a1, b1c1 );
+        
+        if ( coef0 > error_bound && coef1 > error_bound && coef2 > error_bound && coef3 > error_bound ) { return true; }
+        if ( coef0 < -error_bound && coef1 < -error_bound && coef2 < -error_bound && coef3 < -error_bound ) { return true; }
+        
+        return false;
+    }
+    
+    /// Conservative floating-point filter for the point-triangle test.  Returns true only if the exact test would 
+    /// report no collision.
+    ///
+    bool point_triangle_filter_rejects( const Vec3d &x0, const Vec3d &x1, const Vec3d &x2, const Vec3d &x3,
+                                        const Vec3d &xnew0, const Vec3d &xnew1, const Vec3d &xnew2, const Vec3d &xnew3 )
+    {
+        increment_ccd_filter_counter( CCD_POINT_TRIANGLE_TESTS );
+        
+        const Vec3d point[2] = { x0, xnew0 };
+        const Vec3d triangle[6] = { x1, x2, x3, xnew1, xnew2, xnew3 };
+        if ( swept_bounds_disjoint( point, 2, triangle, 6 ) )
+        {
+            increment_ccd_filter_counter( CCD_POINT_TRIANGLE_BOUNDS_REJECTS );
+            return true;
+        }
+        
+        if ( coplanarity_sign_is_stable( x0, x1, x2, x3, xnew0, xnew1, xnew2, xnew3 ) )
+        {
+            increment_ccd_filter_counter( CCD_POINT_TRIANGLE_COPLANARITY_REJECTS );
+            return true;
+        }
+        
+        return false;
+    }
+    
+    /// Conservative floating-point filter for the edge-edge test.  Returns true only if the exact test would report no 
+    /// collision.
+    ///
+    bool edge_edge_filter_rejects( const Vec3d &x0, const Vec3d &x1, const Vec3d &x2, const Vec3d &x3,
+                                   const Vec3d &xnew0, const Vec3d &xnew1, const Vec3d &xnew2, const Vec3d &xnew3 )
+    {
+        increment_ccd_filter_counter( CCD_EDGE_EDGE_TESTS );
+        
+        const Vec3d edge_a[4] = { x0, x1, xnew0, xnew1 };
+        const Vec3d edge_b[4] = { x2, x3, xnew2, xnew3 };
+        if ( swept_bounds_disjoint( edge_a, 4, edge_b, 4 ) )
+        {
+            increment_ccd_filter_counter( CCD_EDGE_EDGE_BOUNDS_REJECTS );
+            return true;
+        }
+        
+        if ( coplanarity_sign_is_stable( x0, x1, x2, x3, xnew0, xnew1, xnew2, xnew3 ) )
+        {
+            increment_ccd_filter_counter( CCD_EDGE_EDGE_COPLANARITY_REJECTS );
+            return true;
+        }
+        
+        return false;
+    }
+
     void degenerate_get_point_triangle_collision_normal(const Vec3d &x0, const Vec3d &x1, const Vec3d &x2, const Vec3d &x3,
                                                         double &s1, double &s2, double &s3,
                                                         Vec3d& normal )
@@ -261,6 +393,8 @@ bool point_triangle_collision(const Vec3d& x0, const Vec3d& xnew0, size_t /*inde
                               const Vec3d& x2, const Vec3d& xnew2, size_t /*index2*/,
                               const Vec3d& x3, const Vec3d& xnew3, size_t /*index3*/ )
 {   
+    if ( point_triangle_filter_rejects( x0, x1, x2, x3, xnew0, xnew1, xnew2, xnew3 ) ) { return false; }
+    
     rootparity::RootParityCollisionTest test( x0, x1, x2, x3, xnew0, xnew1, xnew2, xnew3, false );
     bool rayhex_result = test.run_test();
     return rayhex_result;
@@ -275,6 +409,7 @@ bool point_triangle_collision(const Vec3d& x0, const Vec3d& xnew0, size_t /*inde
                               Vec3d& normal,
                               double& relative_normal_displacement )
 {
+    if ( point_triangle_filter_rejects( x0, x1, x2, x3, xnew0, xnew1, xnew2, xnew3 ) ) { return false; }
     
     rootparity::RootParityCollisionTest test( x0, x1, x2, x3, xnew0, xnew1, xnew2, xnew3, false );
     bool rayhex_result = test.run_test();
@@ -300,6 +435,7 @@ bool segment_segment_collision(const Vec3d& x0, const Vec3d& xnew0, size_t /*ind
                                const Vec3d& x2, const Vec3d& xnew2, size_t /*index2*/,
                                const Vec3d& x3, const Vec3d& xnew3, size_t /*index3*/)
 {
+    if ( edge_edge_filter_rejects( x0, x1, x2, x3, xnew0, xnew1, xnew2, xnew3 ) ) { return false; }
     
     rootparity::RootParityCollisionTest test( x0, x1, x2, x3, xnew0, xnew1, xnew2, xnew3, true );
     bool rayhex_result = test.run_test();
@@ -315,6 +451,8 @@ bool segment_segment_collision(const Vec3d& x0, const Vec3d& xnew0, size_t /*ind
                                Vec3d& normal,
                                double& relative_normal_displacement )
 {
+    if ( edge_edge_filter_rejects( x0, x1, x2, x3, xnew0, xnew1, xnew2, xnew3 ) ) { return false; }
+    
     rootparity::RootParityCollisionTest test( x0, x1, x2, x3, xnew0, xnew1, xnew2, xnew3, true );
     bool rayhex_result = test.edge_edge_collision();
     
@@ -9,6 +9,6 @@
 
 #include <interval.h>
 
-int Interval::s_previous_rounding_mode = ~0;
+thread_local int Interval::s_previous_rounding_mode = ~0;
 
 
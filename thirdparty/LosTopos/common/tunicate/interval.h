@@ -52,7 +52,8 @@ public:
     // Internal representation
     double v[2];
     
-    static int s_previous_rounding_mode;
+    // rounding mode to restore in end_special_arithmetic(), saved per thread as the collision tests run concurrently
+    static thread_local int s_previous_rounding_mode;
     
 public:
     